@@ -16,6 +16,9 @@
 #include <allegro5/allegro.h> // Tipos y funciones generales de Allegro
 #include <allegro5/allegro_audio.h> // Control de audio en Allegro
 #include <allegro5/allegro_acodec.h> // Codecs de audio necesarios para reproducir formatos diversos
+#include "flujo.h" // Campo de flujo que guia a los seekers
+#include "memoria.h" // Etiquetas de subsistema para la medicion de asignaciones
+#include "paquete.h" // Carga de los samples desde el paquete de recursos
 
 using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
 
@@ -44,8 +47,9 @@ typedef struct Bala {
         float x, y; // Posicion de la bala en el plano
         float vx, vy; // Componentes de velocidad de la bala
         bool activa; // Indica si la bala sigue disponible para colisiones
-        float tiempo_vida; // Tiempo restante antes de que la bala expire
+        int temporizador; // Vencimiento que la retira de la lista (indice en la rueda de la partida, -1 = ninguno)
         struct Bala* siguiente; // Puntero al siguiente elemento de la lista enlazada
+        struct Bala* anterior; // Puntero al elemento previo, para retirarla sin recorrer la lista
 } *PtrBala; // Define PtrBala como alias de puntero a Bala
 
 struct Estadistica {
@@ -64,12 +68,92 @@ const float RADIO_DRONE = 50.0f; // Radio de los enemigos tipo drone
 const float RADIO_SEEKER = 45.0f; // Radio de los enemigos tipo seeker
 const float RADIO_BALA = 5.0f; // Radio de las balas para colisiones circulares
 const float VELOCIDAD_BALA = 15.0f; // Magnitud de la velocidad de las balas
-const float VIDA_BALA = 180.0f; // Duracion de cada bala en frames antes de desactivarse
+const int VIDA_BALA = 180; // Duracion de cada bala en frames, contando el frame en que se dispara
 const float CADENCIA_DISPARO = 10.0f; // Intervalo de frames entre disparos consecutivos del jugador
+const float VELOCIDAD_SEEKER = 6.0f; // Pixeles por frame que avanza un seeker hacia el jugador
 
 const int ENEMIGOS_RONDA_INICIAL = 3; // Cantidad de enemigos presentes en la primera ronda
 const int INCREMENTO_POR_RONDA = 2; // Numero adicional de enemigos que se agregan por ronda
 const float DURACION_TRANSICION = 180.0f; // Tiempo en frames que dura la transicion entre rondas
+const int CUPO_IA_INICIAL = 64; // Seekers que deciden su direccion en cada tick
+
+// Valores de equilibrio que se pueden variar por partida (simulacion por lotes)
+struct ParametrosBalance {
+        int enemigos_ronda_inicial; // Enemigos de la primera ronda
+        int incremento_por_ronda; // Enemigos adicionales por ronda
+        float cadencia_disparo; // Frames entre disparos del jugador
+        float velocidad_seeker; // Pixeles por frame de los seekers
+        int cupo_ia; // Decisiones de seekers por tick (ver ia.h)
+};
+
+const ParametrosBalance BALANCE_POR_DEFECTO = {ENEMIGOS_RONDA_INICIAL, INCREMENTO_POR_RONDA, CADENCIA_DISPARO, VELOCIDAD_SEEKER, CUPO_IA_INICIAL}; // Equilibrio de la partida normal
+
+// ========== POOLS ==========
+
+const int MAX_NAVES_POOL = 1024; // Enemigos que pueden existir a la vez (incluida la oleada en preparacion)
+const int MAX_BALAS_POOL = 256; // Balas simultaneas de todos los jugadores
+
+struct PoolNaves {
+        Nave nodos[MAX_NAVES_POOL]; // Almacenamiento plano de todos los nodos
+        PtrNave libres; // Lista de nodos libres enlazada por el campo siguiente
+        int en_uso; // Nodos reservados actualmente
+};
+
+struct PoolBalas {
+        Bala nodos[MAX_BALAS_POOL]; // Almacenamiento plano de todas las balas
+        PtrBala libres; // Lista de balas libres enlazada por el campo siguiente
+        int en_uso; // Balas reservadas actualmente
+};
+
+void iniciarPoolNaves(PoolNaves& pool) {
+        for (int i = 0; i < MAX_NAVES_POOL - 1; i++) pool.nodos[i].siguiente = &pool.nodos[i + 1]; // Encadena todos los nodos libres
+        for (int i = 0; i < MAX_NAVES_POOL; i++) pool.nodos[i].activo = false; // El turno de la IA recorre el pool por indice y salta los libres
+        pool.nodos[MAX_NAVES_POOL - 1].siguiente = nullptr; // Ultimo nodo libre
+        pool.libres = &pool.nodos[0]; // Todos los nodos empiezan libres
+        pool.en_uso = 0; // Ninguno reservado
+}
+
+void iniciarPoolBalas(PoolBalas& pool) {
+        for (int i = 0; i < MAX_BALAS_POOL - 1; i++) pool.nodos[i].siguiente = &pool.nodos[i + 1]; // Encadena todas las balas libres
+        pool.nodos[MAX_BALAS_POOL - 1].siguiente = nullptr; // Ultima bala libre
+        pool.libres = &pool.nodos[0]; // Todas las balas empiezan libres
+        pool.en_uso = 0; // Ninguna reservada
+}
+
+PtrNave reservarNave(PoolNaves& pool) {
+        PtrNave nodo = pool.libres; // Toma el primer nodo libre
+        if (nodo == nullptr) return nullptr; // Pool agotado: el llamador omite el enemigo
+        pool.libres = nodo->siguiente; // Lo retira de la lista de libres
+        pool.en_uso++; // Cuenta el nodo reservado
+        return nodo; // Nodo listo para rellenar
+}
+
+void devolverNave(PoolNaves& pool, PtrNave nodo) {
+        nodo->siguiente = pool.libres; // Vuelve a la cabeza de la lista de libres
+        pool.libres = nodo; // Queda disponible para la proxima reserva
+        pool.en_uso--; // Descuenta el nodo
+}
+
+PtrBala reservarBala(PoolBalas& pool) {
+        PtrBala nodo = pool.libres; // Toma la primera bala libre
+        if (nodo == nullptr) return nullptr; // Pool agotado: no se dispara
+        pool.libres = nodo->siguiente; // La retira de la lista de libres
+        pool.en_uso++; // Cuenta la bala reservada
+        return nodo; // Bala lista para rellenar
+}
+
+void devolverBala(PoolBalas& pool, PtrBala nodo) {
+        nodo->siguiente = pool.libres; // Vuelve a la cabeza de la lista de libres
+        pool.libres = nodo; // Queda disponible
+        pool.en_uso--; // Descuenta la bala
+}
+
+// ========== ALEATORIOS ==========
+
+int aleatorioPartida(unsigned int& semilla) {
+        semilla = semilla * 214013u + 2531011u; // Misma recurrencia que rand() de MSVC, pero con estado propio de la partida
+        return (int)((semilla >> 16) & 0x7FFF); // Valor entre 0 y 32767
+}
 
 // ========== INICIALIZACION ==========
 
@@ -93,18 +177,18 @@ void resetearJugador(Nave& personaje, int x, int y) {
         personaje.ang = 0.0f; // Restablece el angulo para mirar hacia arriba
 }
 
-void iniciarWandererAleatorio(Nave& monstruo, int anchoMax, int altoMax) {
-        int lado = rand() % 4; // Determina un borde aleatorio de aparicion (0-3)
+void iniciarWandererAleatorio(Nave& monstruo, int anchoMax, int altoMax, unsigned int& semilla) {
+        int lado = aleatorioPartida(semilla) % 4; // Determina un borde aleatorio de aparicion (0-3)
 
         switch (lado) { // Selecciona la ubicacion segun el borde elegido
-                case 0: monstruo.x = rand() % anchoMax; monstruo.y = 100; break; // Parte superior de la pantalla
-                case 1: monstruo.x = anchoMax - 100; monstruo.y = rand() % altoMax; break; // Lado derecho
-                case 2: monstruo.x = rand() % anchoMax; monstruo.y = altoMax - 100; break; // Parte inferior
-                case 3: monstruo.x = 100; monstruo.y = rand() % altoMax; break; // Lado izquierdo
+                case 0: monstruo.x = aleatorioPartida(semilla) % anchoMax; monstruo.y = 100; break; // Parte superior de la pantalla
+                case 1: monstruo.x = anchoMax - 100; monstruo.y = aleatorioPartida(semilla) % altoMax; break; // Lado derecho
+                case 2: monstruo.x = aleatorioPartida(semilla) % anchoMax; monstruo.y = altoMax - 100; break; // Parte inferior
+                case 3: monstruo.x = 100; monstruo.y = aleatorioPartida(semilla) % altoMax; break; // Lado izquierdo
         }
 
-        monstruo.vx = (rand() % 10 + 5) * (rand() % 2 == 0 ? 1 : -1); // Asigna velocidad horizontal aleatoria positiva o negativa
-        monstruo.vy = (rand() % 10 + 5) * (rand() % 2 == 0 ? 1 : -1); // Asigna velocidad vertical aleatoria positiva o negativa
+        monstruo.vx = (aleatorioPartida(semilla) % 10 + 5) * (aleatorioPartida(semilla) % 2 == 0 ? 1 : -1); // Asigna velocidad horizontal aleatoria positiva o negativa
+        monstruo.vy = (aleatorioPartida(semilla) % 10 + 5) * (aleatorioPartida(semilla) % 2 == 0 ? 1 : -1); // Asigna velocidad vertical aleatoria positiva o negativa
         monstruo.ang = 0.0f; // No se usa un angulo especifico para el drone
         monstruo.radio = RADIO_DRONE; // Radio de colision propio del drone
         monstruo.activo = true; // Marca al enemigo como activo
@@ -112,18 +196,18 @@ void iniciarWandererAleatorio(Nave& monstruo, int anchoMax, int altoMax) {
         monstruo.siguiente = nullptr; // Inicializa el enlace siguiente como nulo
 }
 
-void iniciarSeekerAleatorio(Nave& monstruo, int anchoMax, int altoMax) {
-        int lado = rand() % 4; // Selecciona un borde aleatorio para la aparicion
+void iniciarSeekerAleatorio(Nave& monstruo, int anchoMax, int altoMax, unsigned int& semilla) {
+        int lado = aleatorioPartida(semilla) % 4; // Selecciona un borde aleatorio para la aparicion
 
         switch (lado) { // Define la posicion inicial segun el borde elegido
-                case 0: monstruo.x = rand() % anchoMax; monstruo.y = 100; break; // Borde superior
-                case 1: monstruo.x = anchoMax - 100; monstruo.y = rand() % altoMax; break; // Borde derecho
-                case 2: monstruo.x = rand() % anchoMax; monstruo.y = altoMax - 100; break; // Borde inferior
-                case 3: monstruo.x = 100; monstruo.y = rand() % altoMax; break; // Borde izquierdo
+                case 0: monstruo.x = aleatorioPartida(semilla) % anchoMax; monstruo.y = 100; break; // Borde superior
+                case 1: monstruo.x = anchoMax - 100; monstruo.y = aleatorioPartida(semilla) % altoMax; break; // Borde derecho
+                case 2: monstruo.x = aleatorioPartida(semilla) % anchoMax; monstruo.y = altoMax - 100; break; // Borde inferior
+                case 3: monstruo.x = 100; monstruo.y = aleatorioPartida(semilla) % altoMax; break; // Borde izquierdo
         }
 
-        monstruo.vx = 5.0f; // Velocidad horizontal base para el perseguidor
-        monstruo.vy = 5.0f; // Velocidad vertical base para el perseguidor
+        monstruo.vx = 0.0f; // Sin direccion hasta su primera decision (ver ia.h)
+        monstruo.vy = 0.0f; // Sin direccion hasta su primera decision
         monstruo.ang = 0.0f; // No se utiliza el angulo directamente
         monstruo.radio = RADIO_SEEKER; // Radio de colision para seekers
         monstruo.activo = true; // Marca el enemigo como disponible
@@ -150,17 +234,34 @@ void movimientoWanderer(Nave& monstruo, int anchoMax, int altoMax) {
         if (monstruo.y > aba) monstruo.y = aba; // Limita el movimiento por abajo
 }
 
-void movimientoSeeker(Nave& monstruo, Nave& jugador, int anchoMax, int altoMax) {
-        if (!monstruo.activo) return; // Evita calcular movimiento si el enemigo esta inactivo
+// Decision del seeker: guarda en vx/vy la direccion unitaria hacia el jugador. Es la parte cara
+// del movimiento y el planificador de ia.h decide cuando se repite
+void decidirSeeker(Nave& monstruo, const Nave& jugador, const CampoFlujo& campo) {
+        if (!monstruo.activo) return; // Evita decidir si el enemigo esta inactivo
+
+        float fx, fy; // Direccion de avance del seeker
+        if (!muestrearCampoFlujo(campo, monstruo.x, monstruo.y, fx, fy)) { // Lejos del jugador basta con leer la celda del campo
+                float dx = jugador.x - monstruo.x; // Diferencia horizontal entre enemigo y jugador
+                float dy = jugador.y - monstruo.y; // Diferencia vertical entre enemigo y jugador
+                float d = sqrt(dx * dx + dy * dy); // Calcula la distancia utilizando la norma euclidiana
+
+                if (d == 0.0f) { fx = 0.0f; fy = 0.0f; } // Evita division por cero si ambos estan en la misma posicion
+                else {
+                        fx = dx / d; // Normaliza el vector hacia el jugador en X
+                        fy = dy / d; // Normaliza el vector hacia el jugador en Y
+                }
+        }
 
-        float dx = jugador.x - monstruo.x; // Diferencia horizontal entre enemigo y jugador
-        float dy = jugador.y - monstruo.y; // Diferencia vertical entre enemigo y jugador
-        float d = sqrt(dx * dx + dy * dy); // Calcula la distancia utilizando la norma euclidiana
+        monstruo.vx = fx; // Direccion guardada hasta la proxima decision
+        monstruo.vy = fy; // Direccion guardada hasta la proxima decision
+}
 
-        if (d == 0.0f) return; // Evita division por cero si ambos estan en la misma posicion
+// Avance del seeker en la ultima direccion decidida (se ejecuta en todos los ticks)
+void moverSeeker(Nave& monstruo, int anchoMax, int altoMax, float velocidad = VELOCIDAD_SEEKER) {
+        if (!monstruo.activo) return; // Evita calcular movimiento si el enemigo esta inactivo
 
-        monstruo.x += (dx / d) * 6.0f; // Normaliza el vector y multiplica por la velocidad deseada en X
-        monstruo.y += (dy / d) * 6.0f; // Normaliza el vector y multiplica por la velocidad deseada en Y
+        monstruo.x += monstruo.vx * velocidad; // Avanza en X a la velocidad del seeker
+        monstruo.y += monstruo.vy * velocidad; // Avanza en Y a la velocidad del seeker
 
         if (monstruo.x < 50) monstruo.x = 50; // Restringe la posicion izquierda
         if (monstruo.x > anchoMax - 50) monstruo.x = anchoMax - 50; // Restringe la posicion derecha
@@ -168,57 +269,14 @@ void movimientoSeeker(Nave& monstruo, Nave& jugador, int anchoMax, int altoMax)
         if (monstruo.y > altoMax - 50) monstruo.y = altoMax - 50; // Restringe la posicion inferior
 }
 
-// ========== LISTAS ENLAZADAS - ENEMIGOS ==========
-
-void agregarEnemigo(PtrNave& cabeza, Nave nuevoEnemigo) {
-        PtrNave nuevo = new Nave; // Reserva memoria para un nuevo nodo de enemigo
-        *nuevo = nuevoEnemigo; // Copia los datos del enemigo proporcionado
-        nuevo->siguiente = nullptr; // Inicializa el puntero siguiente como nulo
-
-        if (cabeza == nullptr) { // Si la lista aun esta vacia
-                cabeza = nuevo; // El nuevo nodo pasa a ser la cabeza de la lista
-        } else {
-                PtrNave temp = cabeza; // Comienza a recorrer la lista desde la cabeza
-                while (temp->siguiente != nullptr) temp = temp->siguiente; // Avanza hasta encontrar el ultimo nodo
-                temp->siguiente = nuevo; // Enlaza el nuevo nodo al final de la lista
-        }
-}
-
-void actualizarEnemigos(PtrNave cabeza, Nave& jugador, int anchoMax, int altoMax) {
-        PtrNave temp = cabeza; // Inicia el recorrido desde el primer enemigo
-        while (temp != nullptr) { // Recorre la lista completa
-                if (temp->activo) { // Solo procesa enemigos activos
-                        if (temp->tipo == 1) movimientoWanderer(*temp, anchoMax, altoMax); // Los drones rebotan en los bordes
-                        else if (temp->tipo == 2) movimientoSeeker(*temp, jugador, anchoMax, altoMax); // Los seekers persiguen al jugador
-                }
-                temp = temp->siguiente; // Avanza al siguiente enemigo
-        }
-}
-
-int contarEnemigosActivos(PtrNave cabeza) {
-        int count = 0; // Contador de enemigos vivos inicializado en cero
-        PtrNave temp = cabeza; // Recorre desde la cabeza de la lista
-        while (temp != nullptr) { // Itera todos los nodos
-                if (temp->activo) count++; // Incrementa el contador por cada enemigo activo
-                temp = temp->siguiente; // Avanza al siguiente nodo
-        }
-        return count; // Devuelve el numero total de enemigos activos
-}
-
-void liberarEnemigos(PtrNave& cabeza) {
-        while (cabeza != nullptr) { // Recorre la lista hasta que este vacia
-                PtrNave temp = cabeza; // Almacena la referencia al nodo actual
-                cabeza = cabeza->siguiente; // Avanza la cabeza al siguiente nodo
-                delete temp; // Libera la memoria del nodo actual
-        }
-}
-
 // ========== LISTAS ENLAZADAS - BALAS ==========
 
-void agregarBala(PtrBala& cabeza, Bala nuevaBala) {
-        PtrBala nueva = new Bala; // Reserva memoria para una bala
+PtrBala agregarBala(PoolBalas& pool, PtrBala& cabeza, Bala nuevaBala) {
+        PtrBala nueva = reservarBala(pool); // Toma una bala del pool
+        if (nueva == nullptr) return nullptr; // Sin balas libres no se dispara
         *nueva = nuevaBala; // Copia los atributos de la bala proporcionada
         nueva->siguiente = nullptr; // Inicializa el enlace siguiente como nulo
+        nueva->anterior = nullptr; // Sin anterior hasta enlazarla
 
         if (cabeza == nullptr) { // Si la lista esta vacia
                 cabeza = nueva; // La nueva bala se convierte en la primera de la lista
@@ -226,61 +284,38 @@ void agregarBala(PtrBala& cabeza, Bala nuevaBala) {
                 PtrBala temp = cabeza; // Comienza a recorrer la lista
                 while (temp->siguiente != nullptr) temp = temp->siguiente; // Encuentra la ultima bala
                 temp->siguiente = nueva; // Agrega la nueva bala al final
+                nueva->anterior = temp; // Enlace inverso
         }
+        return nueva; // Bala insertada
 }
 
-void actualizarBalas(PtrBala& cabeza) {
-        PtrBala temp = cabeza; // Recorre desde la primera bala
-        while (temp != nullptr) { // Itera toda la lista
-                if (temp->activa) { // Solo procesa balas activas
-                        temp->x += temp->vx; // Avanza la bala horizontalmente segun su velocidad
-                        temp->y += temp->vy; // Avanza la bala verticalmente segun su velocidad
-                        temp->tiempo_vida -= 1.0f; // Reduce el tiempo de vida por frame
-                        if (temp->tiempo_vida <= 0.0f) temp->activa = false; // Desactiva la bala cuando su tiempo llega a cero
-                }
-                temp = temp->siguiente; // Pasa a la siguiente bala
-        }
+// Retira una bala concreta en O(1); la llama el vencimiento de su temporizador
+void retirarBala(PoolBalas& pool, PtrBala& cabeza, PtrBala bala) {
+        if (bala->anterior != nullptr) bala->anterior->siguiente = bala->siguiente; // Salta la bala
+        else cabeza = bala->siguiente; // Era la primera de la lista
+        if (bala->siguiente != nullptr) bala->siguiente->anterior = bala->anterior; // Enlace inverso
+        devolverBala(pool, bala); // Devuelve el nodo al pool
 }
 
-void limpiarBalas(PtrBala& cabeza) {
-        while (cabeza != nullptr && !cabeza->activa) { // Elimina balas inactivas consecutivas al inicio
-                PtrBala temp = cabeza; // Nodo temporal para liberar
-                cabeza = cabeza->siguiente; // Mueve la cabeza al siguiente nodo
-                delete temp; // Libera la memoria del nodo eliminado
-        }
-
-        if (cabeza != nullptr) { // Si todavia queda al menos una bala activa
-                PtrBala actual = cabeza; // Comienza a recorrer desde el primer elemento activo
-                while (actual->siguiente != nullptr) { // Examina el resto de la lista
-                        if (!actual->siguiente->activa) { // Si la siguiente bala esta inactiva
-                                PtrBala temp = actual->siguiente; // Guarda el nodo a eliminar
-                                actual->siguiente = temp->siguiente; // Enlaza el nodo actual con el siguiente del eliminado
-                                delete temp; // Libera la memoria del nodo removido
-                        } else {
-                                actual = actual->siguiente; // Avanza cuando la bala sigue activa
-                        }
-                }
-        }
-}
-
-void liberarBalas(PtrBala& cabeza) {
+void liberarBalas(PoolBalas& pool, PtrBala& cabeza) {
         while (cabeza != nullptr) { // Recorre la lista hasta liberarla completa
                 PtrBala temp = cabeza; // Nodo actual a destruir
                 cabeza = cabeza->siguiente; // Avanza la cabeza al siguiente nodo
-                delete temp; // Libera el nodo actual
+                devolverBala(pool, temp); // Devuelve el nodo actual al pool
         }
 }
 
-void dispararBala(PtrBala& cabeza, Nave& jugador) {
+PtrBala dispararBala(PoolBalas& pool, PtrBala& cabeza, Nave& jugador) {
         Bala nueva; // Crea una instancia temporal de bala
         nueva.x = jugador.x + sin(jugador.ang) * 30.0f; // Posicion inicial desplazada hacia la punta de la nave
         nueva.y = jugador.y - cos(jugador.ang) * 30.0f; // Ajusta la posicion vertical alineada con la direccion de disparo
         nueva.vx = sin(jugador.ang) * VELOCIDAD_BALA; // Componente horizontal de la velocidad basada en el angulo de la nave
         nueva.vy = -cos(jugador.ang) * VELOCIDAD_BALA; // Componente vertical de la velocidad
         nueva.activa = true; // Marca la bala como disponible para colisionar
-        nueva.tiempo_vida = VIDA_BALA; // Asigna la duracion definida para las balas
+        nueva.temporizador = -1; // El llamador programa su vencimiento
         nueva.siguiente = nullptr; // Inicializa el enlace siguiente como nulo
-        agregarBala(cabeza, nueva); // Inserta la bala en la lista enlazada de proyectiles
+        nueva.anterior = nullptr; // Inicializa el enlace anterior como nulo
+        return agregarBala(pool, cabeza, nueva); // Inserta la bala en la lista enlazada de proyectiles (nullptr si el pool esta lleno)
 }
 
 // ========== COLISIONES ==========
@@ -292,92 +327,98 @@ bool hayColision(float x1, float y1, float r1, float x2, float y2, float r2) {
         return distancia < (r1 + r2); // Retorna verdadero si los radios se superponen
 }
 
-int verificarColisionesBalasEnemigos(PtrBala balas, PtrNave enemigos) {
-        int muertos = 0; // Contador de enemigos eliminados durante la comprobacion
-        PtrBala bala = balas; // Recorre la lista de balas
-
-        while (bala != nullptr) { // Itera por todas las balas
-                if (bala->activa) { // Solo revisa balas activas
-                        PtrNave enemigo = enemigos; // Recorre la lista de enemigos para cada bala
-                        while (enemigo != nullptr) { // Itera cada enemigo
-                                if (enemigo->activo) { // Solo toma en cuenta enemigos vivos
-                                        if (hayColision(bala->x, bala->y, RADIO_BALA, enemigo->x, enemigo->y, enemigo->radio)) { // Comprueba superposicion
-                                                bala->activa = false; // Desactiva la bala al impactar
-                                                enemigo->activo = false; // Marca al enemigo como destruido
-                                                muertos++; // Incrementa el numero de bajas registradas
-                                        }
-                                }
-                                enemigo = enemigo->siguiente; // Avanza al siguiente enemigo en la lista
-                        }
-                }
-                bala = bala->siguiente; // Avanza a la siguiente bala
-        }
-        return muertos; // Devuelve el total de enemigos eliminados en esta iteracion
-}
-
-bool verificarColisionJugadorEnemigos(Nave& jugador, PtrNave enemigos) {
-        if (!jugador.activo) return false; // Si el jugador ya esta inactivo se omite la comprobacion
+// ========== OLEADAS ==========
 
-        PtrNave enemigo = enemigos; // Empieza a recorrer la lista de enemigos
-        while (enemigo != nullptr) { // Itera por todos los enemigos
-                if (enemigo->activo) { // Solo revisa los que siguen vivos
-                        if (hayColision(jugador.x, jugador.y, jugador.radio, enemigo->x, enemigo->y, enemigo->radio)) { // Comprueba colision circular con el jugador
-                                return true; // Devuelve verdadero en cuanto encuentra una colision
-                        }
-                }
-                enemigo = enemigo->siguiente; // Avanza al siguiente enemigo
-        }
-        return false; // Si recorre toda la lista sin colisiones retorna falso
+int calcularEnemigosEnRonda(int numeroRonda, const ParametrosBalance& balance = BALANCE_POR_DEFECTO) {
+        return balance.enemigos_ronda_inicial + (numeroRonda - 1) * balance.incremento_por_ronda; // Aplica la progresion aritmetica de enemigos
 }
 
-// ========== OLEADAS ==========
+void enlazarEnemigo(PoolNaves& pool, PtrNave& cabeza, PtrNave& cola, Nave nuevoEnemigo) {
+        PtrNave nuevo = reservarNave(pool); // Toma un nodo del pool para el nuevo enemigo
+        if (nuevo == nullptr) return; // Sin nodos libres el enemigo no se agrega
+        *nuevo = nuevoEnemigo; // Copia los datos del enemigo proporcionado
+        nuevo->siguiente = nullptr; // El nodo sera el ultimo de la lista
 
-int calcularEnemigosEnRonda(int numeroRonda) {
-        return ENEMIGOS_RONDA_INICIAL + (numeroRonda - 1) * INCREMENTO_POR_RONDA; // Aplica la progresion aritmetica de enemigos
+        if (cola == nullptr) cabeza = nuevo; // Lista vacia: el nodo pasa a ser la cabeza
+        else cola->siguiente = nuevo; // Enlaza directamente tras el ultimo nodo conocido, sin recorrer la lista
+        cola = nuevo; // Actualiza el puntero al ultimo nodo
 }
 
-void generarOleada(PtrNave& lista_enemigos, int numeroRonda, int anchoMax, int altoMax) {
-        int total = calcularEnemigosEnRonda(numeroRonda); // Determina cuantos enemigos debe tener la ronda actual
+void generarOleada(PoolNaves& pool, PtrNave& lista_enemigos, int numeroRonda, int anchoMax, int altoMax, unsigned int& semilla, const ParametrosBalance& balance = BALANCE_POR_DEFECTO) {
+        int total = calcularEnemigosEnRonda(numeroRonda, balance); // Determina cuantos enemigos debe tener la ronda actual
         int drones = (total * 60) / 100; // Calcula un 60 por ciento del total para drones
         int seekers = total - drones; // El resto de enemigos son seekers
 
+        PtrNave cola = lista_enemigos; // Busca una unica vez el final de la lista existente
+        while (cola != nullptr && cola->siguiente != nullptr) cola = cola->siguiente; // Avanza hasta el ultimo nodo
+
         for (int i = 0; i < drones; i++) { // Genera cada drone requerido
                 Nave drone; // Crea un objeto temporal para inicializarlo
-                iniciarWandererAleatorio(drone, anchoMax, altoMax); // Inicializa la posicion del drone
-                agregarEnemigo(lista_enemigos, drone); // Inserta el drone en la lista de enemigos
+                iniciarWandererAleatorio(drone, anchoMax, altoMax, semilla); // Inicializa la posicion del drone
+                enlazarEnemigo(pool, lista_enemigos, cola, drone); // Inserta el drone al final en O(1)
         }
 
         for (int i = 0; i < seekers; i++) { // Genera cada seeker necesario
                 Nave seeker; // Objeto temporal para inicializarlo
-                iniciarSeekerAleatorio(seeker, anchoMax, altoMax); // Posiciona al seeker en un borde aleatorio
-                agregarEnemigo(lista_enemigos, seeker); // Lo agrega a la lista enlazada
+                iniciarSeekerAleatorio(seeker, anchoMax, altoMax, semilla); // Posiciona al seeker en un borde aleatorio
+                enlazarEnemigo(pool, lista_enemigos, cola, seeker); // Lo agrega al final de la lista en O(1)
         }
 }
 
-void limpiarEnemigosInactivos(PtrNave& cabeza) {
-        while (cabeza != nullptr && !cabeza->activo) { // Elimina nodos inactivos consecutivos desde el inicio
-                PtrNave temp = cabeza; // Nodo temporal para liberar memoria
-                cabeza = cabeza->siguiente; // Avanza la cabeza al siguiente nodo
-                delete temp; // Libera el nodo inactivo
-        }
+// ========== OLEADA PREPARADA ==========
 
-        if (cabeza != nullptr) { // Si aun queda al menos un enemigo activo
-                PtrNave actual = cabeza; // Comienza el recorrido desde la cabeza
-                while (actual->siguiente != nullptr) { // Revisa los siguientes nodos
-                        if (!actual->siguiente->activo) { // Si el siguiente nodo esta inactivo
-                                PtrNave temp = actual->siguiente; // Nodo a eliminar
-                                actual->siguiente = temp->siguiente; // Salta el nodo inactivo en la lista
-                                delete temp; // Libera la memoria del nodo eliminado
-                        } else {
-                                actual = actual->siguiente; // Avanza cuando el nodo esta activo
-                        }
+struct OleadaPreparada {
+        PtrNave cabeza; // Primer enemigo de la oleada en preparacion
+        PtrNave cola; // Ultimo enemigo generado, permite insertar en O(1)
+        int drones_pendientes; // Drones que faltan por generar
+        int seekers_pendientes; // Seekers que faltan por generar
+        int por_tick; // Enemigos a generar en cada tick de la transicion
+};
+
+void iniciarOleadaPreparada(OleadaPreparada& oleada, int numeroRonda, int ticksDisponibles, const ParametrosBalance& balance = BALANCE_POR_DEFECTO) {
+        int total = calcularEnemigosEnRonda(numeroRonda, balance); // Tamano de la oleada a preparar
+        oleada.cabeza = nullptr; // La oleada preparada comienza vacia
+        oleada.cola = nullptr; // Sin ultimo nodo todavia
+        oleada.drones_pendientes = (total * 60) / 100; // Mismo reparto 60/40 que generarOleada
+        oleada.seekers_pendientes = total - oleada.drones_pendientes; // El resto son seekers
+        if (ticksDisponibles < 1) ticksDisponibles = 1; // Evita divisiones por cero
+        oleada.por_tick = (total + ticksDisponibles - 1) / ticksDisponibles; // Reparte la generacion entre los ticks disponibles
+}
+
+bool oleadaPreparadaCompleta(const OleadaPreparada& oleada) {
+        return oleada.drones_pendientes == 0 && oleada.seekers_pendientes == 0; // No queda ningun enemigo por generar
+}
+
+bool avanzarOleadaPreparada(PoolNaves& pool, OleadaPreparada& oleada, int anchoMax, int altoMax, unsigned int& semilla) {
+        for (int i = 0; i < oleada.por_tick && !oleadaPreparadaCompleta(oleada); i++) { // Genera solo la cuota de este tick
+                Nave nuevo; // Objeto temporal para inicializar el enemigo
+                if (oleada.drones_pendientes > 0) { // Primero los drones, igual que generarOleada
+                        iniciarWandererAleatorio(nuevo, anchoMax, altoMax, semilla); // Inicializa un drone en un borde aleatorio
+                        oleada.drones_pendientes--; // Descuenta el drone generado
+                } else {
+                        iniciarSeekerAleatorio(nuevo, anchoMax, altoMax, semilla); // Inicializa un seeker en un borde aleatorio
+                        oleada.seekers_pendientes--; // Descuenta el seeker generado
                 }
+                enlazarEnemigo(pool, oleada.cabeza, oleada.cola, nuevo); // Lo agrega a la lista preparada en O(1)
         }
+        return oleadaPreparadaCompleta(oleada); // Indica si la oleada ya esta lista
+}
+
+void confirmarOleada(PoolNaves& pool, PtrNave& lista_enemigos, OleadaPreparada& oleada, int anchoMax, int altoMax, unsigned int& semilla) {
+        while (!avanzarOleadaPreparada(pool, oleada, anchoMax, altoMax, semilla)) {} // Completa lo que falte (normalmente nada)
+
+        if (oleada.cola != nullptr) { // Si la oleada tiene enemigos
+                oleada.cola->siguiente = lista_enemigos; // Conserva cualquier enemigo previo tras la oleada nueva
+                lista_enemigos = oleada.cabeza; // Intercambio en O(1): la lista preparada pasa a ser la activa
+        }
+        oleada.cabeza = nullptr; // La oleada preparada queda vacia
+        oleada.cola = nullptr; // Sin ultimo nodo
 }
 
 // ========== PERSISTENCIA ==========
 
 void guardarEstadisticas(const Estadistica& stats) {
+        ZonaMemoria zona(MEM_PERSISTENCIA); // Las asignaciones del archivo se atribuyen a la persistencia
         ofstream archivo("estadisticas.txt", ios::app); // Abre el archivo en modo de anexado
         if (archivo.is_open()) { // Comprueba que el archivo se abrio correctamente
                 archivo << stats.nombre << "|" << stats.puntuacion << "|" << stats.tiempo << "|" << stats.ronda << "|" << stats.enemigos_eliminados << "|" << stats.proyectiles_disparados << "\n"; // Escribe los datos separados por tuberias
@@ -385,52 +426,26 @@ void guardarEstadisticas(const Estadistica& stats) {
         }
 }
 
-vector<Estadistica> leerEstadisticas() {
-        vector<Estadistica> lista; // Contenedor donde se almacenaran las estadisticas leidas
-        ifstream archivo("estadisticas.txt"); // Abre el archivo en modo lectura
-
-        if (archivo.is_open()) { // Comprueba que el archivo exista y se pueda abrir
-                string linea; // Variable temporal para almacenar cada linea del archivo
-                while (getline(archivo, linea)) { // Lee el archivo linea a linea
-                        Estadistica stat; // Objeto temporal para cargar los datos desglosados
-                        size_t pos1 = linea.find('|'); // Ubica el primer delimitador
-                        size_t pos2 = linea.find('|', pos1 + 1); // Busca el segundo delimitador
-                        size_t pos3 = linea.find('|', pos2 + 1); // Busca el tercer delimitador
-                        size_t pos4 = linea.find('|', pos3 + 1); // Busca el cuarto delimitador
-                        size_t pos5 = linea.find('|', pos4 + 1); // Busca el quinto delimitador si existe
+// Interpreta una linea "nombre|puntos|tiempo|ronda|enemigos[|disparos]"; devuelve false si esta mal formada
+bool interpretarEstadistica(const string& linea, Estadistica& stat) {
+        size_t pos1 = linea.find('|'); // Ubica el primer delimitador
+        size_t pos2 = linea.find('|', pos1 + 1); // Busca el segundo delimitador
+        size_t pos3 = linea.find('|', pos2 + 1); // Busca el tercer delimitador
+        size_t pos4 = linea.find('|', pos3 + 1); // Busca el cuarto delimitador
+        size_t pos5 = linea.find('|', pos4 + 1); // Busca el quinto delimitador si existe
 
-                        if (pos1 != string::npos && pos2 != string::npos && pos3 != string::npos && pos4 != string::npos) { // Verifica que los delimitadores principales esten presentes
-                                stat.nombre = linea.substr(0, pos1); // Extrae el nombre del jugador
-                                stat.puntuacion = stoi(linea.substr(pos1 + 1, pos2 - pos1 - 1)); // Convierte la seccion de puntuacion a entero
-                                stat.tiempo = stof(linea.substr(pos2 + 1, pos3 - pos2 - 1)); // Convierte la seccion de tiempo a flotante
-                                stat.ronda = stoi(linea.substr(pos3 + 1, pos4 - pos3 - 1)); // Convierte la seccion de ronda a entero
+        if (pos1 == string::npos || pos2 == string::npos || pos3 == string::npos || pos4 == string::npos) return false; // Faltan delimitadores principales
 
-                                string enemigos_str = (pos5 != string::npos) ? linea.substr(pos4 + 1, pos5 - pos4 - 1) : linea.substr(pos4 + 1); // Obtiene la seccion de enemigos eliminados
-                                stat.enemigos_eliminados = stoi(enemigos_str); // Convierte el campo de enemigos a entero
+        stat.nombre = linea.substr(0, pos1); // Extrae el nombre del jugador
+        stat.puntuacion = stoi(linea.substr(pos1 + 1, pos2 - pos1 - 1)); // Convierte la seccion de puntuacion a entero
+        stat.tiempo = stof(linea.substr(pos2 + 1, pos3 - pos2 - 1)); // Convierte la seccion de tiempo a flotante
+        stat.ronda = stoi(linea.substr(pos3 + 1, pos4 - pos3 - 1)); // Convierte la seccion de ronda a entero
 
-                                stat.proyectiles_disparados = (pos5 != string::npos) ? stoi(linea.substr(pos5 + 1)) : 0; // Convierte el campo de proyectiles si existe, de lo contrario deja 0
+        string enemigos_str = (pos5 != string::npos) ? linea.substr(pos4 + 1, pos5 - pos4 - 1) : linea.substr(pos4 + 1); // Obtiene la seccion de enemigos eliminados
+        stat.enemigos_eliminados = stoi(enemigos_str); // Convierte el campo de enemigos a entero
 
-                                lista.push_back(stat); // Agrega la estadistica a la coleccion
-                        }
-                }
-                archivo.close(); // Cierra el archivo una vez terminado el proceso de lectura
-        }
-
-        sort(lista.begin(), lista.end(), [](const Estadistica& a, const Estadistica& b) {
-                return a.puntuacion > b.puntuacion; // Ordena de mayor a menor puntuacion utilizando una lambda
-        });
-
-        return lista; // Devuelve la lista ordenada de estadisticas
-}
-
-vector<Estadistica> obtenerTop5() {
-        vector<Estadistica> todas = leerEstadisticas(); // Recupera todas las estadisticas disponibles
-        vector<Estadistica> top5; // Vector que almacenara solo las mejores cinco
-        int limite = (todas.size() < 5) ? todas.size() : 5; // Determina cuantas entradas agregar segun el tamano disponible
-        for (int i = 0; i < limite; i++) { // Recorre las primeras posiciones
-                top5.push_back(todas[i]); // Copia cada estadistica seleccionada al vector top5
-        }
-        return top5; // Devuelve el subconjunto de mejores resultados
+        stat.proyectiles_disparados = (pos5 != string::npos) ? stoi(linea.substr(pos5 + 1)) : 0; // Convierte el campo de proyectiles si existe, de lo contrario deja 0
+        return true; // Linea valida
 }
 
 // ========== AUDIO ==========
@@ -445,12 +460,16 @@ ALLEGRO_SAMPLE* sfx_muerte = NULL; // Efecto de sonido para la muerte del jugado
 ALLEGRO_SAMPLE_ID id_musica_actual; // Identificador del sample actualmente en reproduccion
 bool hay_musica_sonando = false; // Bandera que indica si hay musica activa
 
+const int VOCES_AUDIO = 16; // Samples simultaneos reservados con al_reserve_samples
+double fin_voces[VOCES_AUDIO]; // Momento en que termina cada efecto en curso (0 = voz libre)
+long voces_rechazadas = 0; // Efectos que no sonaron por falta de voces libres
+
 void cargarAudio() {
-        musica_menu = al_load_sample("musica/Menu.ogg"); // Carga el archivo de musica del menu
-        musica_gameplay = al_load_sample("musica/fight.ogg"); // Carga la musica de fondo del gameplay
-        sfx_disparo = al_load_sample("musica/shoot.wav"); // Carga el efecto de disparo
-        sfx_explosion = al_load_sample("musica/enemyexp.wav"); // Carga el efecto de explosion de enemigos
-        sfx_muerte = al_load_sample("musica/playerexp.flac"); // Carga el efecto de muerte del jugador
+        musica_menu = cargarSampleRecurso("Musica/Menu.ogg"); // Carga el archivo de musica del menu
+        musica_gameplay = cargarSampleRecurso("Musica/fight.ogg"); // Carga la musica de fondo del gameplay
+        sfx_disparo = cargarSampleRecurso("Musica/shoot.wav"); // Carga el efecto de disparo
+        sfx_explosion = cargarSampleRecurso("Musica/enemyexp.wav"); // Carga el efecto de explosion de enemigos
+        sfx_muerte = cargarSampleRecurso("Musica/playerexp.flac"); // Carga el efecto de muerte del jugador
 }
 
 void tocarMusica(ALLEGRO_SAMPLE* musica, float volumen) {
@@ -466,7 +485,21 @@ void pararMusica() {
 }
 
 void tocarSonido(ALLEGRO_SAMPLE* sonido, float volumen) {
-        if (sonido) al_play_sample(sonido, volumen, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, NULL); // Reproduce el sonido indicado una unica vez
+        if (!sonido) return; // Sample no cargado
+        if (!al_play_sample(sonido, volumen, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, NULL)) { // Reproduce el sonido indicado una unica vez
+                voces_rechazadas++; // Todas las voces ocupadas
+                return; // No hay nada que registrar
+        }
+        int voz = 0; // Voz que termina antes (o libre)
+        for (int i = 1; i < VOCES_AUDIO; i++) if (fin_voces[i] < fin_voces[voz]) voz = i; // Allegro reutiliza las voces que ya terminaron
+        fin_voces[voz] = al_get_time() + (double)al_get_sample_length(sonido) / al_get_sample_frequency(sonido); // Duracion del sample
+}
+
+// Voces sonando en este momento, musica incluida, sin consultar al mezclador
+int vocesEnUso(double ahora) {
+        int n = hay_musica_sonando ? 1 : 0; // La musica ocupa una voz mientras suena
+        for (int i = 0; i < VOCES_AUDIO; i++) if (fin_voces[i] > ahora) n++; // Efectos que aun no terminan
+        return n; // Voces ocupadas
 }
 
 void limpiarAudio() {
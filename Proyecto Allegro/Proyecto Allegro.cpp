@@ -30,6 +30,16 @@
 
 #include "Funciones.h" // Declaraciones compartidas de estructuras y utilidades del juego
 #include "juego.h" // Funciones especificas del gameplay
+#include "opciones.h" // Opciones de linea de comandos
+#include "planificador.h" // Redibujado bajo demanda y suspension sin foco
+#include "atlas_fuentes.h" // Cache de fuentes pre-rasterizadas
+#include "arena.h" // Textos temporales del frame sin memoria dinamica
+#include "lote.h" // Simulacion por lotes para ajustar el equilibrio
+#include "telemetria.h" // Conversion de volcados de telemetria
+#include "paquete.h" // Recursos servidos desde un unico paquete proyectado en memoria
+#include "benchmark.h" // Benchmark del render sin ventana
+#include "clasificacion.h" // Tablas de puntuaciones indexadas sobre el historial
+#include "metricas.h" // Metricas en vivo en memoria compartida
 
 using namespace std; // Evita escribir std:: de forma repetida en el archivo
 
@@ -76,47 +86,39 @@ void renderizarMenu(int opcion, ALLEGRO_FONT* fuente_grande, ALLEGRO_FONT* fuent
 
         al_draw_text(fuente_pequena, al_map_rgb(100, 100, 100), ancho / 2, alto - 100, ALLEGRO_ALIGN_CENTER, "Usa W/S o Flechas para navegar"); // Muestra instrucciones de navegacion
         al_draw_text(fuente_pequena, al_map_rgb(100, 100, 100), ancho / 2, alto - 70, ALLEGRO_ALIGN_CENTER, "Presiona ENTER para seleccionar"); // Indica como seleccionar una opcion
-
-        al_flip_display(); // Presenta en pantalla el frame renderizado del menu
 }
 
-// Muestra el Top 5 de mejores puntuaciones
-void renderizarPantallaHighScores(ALLEGRO_FONT* fuente_grande, ALLEGRO_FONT* fuente_mediana, int ancho, int alto) {
+// Muestra una pagina de la tabla de puntuaciones elegida
+void renderizarPantallaHighScores(const PaginaClasificacion& pagina, ALLEGRO_FONT* fuente_grande, ALLEGRO_FONT* fuente_mediana, int ancho, int alto) {
         al_clear_to_color(al_map_rgb(0, 0, 0)); // Limpia la pantalla antes de dibujar la tabla
-        al_draw_text(fuente_grande, al_map_rgb(255, 215, 0), ancho / 2, alto / 2 - 300, ALLEGRO_ALIGN_CENTER, "TOP 5 HIGH SCORES"); // Titulo destacado de la pantalla de puntuaciones
-
-        vector<Estadistica> top5 = obtenerTop5(); // Recupera las cinco mejores estadisticas almacenadas
+        dibujarTextoArena(fuente_grande, al_map_rgb(255, 215, 0), ancho / 2, alto / 2 - 300, ALLEGRO_ALIGN_CENTER, "HIGH SCORES: %s", TITULOS_VISTAS_CLASIFICACION[pagina.vista]); // Titulo con la tabla actual
 
-        if (top5.empty()) { // Si aun no hay registros guardados
+        if (pagina.filas.empty()) { // Si aun no hay registros guardados
                 al_draw_text(fuente_mediana, al_map_rgb(150, 150, 150), ancho / 2, alto / 2, ALLEGRO_ALIGN_CENTER, "No hay puntuaciones registradas aun"); // Mensaje informativo al usuario
         } else { // Existen registros que mostrar
                 int y = -180; // Desplazamiento vertical inicial relativo al centro de la pantalla
-                for (size_t i = 0; i < top5.size(); i++) { // Recorre cada entrada del top 5
-                        ALLEGRO_COLOR color; // Variable para almacenar el color segun la posicion
-                        if (i == 0) color = al_map_rgb(255, 215, 0); // Oro para el primer lugar
-                        else if (i == 1) color = al_map_rgb(192, 192, 192); // Plata para el segundo lugar
-                        else if (i == 2) color = al_map_rgb(205, 127, 50); // Bronce para el tercer lugar
-                        else color = al_map_rgb(200, 200, 200); // Gris para el resto
-
-                        char nombre[100]; // Buffer para construir la linea de nombre y posicion
-                        sprintf_s(nombre, 100, "%d. %s", (int)(i + 1), top5[i].nombre.c_str()); // Formatea la posicion y el nombre
-                        al_draw_text(fuente_mediana, color, ancho / 2, alto / 2 + y, ALLEGRO_ALIGN_CENTER, nombre); // Dibuja el nombre con color segun el podio
-
-                        char datos[180]; // Buffer con informacion detallada de la estadistica
-                        sprintf_s(datos, 180, "Puntos: %d | Ronda: %d | Tiempo: %.1f s | Enemigos: %d | Disparos: %d", top5[i].puntuacion, top5[i].ronda, top5[i].tiempo, top5[i].enemigos_eliminados, top5[i].proyectiles_disparados); // Compone la descripcion
-                        al_draw_text(fuente_mediana, al_map_rgb(120, 120, 120), ancho / 2, alto / 2 + y + 30, ALLEGRO_ALIGN_CENTER, datos); // Muestra los datos secundarios en gris suave
+                for (size_t i = 0; i < pagina.filas.size(); i++) { // Recorre cada entrada de la pagina
+                        const Estadistica& fila = pagina.filas[i]; // Partida de la fila
+                        int posicion = pagina.primera_posicion + (int)i; // Posicion en la tabla completa
+                        dibujarTextoArena(fuente_mediana, colorPodio(posicion - 1), ancho / 2, alto / 2 + y, ALLEGRO_ALIGN_CENTER, "%d. %s", posicion, fila.nombre.c_str()); // Dibuja el nombre con color segun el podio
+                        dibujarTextoArena(fuente_mediana, al_map_rgb(120, 120, 120), ancho / 2, alto / 2 + y + 30, ALLEGRO_ALIGN_CENTER, "Puntos: %d | Ronda: %d | Tiempo: %.1f s | Enemigos: %d | Disparos: %d | Precision: %d%%", fila.puntuacion, fila.ronda, fila.tiempo, fila.enemigos_eliminados, fila.proyectiles_disparados, (int)(precisionEstadistica(fila) * 100.0f + 0.5f)); // Muestra los datos secundarios en gris suave
 
                         y += 80; // Avanza la posicion vertical para la siguiente entrada
                 }
         }
 
+        dibujarTextoArena(fuente_mediana, al_map_rgb(150, 150, 150), ancho / 2, alto - 140, ALLEGRO_ALIGN_CENTER, "Pagina %d de %d", pagina.pagina + 1, pagina.paginas); // Paginacion de la tabla
+        al_draw_text(fuente_mediana, al_map_rgb(150, 150, 150), ancho / 2, alto - 110, ALLEGRO_ALIGN_CENTER, "A/D o Flechas: tabla | W/S o Flechas: pagina"); // Navegacion entre tablas y paginas
         al_draw_text(fuente_mediana, al_map_rgb(150, 150, 150), ancho / 2, alto - 80, ALLEGRO_ALIGN_CENTER, "Presiona ESC para volver al menu"); // Instruccion para regresar al menu
-        al_flip_display(); // Actualiza la pantalla con el contenido renderizado
 }
 
 // ========== FUNCION PRINCIPAL ==========
 
-int main() {
+int main(int argc, char** argv) {
+        leerOpciones(argc, argv); // Interpreta las opciones de linea de comandos
+        if (opciones.convertir_telemetria) return convertirTelemetria(opciones.convertir_telemetria, opciones.salida_telemetria); // Herramienta de telemetria: no necesita Allegro
+        if (opciones.empaquetar) return empaquetarRecursos(opciones.empaquetar); // Empaquetador de recursos: tampoco necesita Allegro
+        if (opciones.metricas_ms > 0) return leerMetricasEnVivo(opciones.metricas_ms); // Lector de metricas: otro proceso, sin Allegro
         srand((unsigned int)time(NULL)); // Inicializa el generador de numeros aleatorios con la hora actual
 
         if (!al_init()) { // Comprueba si Allegro se inicializa correctamente
@@ -132,49 +134,63 @@ int main() {
         al_uninstall_mouse(); // Desactiva el raton porque no se utiliza
         al_install_audio(); // Inicializa el subsistema de audio
         al_init_acodec_addon(); // Habilita los codecs necesarios para reproducir sonido
-        al_reserve_samples(16); // Reserva 16 canales de audio simultaneos para musica y efectos
+        al_reserve_samples(VOCES_AUDIO); // Reserva 16 canales de audio simultaneos para musica y efectos
+
+        abrirPaquete(paquete_recursos, RUTA_PAQUETE); // Si no hay paquete se cargan los archivos sueltos
+
+        if (opciones.verificar_asignaciones > 0) return verificarAsignaciones(opciones.verificar_asignaciones); // Modo de prueba: simula sin ventana y termina
+        if (opciones.simular_partidas > 0) return ejecutarLote(); // Modo por lotes: juega sin ventana y termina
+        if (opciones.benchmark > 0) return ejecutarBenchmark(); // Benchmark del render: dibuja en memoria sin ventana y termina
 
         ALLEGRO_MONITOR_INFO info; // Estructura para almacenar informacion del monitor principal
         al_get_monitor_info(0, &info); // Obtiene las dimensiones del monitor 0
         int ancho = info.x2 - info.x1; // Calcula el ancho total de la pantalla
         int alto = info.y2 - info.y1; // Calcula el alto total de la pantalla
 
+        al_set_new_display_flags(ALLEGRO_GENERATE_EXPOSE_EVENTS); // Pide ALLEGRO_EVENT_DISPLAY_EXPOSE para redibujar lo que quede descubierto
         ALLEGRO_DISPLAY* pantalla = al_create_display(ancho, alto); // Crea una ventana o pantalla a resolucion completa
         if (!pantalla) { // Verifica que la pantalla se haya creado correctamente
                 al_show_native_message_box(NULL, "Error", "Error", "No se pudo crear la pantalla", NULL, 0); // Informa si hubo un error creando la ventana
                 return -1; // Termina la ejecucion porque no se puede continuar sin pantalla
         }
 
-        ALLEGRO_FONT* font_grande = al_load_ttf_font("MONSTER.ttf", 72, 0); // Carga la fuente grande usada en el titulo
+        const int tamanos_fuente[3] = {72, 24, 16}; // Tamanos usados por el menu y el gameplay
+        ALLEGRO_FONT* fuentes_atlas[3]; // Fuentes cargadas desde el atlas cacheado (NULL si no hubo cache)
+        cargarFuentesAtlas("MONSTER.ttf", tamanos_fuente, 3, fuentes_atlas); // Evita rasterizar glifos con FreeType durante la partida
+
+        ALLEGRO_FONT* font_grande = fuentes_atlas[0] ? fuentes_atlas[0] : cargarFuenteRecurso("MONSTER.ttf", 72, 0); // Carga la fuente grande usada en el titulo
         if (!font_grande) { // Comprueba que la fuente se haya cargado
                 al_show_native_message_box(pantalla, "Error", "Error", "No se pudo cargar la fuente grande", NULL, 0); // Muestra mensaje si falla
                 return -1; // Cancela la aplicacion para evitar fallos posteriores
         }
 
-        ALLEGRO_FONT* font_mediana = al_load_ttf_font("MONSTER.ttf", 24, 0); // Carga la fuente mediana para textos generales
+        ALLEGRO_FONT* font_mediana = fuentes_atlas[1] ? fuentes_atlas[1] : cargarFuenteRecurso("MONSTER.ttf", 24, 0); // Carga la fuente mediana para textos generales
         if (!font_mediana) { // Valida la carga de la fuente mediana
                 al_show_native_message_box(pantalla, "Error", "Error", "No se pudo cargar la fuente mediana", NULL, 0); // Muestra aviso de error
                 return -1; // Interrumpe la ejecucion si no se puede dibujar texto
         }
 
-        ALLEGRO_FONT* font_pequena = al_load_ttf_font("MONSTER.ttf", 16, 0); // Carga la fuente pequena para instrucciones
+        ALLEGRO_FONT* font_pequena = fuentes_atlas[2] ? fuentes_atlas[2] : cargarFuenteRecurso("MONSTER.ttf", 16, 0); // Carga la fuente pequena para instrucciones
         if (!font_pequena) { // Comprueba que se cargo la fuente pequena
                 al_show_native_message_box(pantalla, "Error", "Error", "No se pudo cargar la fuente pequena", NULL, 0); // Muestra mensaje de error
                 return -1; // Finaliza porque el menu necesita esta fuente
         }
 
-        ALLEGRO_BITMAP* fondo_menu = al_load_bitmap("Imagenes/menu.png"); // Intenta cargar la imagen del menu principal
+        ALLEGRO_BITMAP* fondo_menu = cargarBitmapRecurso("Imagenes/menu.png"); // Intenta cargar la imagen del menu principal
         if (!fondo_menu) { // Si la imagen no esta disponible
                 al_show_native_message_box(pantalla, "Advertencia", "Aviso", "No se pudo cargar la imagen de fondo del menu", NULL, ALLEGRO_MESSAGEBOX_WARN); // Advierte al usuario pero no detiene el programa
         }
 
-        ALLEGRO_BITMAP* fondo_gameplay = al_load_bitmap("Imagenes/gameplay.png"); // Carga la imagen de fondo para el gameplay
+        ALLEGRO_BITMAP* fondo_gameplay = cargarBitmapRecurso("Imagenes/gameplay.png"); // Carga la imagen de fondo para el gameplay
         if (!fondo_gameplay) { // Verifica si se logro cargar
                 al_show_native_message_box(pantalla, "Advertencia", "Aviso", "No se pudo cargar la imagen de fondo del gameplay", NULL, ALLEGRO_MESSAGEBOX_WARN); // Notifica la ausencia del fondo de juego
         }
 
+        iniciarArena(arena_frame, CAPACIDAD_ARENA_FRAME); // Unica reserva para todo el texto temporal de cada frame
         cargarAudio(); // Carga todos los samples de audio definidos en Funciones.h
+        cargarClasificacion(clasificacion, "estadisticas.txt"); // El historial se lee e indexa una sola vez; cada partida nueva se agrega a los indices
         tocarMusica(musica_menu, 0.5f); // Reproduce la musica del menu en bucle con volumen moderado
+        abrirMetricas(metricas); // Sin memoria compartida el juego sigue sin publicar
 
         ALLEGRO_TIMER* timer = al_create_timer(1.0 / 60.0); // Crea un temporizador para generar eventos a 60 FPS
         ALLEGRO_EVENT_QUEUE* queue = al_create_event_queue(); // Crea la cola donde se almacenaran eventos del sistema
@@ -186,6 +202,9 @@ int main() {
         EstadoApp app = APP_MENU; // Variable que guarda el estado actual de la aplicacion, inicia en el menu
         int opcion = 0; // Indica cual opcion del menu esta seleccionada al inicio
         float timer_anim = 0.0f; // Acumula tiempo para potenciales animaciones de interfaz
+        PaginaClasificacion pagina; // Pagina visible de la pantalla de high scores
+        PlanificadorRender planificador; // Decide cuando hace falta redibujar
+        iniciarPlanificador(planificador); // El primer frame se dibuja siempre
 
         al_start_timer(timer); // Inicia el temporizador para que comience a generar eventos de reloj
         bool running = true; // Bandera que indica si el bucle principal debe seguir ejecutandose
@@ -194,6 +213,10 @@ int main() {
                 ALLEGRO_EVENT ev; // Estructura para recibir eventos
                 al_wait_for_event(queue, &ev); // Espera bloqueante hasta recibir un evento disponible
 
+                if (procesarEventoPantalla(planificador, ev, timer)) continue; // Foco, minimizado y exposicion de la ventana
+
+                if (ev.type == ALLEGRO_EVENT_KEY_DOWN) marcarSucio(planificador); // Cualquier pulsacion puede cambiar lo que se muestra
+
                 if (app == APP_MENU && ev.type == ALLEGRO_EVENT_KEY_DOWN) { // Gestion de entradas mientras se esta en el menu
                         if (ev.keyboard.keycode == ALLEGRO_KEY_ESCAPE) { // Si se presiona Escape en el menu
                                 running = false; // Se sale por completo de la aplicacion
@@ -213,26 +236,43 @@ int main() {
                                 if (opcion == 0) { // Si el usuario eligio jugar
                                         iniciarJuego(ancho, alto, font_mediana, timer, queue, fondo_gameplay); // Lanza el gameplay principal con los recursos necesarios
                                         tocarMusica(musica_menu, 0.5f); // Reanuda la musica del menu tras salir del juego
+                                        if (!al_get_timer_started(timer)) al_resume_timer(timer); // El juego pudo terminar con el temporizador suspendido
+                                        marcarSucio(planificador); // El menu debe volver a pintarse sobre el ultimo frame del juego
                                 } else if (opcion == 1) { // Si el usuario quiere ver los high scores
                                         app = APP_HIGH_SCORES; // Cambia al estado de pantalla de puntuaciones
+                                        prepararPaginaClasificacion(clasificacion, pagina, VISTA_PUNTUACION, 0); // Primera pagina de la tabla de puntos
                                 } else if (opcion == 2) { // Si el usuario decide salir
                                         running = false; // Termina el bucle principal para cerrar la aplicacion
                                 }
                         }
                 }
 
-                if (app == APP_HIGH_SCORES && ev.type == ALLEGRO_EVENT_KEY_DOWN && ev.keyboard.keycode == ALLEGRO_KEY_ESCAPE) { // Gestiona la salida de la pantalla de high scores
-                        app = APP_MENU; // Regresa al estado de menu cuando se presiona Escape
+                if (app == APP_HIGH_SCORES && ev.type == ALLEGRO_EVENT_KEY_DOWN) { // Gestiona la pantalla de high scores
+                        int tecla = ev.keyboard.keycode; // Tecla pulsada
+                        if (tecla == ALLEGRO_KEY_ESCAPE) app = APP_MENU; // Regresa al estado de menu cuando se presiona Escape
+                        if (tecla == ALLEGRO_KEY_A || tecla == ALLEGRO_KEY_LEFT) prepararPaginaClasificacion(clasificacion, pagina, (pagina.vista + NUM_VISTAS_CLASIFICACION - 1) % NUM_VISTAS_CLASIFICACION, 0); // Tabla anterior
+                        if (tecla == ALLEGRO_KEY_D || tecla == ALLEGRO_KEY_RIGHT) prepararPaginaClasificacion(clasificacion, pagina, (pagina.vista + 1) % NUM_VISTAS_CLASIFICACION, 0); // Tabla siguiente
+                        if (tecla == ALLEGRO_KEY_W || tecla == ALLEGRO_KEY_UP) prepararPaginaClasificacion(clasificacion, pagina, pagina.vista, pagina.pagina - 1); // Pagina anterior
+                        if (tecla == ALLEGRO_KEY_S || tecla == ALLEGRO_KEY_DOWN) prepararPaginaClasificacion(clasificacion, pagina, pagina.vista, pagina.pagina + 1); // Pagina siguiente
                 }
 
                 if (ev.type == ALLEGRO_EVENT_TIMER && ev.timer.source == timer) { // Se ejecuta cada tick del temporizador
                         timer_anim += 1.0f / 60.0f; // Incrementa el acumulador temporal a razon de un frame
-
-                        if (app == APP_MENU) { // Si se esta en el menu
-                                renderizarMenu(opcion, font_grande, font_mediana, font_pequena, ancho, alto, timer_anim, fondo_menu); // Redibuja el menu con la opcion actual
-                        } else if (app == APP_HIGH_SCORES) { // Si se esta en la pantalla de puntuaciones
-                                renderizarPantallaHighScores(font_grande, font_mediana, ancho, alto); // Actualiza la vista del top 5
+                        metricas.datos.aplicacion = (app == APP_MENU) ? MET_MENU : MET_PUNTUACIONES; // Pantalla actual
+                        metricas.datos.estado = -1; // Fuera de partida
+                        datosAudioMetricas(metricas, al_get_time()); // Voces de la musica del menu
+
+                        if (debeDibujar(planificador)) { // Solo se redibuja si algo cambio desde el ultimo frame
+                                if (app == APP_MENU) { // Si se esta en el menu
+                                        renderizarMenu(opcion, font_grande, font_mediana, font_pequena, ancho, alto, timer_anim, fondo_menu); // Redibuja el menu con la opcion actual
+                                } else if (app == APP_HIGH_SCORES) { // Si se esta en la pantalla de puntuaciones
+                                        renderizarPantallaHighScores(pagina, font_grande, font_mediana, ancho, alto); // Dibuja la pagina ya resuelta
+                                }
+                                al_flip_display(); // Presenta el frame una unica vez, fuera de las funciones de dibujo
+                                reiniciarArena(arena_frame); // Los textos del frame ya no se necesitan
+                                registrarFrameMetricas(metricas, al_get_time()); // Frame presentado
                         }
+                        publicarMetricas(metricas); // El menu tambien informa que el juego sigue vivo
                 }
 
                 if (ev.type == ALLEGRO_EVENT_DISPLAY_CLOSE) { // Maneja el evento de cierre de la ventana
@@ -240,12 +280,17 @@ int main() {
                 }
         }
 
+        printf("Menu: %ld frames dibujados, %ld omitidos, %d suspensiones (%.1f s)\n", planificador.frames_dibujados, planificador.frames_omitidos, planificador.suspensiones, planificador.segundos_suspendido); // Resumen del planificador por consola
+
+        cerrarMetricas(metricas); // El lector ve el cierre y el segmento desaparece
         limpiarAudio(); // Libera todos los recursos de audio cargados previamente
+        destruirArena(arena_frame); // Libera el bloque de la arena
         if (fondo_menu) al_destroy_bitmap(fondo_menu); // Destruye el bitmap del menu si fue cargado
         if (fondo_gameplay) al_destroy_bitmap(fondo_gameplay); // Destruye el bitmap del gameplay si existe
         al_destroy_font(font_grande); // Libera la fuente grande
         al_destroy_font(font_mediana); // Libera la fuente mediana
         al_destroy_font(font_pequena); // Libera la fuente pequena
+        cerrarPaquete(paquete_recursos); // Ninguna fuente lee ya de la proyeccion
         al_destroy_event_queue(queue); // Destruye la cola de eventos
         al_destroy_timer(timer); // Destruye el temporizador
         al_destroy_display(pantalla); // Cierra y libera la pantalla principal
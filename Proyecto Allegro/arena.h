@@ -0,0 +1,136 @@
+/*
+ * ARENA.H
+ * -------
+ * Arena lineal de un frame para textos y contenedores temporales de la interfaz:
+ * se reserva una sola vez, se asigna avanzando un indice y se vacia tras presentar el frame
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cstdarg> // Argumentos variables de los formateadores
+#include <cstddef> // size_t y max_align_t
+#include <cstdio> // vsnprintf, disponible en Windows y Linux
+#include <new> // operator new de respaldo cuando la arena se llena
+#include <string> // basic_string sobre la arena
+#include <allegro5/allegro.h> // ALLEGRO_COLOR
+#include <allegro5/allegro_font.h> // Dibujo del texto formateado
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const size_t CAPACIDAD_ARENA_FRAME = 64 * 1024; // Sobra para todo el texto de un frame
+
+// ========== ESTRUCTURAS ==========
+
+struct ArenaFrame {
+        char* memoria; // Bloque reservado una unica vez
+        size_t capacidad; // Bytes del bloque
+        size_t usado; // Bytes asignados en el frame actual
+        size_t pico; // Maximo usado en un frame
+        long desbordes; // Peticiones que no cupieron y se sirvieron desde el heap
+};
+
+ArenaFrame arena_frame = {NULL, 0, 0, 0, 0}; // Arena compartida por todo el dibujo del frame
+
+// ========== GESTION ==========
+
+void iniciarArena(ArenaFrame& a, size_t capacidad) {
+        a.memoria = new char[capacidad]; // Unica asignacion de la arena
+        a.capacidad = capacidad; // Tamano disponible
+        a.usado = 0; // Vacia
+        a.pico = 0; // Sin frames medidos
+        a.desbordes = 0; // Sin desbordes
+}
+
+void destruirArena(ArenaFrame& a) {
+        delete[] a.memoria; // Libera el bloque completo
+        a.memoria = NULL; // La arena queda sin memoria
+        a.capacidad = 0; // Toda peticion ira al heap
+        a.usado = 0; // Vacia
+}
+
+// Se llama despues de al_flip_display: todo lo asignado durante el frame deja de ser valido
+void reiniciarArena(ArenaFrame& a) {
+        if (a.usado > a.pico) a.pico = a.usado; // Registra el maximo
+        a.usado = 0; // Vuelve al principio del bloque
+}
+
+// Devuelve NULL si la peticion no cabe en lo que queda del frame
+void* reservarArena(ArenaFrame& a, size_t bytes, size_t alineacion) {
+        size_t inicio = (a.usado + alineacion - 1) & ~(alineacion - 1); // Primer desplazamiento alineado
+        if (inicio + bytes > a.capacidad) return NULL; // No cabe
+        a.usado = inicio + bytes; // Avanza el indice
+        return a.memoria + inicio; // Memoria valida hasta el proximo reinicio
+}
+
+bool perteneceArena(const ArenaFrame& a, const void* p) {
+        return p >= (const void*)a.memoria && p < (const void*)(a.memoria + a.capacidad); // Dentro del bloque
+}
+
+// ========== FORMATO ==========
+
+// Formatea dentro de la arena; si no cabe, el texto se recorta a lo que queda del frame
+const char* formatearArenaV(ArenaFrame& a, const char* formato, va_list args) {
+        size_t libre = a.capacidad - a.usado; // Espacio restante
+        if (libre == 0) { // Arena agotada (o sin iniciar)
+                a.desbordes++; // Cuenta el desborde
+                return ""; // Texto vacio sin tocar el heap
+        }
+        char* destino = a.memoria + a.usado; // El texto empieza en la posicion actual
+        int n = vsnprintf(destino, libre, formato, args); // Formato portable: sustituye a sprintf_s
+        if (n < 0) n = 0; // Formato invalido: cadena vacia
+        if ((size_t)n >= libre) { // Recortado
+                a.desbordes++; // Cuenta el desborde
+                n = (int)libre - 1; // Se consume todo lo que quedaba
+        }
+        a.usado += (size_t)n + 1; // Incluye el terminador
+        return destino; // Valido hasta el proximo reinicio
+}
+
+const char* formatearArena(ArenaFrame& a, const char* formato, ...) {
+        va_list args; // Argumentos del formato
+        va_start(args, formato); // Comienza la lectura de argumentos
+        const char* texto = formatearArenaV(a, formato, args); // Formatea en la arena
+        va_end(args); // Termina la lectura
+        return texto; // Texto del frame
+}
+
+// Igual que al_draw_textf, pero el texto se formatea en la arena del frame en lugar de en una ALLEGRO_USTR del heap
+void dibujarTextoArena(const ALLEGRO_FONT* fuente, ALLEGRO_COLOR color, float x, float y, int flags, const char* formato, ...) {
+        va_list args; // Argumentos del formato
+        va_start(args, formato); // Comienza la lectura de argumentos
+        const char* texto = formatearArenaV(arena_frame, formato, args); // Formatea en la arena compartida
+        va_end(args); // Termina la lectura
+        al_draw_text(fuente, color, x, y, flags, texto); // Dibuja el texto ya formateado
+}
+
+// ========== ADAPTADOR STL ==========
+
+// Asignador para contenedores estandar: toma memoria de la arena y no libera nada hasta el reinicio.
+// Si la arena se llena recurre al heap, asi que un contenedor nunca falla por falta de espacio
+template <class T>
+struct AsignadorArena {
+        typedef T value_type; // Tipo asignado
+
+        ArenaFrame* arena; // Arena de la que se toma la memoria
+
+        explicit AsignadorArena(ArenaFrame& a) : arena(&a) {} // Asignador sobre una arena concreta
+        template <class U> AsignadorArena(const AsignadorArena<U>& otro) : arena(otro.arena) {} // Conversion entre tipos (rebind)
+
+        T* allocate(size_t n) {
+                void* p = reservarArena(*arena, n * sizeof(T), alignof(T)); // Intenta servir desde la arena
+                if (p) return (T*)p; // Cupo
+                arena->desbordes++; // Cuenta el desborde
+                return (T*)::operator new(n * sizeof(T)); // Respaldo en el heap
+        }
+
+        void deallocate(T* p, size_t) {
+                if (!perteneceArena(*arena, p)) ::operator delete(p); // Solo se libera lo que vino del heap
+        }
+};
+
+template <class T, class U> bool operator==(const AsignadorArena<T>& a, const AsignadorArena<U>& b) { return a.arena == b.arena; } // Misma arena, memoria intercambiable
+template <class T, class U> bool operator!=(const AsignadorArena<T>& a, const AsignadorArena<U>& b) { return a.arena != b.arena; } // Arenas distintas
+
+typedef basic_string<char, char_traits<char>, AsignadorArena<char> > CadenaArena; // Cadena temporal del frame
@@ -0,0 +1,179 @@
+/*
+ * ATLAS_FUENTES.H
+ * ---------------
+ * Cache persistente de fuentes pre-rasterizadas: los glifos de cada tamano
+ * se empaquetan en un unico atlas PNG que se carga como fuente bitmap
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <fstream> // Lectura del TTF y de las metricas del atlas
+#include <string> // Rutas y lineas del archivo de metricas
+#include <vector> // Bandas del atlas
+#include <allegro5/allegro.h> // Bitmaps, bloqueo y guardado
+#include <allegro5/allegro_font.h> // al_grab_font_from_bitmap y dibujo de glifos
+#include <allegro5/allegro_ttf.h> // Rasterizado del TTF cuando el atlas no es valido
+#include <allegro5/allegro_image.h> // Guardado y carga del PNG
+#include "paquete.h" // El TTF puede venir del paquete de recursos
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const char* const RUTA_ATLAS_PNG = "fuentes_atlas.png"; // Imagen con los glifos de todos los tamanos
+const char* const RUTA_ATLAS_METRICAS = "fuentes_atlas.txt"; // Hash del TTF, tamanos y posicion de cada banda
+const int VERSION_ATLAS = 1; // Cambia si cambia el formato del atlas
+const int ANCHO_ATLAS = 1024; // Ancho fijo del atlas en pixeles
+const int PRIMER_GLIFO = 32; // Espacio
+const int ULTIMO_GLIFO = 126; // Tilde (~): todo el ASCII imprimible
+
+// ========== ESTRUCTURAS ==========
+
+struct BandaAtlas {
+        int tamano; // Tamano en puntos con el que se rasterizo la banda
+        int y, alto; // Region vertical del atlas ocupada por la banda
+};
+
+// ========== METRICAS ==========
+
+unsigned int mezclarHashFuente(unsigned int hash, const unsigned char* bytes, size_t n) {
+        for (size_t i = 0; i < n; i++) { // Mezcla cada byte
+                hash ^= bytes[i]; // Combina el byte
+                hash *= 16777619u; // Primo de FNV
+        }
+        return hash; // Hash acumulado
+}
+
+unsigned int hashArchivoFuente(const char* ruta) {
+        unsigned int hash = 2166136261u; // Base de FNV-1a
+        const unsigned char* empaquetado; // Bytes del TTF dentro del paquete
+        size_t tamano; // Tamano del TTF empaquetado
+        if (datosRecurso(paquete_recursos, ruta, &empaquetado, &tamano)) return mezclarHashFuente(hash, empaquetado, tamano); // Se lee de la proyeccion, sin abrir archivos
+
+        ifstream archivo(ruta, ios::binary); // El TTF se lee como bytes, sin FreeType
+        if (!archivo.is_open()) return 0; // Sin archivo no hay hash
+        char bloque[4096]; // Lectura por bloques
+        while (archivo.read(bloque, sizeof(bloque)) || archivo.gcount() > 0) { // Hasta agotar el archivo
+                hash = mezclarHashFuente(hash, (const unsigned char*)bloque, (size_t)archivo.gcount()); // Bytes validos del bloque
+        }
+        return hash; // Huella del contenido del TTF
+}
+
+bool leerMetricasAtlas(unsigned int hash, const int* tamanos, int n, vector<BandaAtlas>& bandas) {
+        ifstream archivo(RUTA_ATLAS_METRICAS); // Metricas escritas junto al atlas
+        if (!archivo.is_open()) return false; // Todavia no hay cache
+
+        int version = 0, num = 0; // Cabecera
+        unsigned int hash_guardado = 0; // Hash del TTF con el que se genero
+        archivo >> version >> hex >> hash_guardado >> dec >> num; // Lee la cabecera
+        if (!archivo || version != VERSION_ATLAS || hash_guardado != hash || num != n) return false; // TTF, formato o cantidad de tamanos distintos
+
+        bandas.resize(n); // Una banda por tamano
+        for (int i = 0; i < n; i++) { // Cada banda en el mismo orden solicitado
+                archivo >> bandas[i].tamano >> bandas[i].y >> bandas[i].alto; // Tamano y region
+                if (!archivo || bandas[i].tamano != tamanos[i]) return false; // El conjunto de tamanos cambio
+        }
+        return true; // La cache corresponde al TTF y tamanos actuales
+}
+
+void escribirMetricasAtlas(unsigned int hash, const vector<BandaAtlas>& bandas) {
+        ofstream archivo(RUTA_ATLAS_METRICAS); // Sobrescribe las metricas anteriores
+        if (!archivo.is_open()) return; // Sin permisos de escritura simplemente no se cachea
+        archivo << VERSION_ATLAS << " " << hex << hash << dec << " " << bandas.size() << "\n"; // Cabecera
+        for (size_t i = 0; i < bandas.size(); i++) { // Una linea por banda
+                archivo << bandas[i].tamano << " " << bandas[i].y << " " << bandas[i].alto << "\n"; // Tamano y region
+        }
+}
+
+// ========== CONSTRUCCION ==========
+
+// Rasteriza todos los glifos con FreeType y los empaqueta en el formato de al_grab_font_from_bitmap:
+// cada glifo ocupa una celda del ancho de su avance y del alto de linea, separada por un pixel magenta
+ALLEGRO_BITMAP* construirAtlas(const char* ruta_ttf, const int* tamanos, int n, vector<BandaAtlas>& bandas) {
+        vector<ALLEGRO_FONT*> ttf(n, (ALLEGRO_FONT*)NULL); // Fuentes TrueType temporales
+        bandas.resize(n); // Una banda por tamano
+        int y_banda = 0; // Inicio de la banda actual
+
+        for (int i = 0; i < n; i++) { // Calcula primero la distribucion para conocer el alto total
+                ttf[i] = cargarFuenteRecurso(ruta_ttf, tamanos[i], 0); // Rasterizador de este tamano
+                if (!ttf[i]) { // No se pudo abrir el TTF
+                        for (int k = 0; k < i; k++) al_destroy_font(ttf[k]); // Libera las ya cargadas
+                        return NULL; // El llamador usara las fuentes TTF directamente
+                }
+                int alto_linea = al_get_font_line_height(ttf[i]); // Alto comun de todas las celdas
+                int x = 1, y = y_banda + 1; // Se deja el borde separador
+                for (int c = PRIMER_GLIFO; c <= ULTIMO_GLIFO; c++) { // Simula la colocacion de cada glifo
+                        int w = al_get_glyph_advance(ttf[i], c, ALLEGRO_NO_KERNING); // Ancho de la celda
+                        if (w < 1) w = 1; // Toda celda debe ocupar al menos un pixel
+                        if (x + w + 1 > ANCHO_ATLAS) { x = 1; y += alto_linea + 1; } // Salta a la siguiente fila
+                        x += w + 1; // Avanza con separador
+                }
+                bandas[i].tamano = tamanos[i]; // Tamano de la banda
+                bandas[i].y = y_banda; // Inicio de la banda
+                bandas[i].alto = y + alto_linea + 1 - y_banda; // Alto incluyendo el borde inferior
+                y_banda += bandas[i].alto; // La siguiente banda empieza a continuacion
+        }
+
+        int flags = al_get_new_bitmap_flags(); // Conserva la configuracion previa de bitmaps
+        al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP); // Se construye en memoria para poder guardarlo sin copias
+        ALLEGRO_BITMAP* atlas = al_create_bitmap(ANCHO_ATLAS, y_banda); // Atlas con todas las bandas
+        al_set_new_bitmap_flags(flags); // Restaura la configuracion previa
+
+        if (atlas) {
+                ALLEGRO_BITMAP* destino = al_get_target_bitmap(); // Se restaurara al terminar
+                al_set_target_bitmap(atlas); // Se dibuja sobre el atlas
+                al_clear_to_color(al_map_rgb(255, 0, 255)); // Color separador (se detecta en el pixel 0,0 de cada banda)
+
+                for (int i = 0; i < n; i++) { // Dibuja cada banda
+                        int alto_linea = al_get_font_line_height(ttf[i]); // Alto de las celdas
+                        int x = 1, y = bandas[i].y + 1; // Misma distribucion que en el calculo
+                        for (int c = PRIMER_GLIFO; c <= ULTIMO_GLIFO; c++) { // Cada glifo del rango
+                                int w = al_get_glyph_advance(ttf[i], c, ALLEGRO_NO_KERNING); // Ancho de la celda
+                                if (w < 1) w = 1; // Igual que en el calculo
+                                if (x + w + 1 > ANCHO_ATLAS) { x = 1; y += alto_linea + 1; } // Siguiente fila
+
+                                al_set_clipping_rectangle(x, y, w, alto_linea); // El glifo no puede invadir los separadores
+                                al_clear_to_color(al_map_rgba(0, 0, 0, 0)); // Fondo transparente de la celda
+                                al_draw_glyph(ttf[i], al_map_rgb(255, 255, 255), x, y, c); // Glifo blanco: se tine al dibujar el texto
+                                x += w + 1; // Avanza con separador
+                        }
+                }
+                al_reset_clipping_rectangle(); // Vuelve a permitir dibujo en todo el atlas
+                al_set_target_bitmap(destino); // Restaura el destino de dibujo
+        }
+
+        for (int i = 0; i < n; i++) al_destroy_font(ttf[i]); // FreeType ya no se necesita
+        return atlas; // Puede ser NULL si no se pudo crear
+}
+
+// ========== CARGA ==========
+
+// Carga las fuentes desde el atlas cacheado, regenerandolo si el TTF o los tamanos cambiaron.
+// Las posiciones sin fuente quedan en NULL para que el llamador recurra al TTF
+void cargarFuentesAtlas(const char* ruta_ttf, const int* tamanos, int n, ALLEGRO_FONT** fuentes) {
+        for (int i = 0; i < n; i++) fuentes[i] = NULL; // Nada cargado todavia
+
+        unsigned int hash = hashArchivoFuente(ruta_ttf); // Huella del TTF actual
+        if (hash == 0) return; // Sin TTF no hay nada que cachear
+
+        vector<BandaAtlas> bandas; // Region de cada tamano dentro del atlas
+        ALLEGRO_BITMAP* atlas = NULL; // Atlas cargado o recien construido
+        if (leerMetricasAtlas(hash, tamanos, n, bandas)) { // La cache es valida
+                atlas = al_load_bitmap_flags(RUTA_ATLAS_PNG, ALLEGRO_NO_PREMULTIPLIED_ALPHA); // Los pixeles ya se guardaron premultiplicados
+        }
+        if (!atlas) { // No hay cache valida: se rasteriza una unica vez
+                atlas = construirAtlas(ruta_ttf, tamanos, n, bandas); // Empaqueta todos los glifos
+                if (!atlas) return; // Sin atlas se usaran las fuentes TTF
+                if (al_save_bitmap(RUTA_ATLAS_PNG, atlas)) escribirMetricasAtlas(hash, bandas); // Las metricas solo se escriben si el PNG se guardo
+        }
+
+        int rango[2] = {PRIMER_GLIFO, ULTIMO_GLIFO}; // Todos los glifos de cada banda
+        for (int i = 0; i < n; i++) { // Una fuente por banda
+                ALLEGRO_BITMAP* banda = al_create_sub_bitmap(atlas, 0, bandas[i].y, ANCHO_ATLAS, bandas[i].alto); // Vista de la banda dentro del atlas
+                if (banda) {
+                        fuentes[i] = al_grab_font_from_bitmap(banda, 1, rango); // Copia los glifos a la fuente bitmap
+                        al_destroy_bitmap(banda); // La vista ya no se necesita
+                }
+        }
+        al_destroy_bitmap(atlas); // Las fuentes tienen su propia copia de los glifos
+}
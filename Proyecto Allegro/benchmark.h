@@ -0,0 +1,233 @@
+/*
+ * BENCHMARK.H
+ * -----------
+ * Banco de pruebas del render sin ventana: dibuja escenas fijas sobre un bitmap
+ * en memoria con las mismas funciones que el juego y mide el coste de cada una
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cstdio> // printf para la tabla de resultados
+#include <string> // Rutas de las capturas
+#include <vector> // Tiempos por frame, pools y top 5
+#include <algorithm> // sort para el percentil
+#include <allegro5/allegro.h> // Bitmaps en memoria y temporizacion
+#include <allegro5/allegro_font.h> // Fuentes de la interfaz
+#include <allegro5/allegro_image.h> // Guardado de las capturas PNG
+#include "juego.h" // Funciones de dibujo del gameplay
+#include "atlas_fuentes.h" // Las mismas fuentes que usa el juego
+#include "paquete.h" // Fondos y TTF desde el paquete de recursos
+#include "arena.h" // Textos del frame
+#include "opciones.h" // Elementos, frames y carpeta de capturas
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// Pantallas definidas en Proyecto Allegro.cpp
+void renderizarMenu(int opcion, ALLEGRO_FONT* fuente_grande, ALLEGRO_FONT* fuente_mediana, ALLEGRO_FONT* fuente_pequena, int ancho, int alto, float timer, ALLEGRO_BITMAP* fondo);
+void renderizarPantallaHighScores(const PaginaClasificacion& pagina, ALLEGRO_FONT* fuente_grande, ALLEGRO_FONT* fuente_mediana, int ancho, int alto);
+
+// ========== ESCENAS ==========
+
+enum EscenaBenchmark {
+        ESC_VACIA, // Solo el borrado: coste base de cada frame
+        ESC_DRONES, // N drones
+        ESC_SEEKERS, // N seekers orientados hacia el jugador
+        ESC_BALAS, // N balas
+        ESC_HUD, // Puntuacion, ronda y tiempo
+        ESC_MENU, // Menu principal con fondo
+        ESC_HIGH_SCORES, // Pantalla de puntuaciones con un top 5 fijo
+        ESC_PARTIDA, // Fondo, jugador, drones, seekers, balas y HUD juntos
+        NUM_ESCENAS_BENCHMARK // Cantidad de escenas
+};
+
+const char* const NOMBRES_ESCENAS_BENCHMARK[NUM_ESCENAS_BENCHMARK] = {"vacia", "drones", "seekers", "balas", "hud", "menu", "high_scores", "partida"}; // Nombres de la tabla y de las capturas
+
+struct RecursosBenchmark {
+        ALLEGRO_FONT* fuentes[3]; // Grande, mediana y pequena
+        ALLEGRO_BITMAP* fondo_menu; // Fondo del menu (puede faltar)
+        ALLEGRO_BITMAP* fondo_gameplay; // Fondo de la partida (puede faltar)
+        vector<EnemigosTick> enemigos; // Drones [0] y seekers [1] tal como los deja el tick, fuera de la pila
+        vector<BalasTick> balas; // Balas del tick, fuera de la pila
+        Nave jugador; // Nave en el centro, objetivo de los seekers
+        Clasificacion puntuaciones; // Puntuaciones fijas: el resultado no depende de estadisticas.txt
+        PaginaClasificacion pagina; // Primera pagina de la tabla de puntos
+        int drones_n, seekers_n, balas_n; // Elementos realmente colocados (limitados por los pools)
+};
+
+// Reparte los elementos por toda la pantalla de forma fija (secuencia de baja discrepancia)
+void posicionBenchmark(int i, int ancho, int alto, float& x, float& y) {
+        x = (float)fmod((i + 1) * 0.7548776662, 1.0) * ancho; // Coordenada horizontal
+        y = (float)fmod((i + 1) * 0.5698402910, 1.0) * alto; // Coordenada vertical
+}
+
+void prepararEscenasBenchmark(RecursosBenchmark& r, int n, int ancho, int alto) {
+        r.enemigos.resize(2); // Una vista por tipo de enemigo
+        r.balas.resize(1); // Unica vista de balas
+        r.enemigos[0].n = 0; // Sin drones
+        r.enemigos[1].n = 0; // Sin seekers
+        iniciarPersonaje(r.jugador, ancho, alto); // Jugador en el centro
+
+        r.drones_n = min(n, MAX_NAVES_POOL / 2); // La mitad del pool para cada tipo
+        r.seekers_n = r.drones_n; // Mismo numero de seekers
+        r.balas_n = min(n, MAX_BALAS_POOL); // Limitado por el pool de balas
+        for (int i = 0; i < r.drones_n + r.seekers_n; i++) { // Drones y despues seekers
+                int tipo = (i < r.drones_n) ? 1 : 2; // Drone o seeker
+                EnemigosTick& vista = r.enemigos[tipo - 1]; // Vista de su tipo
+                posicionBenchmark(i, ancho, alto, vista.x[vista.n], vista.y[vista.n]); // Posicion fija
+                vista.tipo[vista.n] = tipo; // Tipo, como lo copia la pasada de enemigos
+                vista.n++; // Siguiente ranura
+        }
+
+        vector<PoolBalas> pool(1); // Pool temporal, fuera de la pila
+        iniciarPoolBalas(pool[0]); // Todas las balas libres
+        PtrBala lista_balas = nullptr; // Balas construidas
+        for (int i = 0; i < r.balas_n; i++) { // Balas en todas direcciones
+                Nave origen = r.jugador; // Se disparan desde posiciones repartidas
+                posicionBenchmark(i + 7919, ancho, alto, origen.x, origen.y); // Otra secuencia para no coincidir con los enemigos
+                origen.ang = i * 0.61803398875f * 6.2831853f; // Angulo fijo
+                dispararBala(pool[0], lista_balas, origen); // Misma construccion que en el juego
+        }
+        BalasTick& balas = r.balas[0]; // Vista de balas que dibuja la escena
+        balas.n = 0; // Sin balas todavia
+        for (PtrBala b = lista_balas; b != nullptr; b = b->siguiente) { // Copia como la pasada de balas
+                balas.x[balas.n] = b->x; // Posicion horizontal
+                balas.y[balas.n] = b->y; // Posicion vertical
+                balas.nodo[balas.n] = nullptr; // El pool temporal no sobrevive a la preparacion
+                balas.visible[balas.n] = true; // Ninguna vence en la escena
+                balas.n++; // Siguiente ranura
+        }
+
+        const char* nombres[5] = {"ACE", "NOVA", "VECTOR", "ORBIT", "PIXEL"}; // Top 5 fijo
+        iniciarClasificacion(r.puntuaciones); // Sin entradas previas
+        for (int i = 0; i < 5; i++) { // Cinco puntuaciones decrecientes
+                Estadistica s; // Entrada del top
+                s.nombre = nombres[i]; // Nombre
+                s.puntuacion = 25000 - i * 4000; // Puntos
+                s.tiempo = 600.0f - i * 90.0f; // Segundos
+                s.ronda = 20 - i * 3; // Ronda
+                s.enemigos_eliminados = 250 - i * 40; // Bajas
+                s.proyectiles_disparados = 900 - i * 120; // Disparos
+                agregarAClasificacion(r.puntuaciones, s); // Agrega la entrada
+        }
+        prepararPaginaClasificacion(r.puntuaciones, r.pagina, VISTA_PUNTUACION, 0); // Filas de la tabla
+}
+
+int elementosEscena(const RecursosBenchmark& r, int escena) {
+        if (escena == ESC_DRONES) return r.drones_n; // Drones dibujados
+        if (escena == ESC_SEEKERS) return r.seekers_n; // Seekers dibujados
+        if (escena == ESC_BALAS) return r.balas_n; // Balas dibujadas
+        return 0; // Escenas sin elementos repetidos
+}
+
+void dibujarEscenaBenchmark(RecursosBenchmark& r, int escena, int ancho, int alto) {
+        ALLEGRO_FONT* grande = r.fuentes[0]; // Titulos
+        ALLEGRO_FONT* mediana = r.fuentes[1]; // Textos generales y HUD
+        ALLEGRO_FONT* pequena = r.fuentes[2]; // Instrucciones
+        switch (escena) {
+        case ESC_VACIA:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Solo el borrado
+                break;
+        case ESC_DRONES:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Borrado
+                dibujarVistaEnemigos(r.enemigos[0], r.jugador); // Circulos de los drones
+                break;
+        case ESC_SEEKERS:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Borrado
+                dibujarVistaEnemigos(r.enemigos[1], r.jugador); // Triangulos orientados
+                break;
+        case ESC_BALAS:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Borrado
+                dibujarVistaBalas(r.balas[0]); // Circulos rellenos
+                break;
+        case ESC_HUD:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Borrado
+                dibujarHUD(mediana, 123450, 12, 345.6f); // Tres lineas formateadas en la arena
+                break;
+        case ESC_MENU:
+                renderizarMenu(0, grande, mediana, pequena, ancho, alto, 0.0f, r.fondo_menu); // Menu con la primera opcion marcada
+                break;
+        case ESC_HIGH_SCORES:
+                renderizarPantallaHighScores(r.pagina, grande, mediana, ancho, alto); // Tabla de puntuaciones
+                break;
+        case ESC_PARTIDA:
+                al_clear_to_color(al_map_rgb(0, 0, 0)); // Borrado
+                dibujarFondo(r.fondo_gameplay, ancho, alto); // Fondo escalado
+                dibujarJugador(r.jugador, al_map_rgb(60, 180, 255)); // Nave del jugador 1
+                dibujarVistaEnemigos(r.enemigos[0], r.jugador); // Drones
+                dibujarVistaEnemigos(r.enemigos[1], r.jugador); // Seekers
+                dibujarVistaBalas(r.balas[0]); // Balas
+                dibujarHUD(mediana, 123450, 12, 345.6f); // HUD
+                break;
+        }
+}
+
+// ========== MEDICION ==========
+
+// Dibuja todas las escenas sobre un bitmap en memoria, sin ventana ni GPU, y devuelve el codigo de salida del proceso
+int ejecutarBenchmark() {
+        int ancho = ANCHO_SIN_VENTANA, alto = ALTO_SIN_VENTANA; // Resolucion de referencia
+        int frames = opciones.frames_benchmark > 0 ? opciones.frames_benchmark : 1; // Frames medidos por escena
+
+        al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP); // Todo lo que se cree a partir de aqui vive en memoria
+        ALLEGRO_BITMAP* objetivo = al_create_bitmap(ancho, alto); // Destino de todas las escenas
+        if (!objetivo) { // Sin memoria para el destino
+                printf("No se pudo crear el bitmap de %dx%d\n", ancho, alto); // Informa del error
+                return 1; // Fallo
+        }
+        al_set_target_bitmap(objetivo); // Las funciones de dibujo escriben en memoria
+
+        RecursosBenchmark r; // Fuentes, fondos y entidades de las escenas
+        const int tamanos_fuente[3] = {72, 24, 16}; // Mismos tamanos que el juego
+        cargarFuentesAtlas("MONSTER.ttf", tamanos_fuente, 3, r.fuentes); // Mismo atlas que el juego
+        for (int i = 0; i < 3; i++) { // Recurre al TTF si no hubo atlas
+                if (!r.fuentes[i]) r.fuentes[i] = cargarFuenteRecurso("MONSTER.ttf", tamanos_fuente[i], 0); // Fuente TrueType
+                if (!r.fuentes[i]) r.fuentes[i] = al_create_builtin_font(); // Sin MONSTER.ttf se mide con la fuente interna
+        }
+        r.fondo_menu = cargarBitmapRecurso("Imagenes/menu.png"); // Fondo del menu
+        r.fondo_gameplay = cargarBitmapRecurso("Imagenes/gameplay.png"); // Fondo de la partida
+        prepararEscenasBenchmark(r, opciones.benchmark, ancho, alto); // Entidades en posiciones fijas
+        iniciarArena(arena_frame, CAPACIDAD_ARENA_FRAME); // Textos del HUD y las puntuaciones
+
+        printf("Benchmark de render sin ventana: %dx%d en memoria, %d drones, %d seekers, %d balas, %d frames por escena\n", ancho, alto, r.drones_n, r.seekers_n, r.balas_n, frames); // Configuracion
+        printf("  %-12s %10s %10s %10s %14s\n", "escena", "ms/frame", "p50 ms", "max ms", "us/elemento"); // Cabecera de la tabla
+
+        vector<double> tiempos(frames); // Duracion de cada frame de la escena
+        double ms_vacia = 0.0; // Coste base del borrado, restado al coste por elemento
+        int fallos_captura = 0; // Capturas que no se pudieron guardar
+        for (int escena = 0; escena < NUM_ESCENAS_BENCHMARK; escena++) { // Cada escena
+                dibujarEscenaBenchmark(r, escena, ancho, alto); // Frame de calentamiento (cache de glifos y de memoria)
+                reiniciarArena(arena_frame); // La arena se vacia tras cada frame, como en el juego
+                for (int f = 0; f < frames; f++) { // Frames medidos
+                        double inicio = al_get_time(); // Comienzo del frame
+                        dibujarEscenaBenchmark(r, escena, ancho, alto); // Dibujo sincrono en memoria
+                        tiempos[f] = (al_get_time() - inicio) * 1000.0; // Milisegundos del frame
+                        reiniciarArena(arena_frame); // Fin del frame
+                }
+
+                double suma = 0.0; // Para la media
+                for (int f = 0; f < frames; f++) suma += tiempos[f]; // Acumula
+                double media = suma / frames; // Milisegundos por frame
+                if (escena == ESC_VACIA) ms_vacia = media; // Referencia para las demas
+                vector<double> ordenados(tiempos); // Copia para el percentil
+                sort(ordenados.begin(), ordenados.end()); // Ordena
+                int elementos = elementosEscena(r, escena); // Elementos repetidos de la escena
+                if (elementos > 0) printf("  %-12s %10.3f %10.3f %10.3f %14.2f\n", NOMBRES_ESCENAS_BENCHMARK[escena], media, ordenados[frames / 2], ordenados[frames - 1], (media - ms_vacia) * 1000.0 / elementos); // Coste por elemento sin el borrado
+                else printf("  %-12s %10.3f %10.3f %10.3f %14s\n", NOMBRES_ESCENAS_BENCHMARK[escena], media, ordenados[frames / 2], ordenados[frames - 1], "-"); // Escena sin elementos repetidos
+
+                if (opciones.capturas_benchmark && escena == 0) al_make_directory(opciones.capturas_benchmark); // Crea la carpeta si no existe
+                if (opciones.capturas_benchmark) { // Captura del ultimo frame para comparar visualmente
+                        string ruta = string(opciones.capturas_benchmark) + "/benchmark_" + NOMBRES_ESCENAS_BENCHMARK[escena] + ".png"; // Un PNG por escena
+                        dibujarEscenaBenchmark(r, escena, ancho, alto); // Frame completo fuera de la medicion
+                        reiniciarArena(arena_frame); // Fin del frame
+                        if (!al_save_bitmap(ruta.c_str(), objetivo)) fallos_captura++; // Cuenta los fallos
+                }
+        }
+        if (opciones.capturas_benchmark) printf("Capturas en %s/benchmark_*.png%s\n", opciones.capturas_benchmark, fallos_captura ? " (algunas no se pudieron guardar)" : ""); // Ubicacion de las capturas
+
+        destruirArena(arena_frame); // Libera la arena
+        for (int i = 0; i < 3; i++) al_destroy_font(r.fuentes[i]); // Libera las fuentes
+        if (r.fondo_menu) al_destroy_bitmap(r.fondo_menu); // Libera el fondo del menu
+        if (r.fondo_gameplay) al_destroy_bitmap(r.fondo_gameplay); // Libera el fondo de la partida
+        al_destroy_bitmap(objetivo); // Libera el destino
+        return fallos_captura ? 1 : 0; // Fallo si alguna captura no se guardo
+}
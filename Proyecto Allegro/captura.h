@@ -0,0 +1,316 @@
+/*
+ * CAPTURA.H
+ * ---------
+ * Capturas de pantalla y clips de los ultimos segundos sin cortes en el frame: el hilo
+ * del juego solo copia pixeles a cuadros preasignados y un grupo de hilos codifica los PNG
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <atomic> // Estado de cada cuadro e indices de la cola compartidos entre hilos
+#include <chrono> // Espera de los hilos sin trabajo
+#include <cmath> // ceil para el tamano de los cuadros del clip
+#include <cstdio> // snprintf para las rutas
+#include <cstring> // memcpy de las filas
+#include <ctime> // Marca de tiempo en los nombres
+#include <thread> // Hilos de codificacion
+#include <vector> // Pixeles de cada cuadro (reservados una sola vez)
+#include <allegro5/allegro.h> // Bloqueo de bitmaps y carpetas
+#include <allegro5/allegro_image.h> // al_save_bitmap para los PNG
+#include "memoria.h" // Etiqueta de las asignaciones de los hilos de captura
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const int MAX_CUADROS_CLIP = 256; // Cuadros que puede conservar el clip (segundos * fps)
+const int PANTALLAZOS_CAPTURA = 2; // Capturas completas que pueden esperar a la vez su codificacion
+const int MAX_HILOS_CAPTURA = 8; // Hilos de codificacion como maximo
+const unsigned int CAPACIDAD_TRABAJOS_CAPTURA = 512; // Trabajos pendientes (potencia de dos, mas que cuadros existentes)
+const int LARGO_RUTA_CAPTURA = 128; // Bytes de cada ruta, terminador incluido (solo en los hilos)
+const char* const CARPETA_CAPTURAS = "capturas"; // Carpeta de capturas y clips
+
+enum EstadoCuadro {
+        CUADRO_LIBRE, // Sin contenido util
+        CUADRO_GRABADO, // Contiene un frame y el anillo puede sobrescribirlo
+        CUADRO_GUARDANDO // Un hilo lo esta codificando: el juego no lo toca
+};
+
+// ========== ESTRUCTURAS ==========
+
+// Pixeles de un frame en ABGR_8888_LE, filas contiguas de arriba a abajo
+struct CuadroCaptura {
+        vector<unsigned char> pixeles; // Reservados al iniciar la captura
+        int ancho, alto; // Dimensiones del cuadro
+        double marca; // Instante en que se copio
+        atomic<int> estado; // EstadoCuadro
+};
+
+// Las rutas las arma el hilo que codifica; el trabajo solo lleva lo necesario para nombrar el archivo
+struct TrabajoCaptura {
+        CuadroCaptura* cuadro; // Cuadro a codificar (pasa a CUADRO_LIBRE al terminar)
+        long long fecha; // Segundos desde 1970 en que se pidio
+        int numero; // Numero de captura o de clip en la partida
+        int orden; // Posicion del cuadro dentro del clip
+};
+
+// Un solo productor (el hilo del juego) y varios consumidores que se reparten los trabajos con CAS
+struct ColaTrabajosCaptura {
+        TrabajoCaptura trabajos[CAPACIDAD_TRABAJOS_CAPTURA]; // Almacenamiento circular fijo
+        atomic<unsigned int> escritura; // Proximo trabajo a escribir (solo el juego)
+        atomic<unsigned int> lectura; // Proximo trabajo a tomar (hilos de captura)
+};
+
+struct SistemaCaptura {
+        CuadroCaptura clip[MAX_CUADROS_CLIP]; // Anillo de los ultimos segundos a resolucion reducida
+        CuadroCaptura pantallazos[PANTALLAZOS_CAPTURA]; // Capturas a resolucion completa
+        int num_cuadros; // Cuadros del anillo en uso (0 = sin clip)
+        int siguiente; // Proximo cuadro del anillo a grabar (el mas antiguo)
+        ALLEGRO_BITMAP* reducida; // Textura donde la GPU reduce el backbuffer antes de copiarlo
+        int ancho, alto; // Resolucion del backbuffer
+        double intervalo_clip; // Segundos entre cuadros del clip
+        double ultima_clip; // Instante del ultimo cuadro grabado
+        bool pedir_pantallazo; // Captura completa pendiente para el proximo frame
+        int clips; // Clips pedidos en la partida
+
+        ColaTrabajosCaptura cola; // Trabajos hacia los hilos
+        thread hilos[MAX_HILOS_CAPTURA]; // Hilos de codificacion
+        int num_hilos; // Hilos lanzados
+        atomic<bool> activo; // Mantiene vivos los hilos
+
+        double us_frame; // Coste medio de la captura en el hilo del juego (media movil)
+        double us_maximo; // Peor coste de un frame
+        long cuadros; // Cuadros copiados al anillo
+        long descartados; // Cuadros o capturas perdidos por falta de cuadro o de sitio en la cola
+        long pantallazos_pedidos; // Capturas completas solicitadas
+        atomic<long> guardados; // PNG escritos por los hilos
+        atomic<long> fallos; // PNG que no se pudieron escribir
+};
+
+// ========== COLA DE TRABAJOS ==========
+
+// Nunca bloquea al juego: si la cola esta llena el trabajo se descarta
+bool encolarTrabajoCaptura(ColaTrabajosCaptura& cola, CuadroCaptura* cuadro, long long fecha, int numero, int orden) {
+        unsigned int escritura = cola.escritura.load(memory_order_relaxed); // Solo el juego modifica este indice
+        if (escritura - cola.lectura.load(memory_order_acquire) >= CAPACIDAD_TRABAJOS_CAPTURA) return false; // Cola llena
+        TrabajoCaptura& t = cola.trabajos[escritura & (CAPACIDAD_TRABAJOS_CAPTURA - 1)]; // Ranura libre
+        t.cuadro = cuadro; // Cuadro a codificar
+        t.fecha = fecha; // Momento del pedido
+        t.numero = numero; // Captura o clip
+        t.orden = orden; // Cuadro del clip
+        cola.escritura.store(escritura + 1, memory_order_release); // Publica el trabajo
+        return true; // Trabajo encolado
+}
+
+// La ranura no se reutiliza hasta que avanza 'lectura', asi que la copia es valida si el CAS gana
+bool tomarTrabajoCaptura(ColaTrabajosCaptura& cola, TrabajoCaptura& trabajo) {
+        unsigned int lectura = cola.lectura.load(memory_order_relaxed); // Primer trabajo sin tomar
+        while (lectura != cola.escritura.load(memory_order_acquire)) { // Hay trabajos publicados
+                trabajo = cola.trabajos[lectura & (CAPACIDAD_TRABAJOS_CAPTURA - 1)]; // Copia provisional
+                if (cola.lectura.compare_exchange_weak(lectura, lectura + 1, memory_order_acq_rel)) return true; // Trabajo propio
+        }
+        return false; // Cola vacia
+}
+
+// ========== HILOS DE CODIFICACION ==========
+
+// Copia el cuadro a un bitmap en memoria del hilo (recreado solo si cambia el tamano) y lo guarda
+bool codificarCuadro(const CuadroCaptura& cuadro, ALLEGRO_BITMAP*& bitmap, const char* ruta) {
+        if (!bitmap || al_get_bitmap_width(bitmap) != cuadro.ancho || al_get_bitmap_height(bitmap) != cuadro.alto) { // Primer uso o tamano distinto
+                if (bitmap) al_destroy_bitmap(bitmap); // Descarta el anterior
+                al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP); // Los bitmaps en memoria se pueden usar desde cualquier hilo
+                bitmap = al_create_bitmap(cuadro.ancho, cuadro.alto); // Destino de la codificacion
+                if (!bitmap) return false; // Sin memoria
+        }
+        ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(bitmap, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_WRITEONLY); // Acceso directo a los pixeles
+        if (!region) return false; // No se pudo bloquear
+        int bytes_fila = cuadro.ancho * 4; // Bytes de una fila
+        for (int y = 0; y < cuadro.alto; y++) memcpy((unsigned char*)region->data + y * region->pitch, &cuadro.pixeles[(size_t)y * bytes_fila], bytes_fila); // El paso puede ser negativo
+        al_unlock_bitmap(bitmap); // Fin de la escritura
+        return al_save_bitmap(ruta, bitmap); // Codifica el PNG
+}
+
+void bucleHiloCaptura(SistemaCaptura* c) {
+        ZonaMemoria zona(MEM_CAPTURA); // Todo lo que asigne este hilo se atribuye a la captura
+        ALLEGRO_BITMAP* completo = NULL; // Bitmap de las capturas completas
+        ALLEGRO_BITMAP* reducido = NULL; // Bitmap de los cuadros del clip
+        TrabajoCaptura trabajo; // Trabajo en curso
+        while (true) {
+                if (!tomarTrabajoCaptura(c->cola, trabajo)) { // Nada pendiente
+                        if (!c->activo.load(memory_order_acquire)) break; // Cola vacia y captura detenida
+                        this_thread::sleep_for(chrono::milliseconds(5)); // Espera sin ocupar un nucleo
+                        continue; // Vuelve a mirar la cola
+                }
+                CuadroCaptura* cuadro = trabajo.cuadro; // Cuadro reservado para este trabajo
+                bool es_clip = cuadro >= c->clip && cuadro < c->clip + MAX_CUADROS_CLIP; // Cada tamano usa su propio bitmap
+                char carpeta[LARGO_RUTA_CAPTURA], ruta[LARGO_RUTA_CAPTURA]; // Destino del PNG
+                if (es_clip) { // Un PNG numerado por cuadro dentro de la carpeta del clip
+                        snprintf(carpeta, sizeof(carpeta), "%s/clip_%lld_%d", CARPETA_CAPTURAS, trabajo.fecha, trabajo.numero); // Carpeta del clip
+                        snprintf(ruta, sizeof(ruta), "%s/cuadro_%03d.png", carpeta, trabajo.orden); // Numeracion continua
+                } else {
+                        snprintf(carpeta, sizeof(carpeta), "%s", CARPETA_CAPTURAS); // Todas las capturas juntas
+                        snprintf(ruta, sizeof(ruta), "%s/pantallazo_%lld_%d.png", CARPETA_CAPTURAS, trabajo.fecha, trabajo.numero); // Nombre unico
+                }
+                al_make_directory(carpeta); // Crea la carpeta (y las superiores) si no existe
+                if (codificarCuadro(*cuadro, es_clip ? reducido : completo, ruta)) c->guardados.fetch_add(1, memory_order_relaxed); // PNG escrito
+                else c->fallos.fetch_add(1, memory_order_relaxed); // Disco lleno o sin permisos
+                cuadro->estado.store(CUADRO_LIBRE, memory_order_release); // El juego puede volver a usarlo
+        }
+        if (completo) al_destroy_bitmap(completo); // Libera los bitmaps del hilo
+        if (reducido) al_destroy_bitmap(reducido); // Libera los bitmaps del hilo
+}
+
+// ========== INICIALIZACION ==========
+
+// Reserva todos los cuadros y lanza los hilos. Con segundos = 0 solo hay capturas completas
+void iniciarCaptura(SistemaCaptura& c, int ancho, int alto, float segundos, float fps, float escala, int hilos) {
+        c.ancho = ancho; // Resolucion del backbuffer
+        c.alto = alto; // Alto del backbuffer
+        c.num_cuadros = (int)(segundos * fps); // Cuadros necesarios para el clip
+        if (c.num_cuadros > MAX_CUADROS_CLIP) c.num_cuadros = MAX_CUADROS_CLIP; // Limite del anillo
+        if (c.num_cuadros < 0 || fps <= 0.0f) c.num_cuadros = 0; // Clip desactivado
+        c.siguiente = 0; // El anillo empieza por el primer cuadro
+        c.intervalo_clip = fps > 0.0f ? 1.0 / fps : 0.0; // Segundos entre cuadros
+        c.ultima_clip = 0.0; // El primer frame ya se graba
+        c.pedir_pantallazo = false; // Nada pedido
+        c.clips = 0; // Sin clips
+        c.reducida = NULL; // Sin textura hasta saber si hay clip
+
+        if (escala <= 0.0f || escala > 1.0f) escala = 1.0f; // Escala valida
+        int ancho_clip = (int)ceil(ancho * escala), alto_clip = (int)ceil(alto * escala); // Tamano de los cuadros del clip
+        if (c.num_cuadros > 0) { // La reduccion la hace la GPU: se lee una fraccion de los pixeles
+                int flags = al_get_new_bitmap_flags(); // Conserva la configuracion previa de bitmaps
+                al_set_new_bitmap_flags(ALLEGRO_VIDEO_BITMAP | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR | ALLEGRO_NO_PRESERVE_TEXTURE); // Textura filtrada, su contenido no se necesita conservar
+                c.reducida = al_create_bitmap(ancho_clip, alto_clip); // Se crea una sola vez
+                al_set_new_bitmap_flags(flags); // Restaura la configuracion previa
+                if (!c.reducida) c.num_cuadros = 0; // Sin textura no hay clip
+        }
+        for (int i = 0; i < MAX_CUADROS_CLIP; i++) { // Anillo del clip
+                c.clip[i].ancho = ancho_clip; // Dimensiones reducidas
+                c.clip[i].alto = alto_clip; // Dimensiones reducidas
+                c.clip[i].marca = 0.0; // Sin contenido
+                c.clip[i].estado.store(CUADRO_LIBRE); // Disponible
+                if (i < c.num_cuadros) c.clip[i].pixeles.assign((size_t)ancho_clip * alto_clip * 4, 0); // Unica reserva de cada cuadro
+        }
+        for (int i = 0; i < PANTALLAZOS_CAPTURA; i++) { // Capturas completas
+                c.pantallazos[i].ancho = ancho; // Resolucion nativa
+                c.pantallazos[i].alto = alto; // Resolucion nativa
+                c.pantallazos[i].marca = 0.0; // Sin contenido
+                c.pantallazos[i].estado.store(CUADRO_LIBRE); // Disponible
+                c.pantallazos[i].pixeles.assign((size_t)ancho * alto * 4, 0); // Unica reserva de cada captura
+        }
+
+        c.cola.escritura.store(0); // Cola vacia
+        c.cola.lectura.store(0); // Nada tomado
+        c.us_frame = 0.0; // Sin mediciones
+        c.us_maximo = 0.0; // Sin mediciones
+        c.cuadros = 0; // Sin cuadros
+        c.descartados = 0; // Nada perdido
+        c.pantallazos_pedidos = 0; // Sin capturas
+        c.guardados.store(0); // Sin PNG
+        c.fallos.store(0); // Sin errores
+
+        c.num_hilos = hilos < 1 ? 1 : (hilos > MAX_HILOS_CAPTURA ? MAX_HILOS_CAPTURA : hilos); // Hilos validos
+        c.activo.store(true); // Permite que los hilos trabajen
+        for (int h = 0; h < c.num_hilos; h++) c.hilos[h] = thread(bucleHiloCaptura, &c); // Lanza cada hilo
+}
+
+// Espera a que se escriban los PNG pendientes y libera la textura
+void detenerCaptura(SistemaCaptura& c) {
+        c.activo.store(false, memory_order_release); // Los hilos terminan al vaciar la cola
+        for (int h = 0; h < c.num_hilos; h++) if (c.hilos[h].joinable()) c.hilos[h].join(); // Espera a cada hilo
+        c.num_hilos = 0; // Sin hilos
+        if (c.reducida) al_destroy_bitmap(c.reducida); // Libera la textura
+        c.reducida = NULL; // Evita dobles liberaciones
+}
+
+// ========== CAPTURA EN EL HILO DEL JUEGO ==========
+
+// Lectura del bitmap a un cuadro: un bloqueo de solo lectura y una copia por fila
+bool copiarACuadro(ALLEGRO_BITMAP* origen, CuadroCaptura& cuadro) {
+        ALLEGRO_LOCKED_REGION* region = al_lock_bitmap_region(origen, 0, 0, cuadro.ancho, cuadro.alto, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY); // Trae los pixeles de la GPU
+        if (!region) return false; // No se pudo leer
+        int bytes_fila = cuadro.ancho * 4; // Bytes de una fila
+        for (int y = 0; y < cuadro.alto; y++) memcpy(&cuadro.pixeles[(size_t)y * bytes_fila], (const unsigned char*)region->data + y * region->pitch, bytes_fila); // El paso puede ser negativo
+        al_unlock_bitmap(origen); // Libera el bloqueo
+        return true; // Cuadro copiado
+}
+
+void pedirPantallazo(SistemaCaptura& c) {
+        c.pedir_pantallazo = true; // Se toma antes del proximo flip
+}
+
+// Se llama con el frame ya compuesto y antes de al_flip_display(), cuando el backbuffer aun es valido.
+// Si no hay cuadro libre el frame se pierde: el juego nunca espera a los hilos
+void capturarFrame(SistemaCaptura& c, ALLEGRO_DISPLAY* pantalla, double ahora) {
+        bool clip = c.num_cuadros > 0 && ahora - c.ultima_clip >= c.intervalo_clip; // Toca cuadro del clip
+        if (!clip && !c.pedir_pantallazo) return; // La mayoria de los frames no copian nada
+        double inicio = al_get_time(); // Coste en el hilo del juego
+        ALLEGRO_BITMAP* backbuffer = al_get_backbuffer(pantalla); // Frame compuesto
+
+        if (c.pedir_pantallazo) { // Captura completa
+                c.pedir_pantallazo = false; // Se atiende una sola vez
+                c.pantallazos_pedidos++; // Estadistica
+                CuadroCaptura* libre = NULL; // Cuadro completo disponible
+                for (int i = 0; i < PANTALLAZOS_CAPTURA && !libre; i++) if (c.pantallazos[i].estado.load(memory_order_acquire) == CUADRO_LIBRE) libre = &c.pantallazos[i]; // Primero libre
+                if (libre && copiarACuadro(backbuffer, *libre)) { // Copia a resolucion nativa
+                        libre->marca = ahora; // Momento de la captura
+                        libre->estado.store(CUADRO_GUARDANDO, memory_order_relaxed); // Reservado para el hilo
+                        if (!encolarTrabajoCaptura(c.cola, libre, (long long)time(NULL), (int)c.pantallazos_pedidos, 0)) { // Cola llena
+                                libre->estado.store(CUADRO_LIBRE, memory_order_relaxed); // Se descarta
+                                c.descartados++; // Captura perdida
+                        }
+                } else {
+                        c.descartados++; // Las dos capturas anteriores aun se estan codificando
+                }
+        }
+
+        if (clip) { // Cuadro del anillo
+                c.ultima_clip = ahora; // Proximo cuadro dentro de un intervalo
+                CuadroCaptura& cuadro = c.clip[c.siguiente]; // El mas antiguo del anillo
+                if (cuadro.estado.load(memory_order_acquire) == CUADRO_GUARDANDO) { // Se esta guardando en un clip
+                        c.descartados++; // El anillo espera a que termine
+                } else {
+                        al_set_target_bitmap(c.reducida); // La GPU reduce el frame
+                        al_draw_scaled_bitmap(backbuffer, 0, 0, c.ancho, c.alto, 0, 0, cuadro.ancho, cuadro.alto, 0); // Frame completo al tamano del clip
+                        al_set_target_backbuffer(pantalla); // El flip presenta el backbuffer
+                        if (copiarACuadro(c.reducida, cuadro)) { // Lectura reducida
+                                cuadro.marca = ahora; // Momento del cuadro
+                                cuadro.estado.store(CUADRO_GRABADO, memory_order_relaxed); // Forma parte del clip
+                                c.siguiente = (c.siguiente + 1) % c.num_cuadros; // Avanza el anillo
+                                c.cuadros++; // Estadistica
+                        } else {
+                                c.descartados++; // No se pudo leer la textura
+                        }
+                }
+        }
+
+        double us = (al_get_time() - inicio) * 1000000.0; // Coste de este frame
+        c.us_frame = c.us_frame * 0.95 + us * 0.05; // Media movil
+        if (us > c.us_maximo) c.us_maximo = us; // Peor frame
+}
+
+// Envia a los hilos los cuadros del anillo, del mas antiguo al mas reciente, como una secuencia de PNG.
+// Mientras se guardan el anillo no los sobrescribe. Devuelve los cuadros enviados
+int guardarClipCaptura(SistemaCaptura& c) {
+        if (c.num_cuadros == 0) return 0; // Clip desactivado
+        c.clips++; // Numero de clip
+        long long fecha = (long long)time(NULL); // Comun a todos los cuadros: una carpeta por clip
+        int enviados = 0; // Cuadros enviados
+        for (int i = 0; i < c.num_cuadros; i++) { // Del mas antiguo al mas reciente
+                CuadroCaptura& cuadro = c.clip[(c.siguiente + i) % c.num_cuadros]; // Cuadro del anillo
+                if (cuadro.estado.load(memory_order_acquire) != CUADRO_GRABADO) continue; // Vacio o ya en otro clip
+                cuadro.estado.store(CUADRO_GUARDANDO, memory_order_relaxed); // Reservado para el hilo
+                if (!encolarTrabajoCaptura(c.cola, &cuadro, fecha, c.clips, enviados)) { // Cola llena
+                        cuadro.estado.store(CUADRO_GRABADO, memory_order_relaxed); // Sigue en el anillo
+                        c.descartados++; // Cuadro perdido para este clip
+                        continue; // Intenta el resto
+                }
+                enviados++; // Cuenta el cuadro
+        }
+        return enviados; // Cuadros del clip
+}
+
+int trabajosPendientesCaptura(const SistemaCaptura& c) {
+        return (int)(c.cola.escritura.load(memory_order_relaxed) - c.cola.lectura.load(memory_order_relaxed)); // PNG en espera
+}
@@ -0,0 +1,287 @@
+/*
+ * CLASIFICACION.H
+ * ---------------
+ * Tablas de puntuaciones sobre el historial de partidas: un indice por criterio
+ * (puntuacion, ronda, tiempo, precision y mejor marca de cada jugador) que se
+ * mantiene al agregar cada partida, sin volver a ordenar todo el historial
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <fstream> // Lectura de estadisticas.txt
+#include <map> // Mejor partida de cada nombre
+#include <string> // Nombres de los jugadores
+#include <vector> // Registros y nodos de los indices
+#include "Funciones.h" // Estadistica, interpretarEstadistica y zonas de memoria
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const int FILAS_PAGINA_CLASIFICACION = 5; // Entradas por pagina de la pantalla de puntuaciones
+
+// Cada vista es un indice ordenado de mejor a peor
+enum VistaClasificacion {
+        VISTA_PUNTUACION, // Todas las partidas por puntos
+        VISTA_RONDA, // Todas las partidas por ronda alcanzada
+        VISTA_TIEMPO, // Todas las partidas por tiempo sobrevivido
+        VISTA_PRECISION, // Todas las partidas por enemigos eliminados por disparo
+        VISTA_JUGADORES, // Mejor partida de cada nombre, por puntos
+        NUM_VISTAS_CLASIFICACION // Cantidad de vistas
+};
+
+const char* const TITULOS_VISTAS_CLASIFICACION[NUM_VISTAS_CLASIFICACION] = {"PUNTUACION", "RONDA", "TIEMPO", "PRECISION", "JUGADORES"}; // Titulos de la pantalla
+
+// ========== ESTRUCTURAS ==========
+
+// Nodo de un treap con el tamano de cada subarbol: el orden lo da la clave y la forma la prioridad
+// aleatoria, asi que insertar, borrar, buscar la k-esima posicion y contar las anteriores es O(log n)
+struct NodoClasificacion {
+        int registro; // Partida a la que apunta (indice en Clasificacion::registros)
+        unsigned int prioridad; // Prioridad de monticulo del treap
+        int izq, der; // Hijos (-1 = ninguno)
+        int tamano; // Nodos del subarbol, incluido este
+};
+
+struct IndiceClasificacion {
+        int criterio; // VistaClasificacion que decide el orden (VISTA_JUGADORES ordena por puntos)
+        vector<NodoClasificacion> nodos; // Almacenamiento de los nodos; los enlaces son indices
+        vector<int> libres; // Nodos borrados que se reutilizan
+        int raiz; // Nodo raiz (-1 = vacio)
+};
+
+struct Clasificacion {
+        vector<Estadistica> registros; // Todas las partidas en orden de llegada
+        IndiceClasificacion indices[NUM_VISTAS_CLASIFICACION]; // Un indice por vista
+        map<string, int> mejor_por_nombre; // Registro con la mejor puntuacion de cada nombre
+        unsigned int semilla; // Generador de prioridades
+};
+
+// Filas ya resueltas de una pagina; se calculan al cambiar de vista o de pagina, no en cada frame
+struct PaginaClasificacion {
+        int vista; // VistaClasificacion mostrada
+        int pagina; // Pagina actual (desde 0)
+        int paginas; // Paginas de la vista (al menos 1)
+        int primera_posicion; // Posicion en la tabla de la primera fila (desde 1)
+        vector<Estadistica> filas; // Partidas de la pagina
+};
+
+Clasificacion clasificacion; // Historial de partidas e indices, cargado al arrancar
+
+// ========== CRITERIOS ==========
+
+float precisionEstadistica(const Estadistica& s) {
+        return s.proyectiles_disparados > 0 ? (float)s.enemigos_eliminados / s.proyectiles_disparados : 0.0f; // Bajas por disparo (sin disparos no hay precision)
+}
+
+// Valor que ordena cada criterio; mayor es mejor
+double valorCriterio(const Estadistica& s, int criterio) {
+        switch (criterio) {
+        case VISTA_RONDA: return s.ronda; // Ronda alcanzada
+        case VISTA_TIEMPO: return s.tiempo; // Segundos sobrevividos
+        case VISTA_PRECISION: return precisionEstadistica(s); // Bajas por disparo
+        default: return s.puntuacion; // Puntos (tambien para la vista de jugadores)
+        }
+}
+
+// True si la partida a (registro ia) va por delante de b (registro ib); a igualdad, la mas antigua primero
+bool vaAntes(const Estadistica& a, int ia, const Estadistica& b, int ib, int criterio) {
+        double va = valorCriterio(a, criterio), vb = valorCriterio(b, criterio); // Valores a comparar
+        if (va != vb) return va > vb; // De mayor a menor
+        return ia < ib; // Desempate estable por orden de llegada
+}
+
+// ========== TREAP ==========
+
+int tamanoNodo(const IndiceClasificacion& ind, int nodo) {
+        return nodo < 0 ? 0 : ind.nodos[nodo].tamano; // Un subarbol vacio no tiene nodos
+}
+
+void recalcularNodo(IndiceClasificacion& ind, int nodo) {
+        ind.nodos[nodo].tamano = 1 + tamanoNodo(ind, ind.nodos[nodo].izq) + tamanoNodo(ind, ind.nodos[nodo].der); // Tamano a partir de los hijos
+}
+
+// Parte el arbol en los nodos que van antes de la partida (izq) y el resto (der)
+void partirIndice(const Clasificacion& c, IndiceClasificacion& ind, int nodo, const Estadistica& s, int registro, int& izq, int& der) {
+        if (nodo < 0) { izq = der = -1; return; } // Arbol vacio
+        NodoClasificacion& n = ind.nodos[nodo]; // Nodo actual
+        if (vaAntes(c.registros[n.registro], n.registro, s, registro, ind.criterio)) { // El nodo y su hijo izquierdo van antes
+                partirIndice(c, ind, n.der, s, registro, ind.nodos[nodo].der, der); // Sigue por la derecha
+                izq = nodo; // El nodo encabeza la parte izquierda
+        } else { // El nodo y su hijo derecho van despues
+                partirIndice(c, ind, n.izq, s, registro, izq, ind.nodos[nodo].izq); // Sigue por la izquierda
+                der = nodo; // El nodo encabeza la parte derecha
+        }
+        recalcularNodo(ind, nodo); // Sus hijos pudieron cambiar
+}
+
+// Une dos arboles donde todo 'izq' va antes que todo 'der'
+int unirIndice(IndiceClasificacion& ind, int izq, int der) {
+        if (izq < 0) return der; // Nada a la izquierda
+        if (der < 0) return izq; // Nada a la derecha
+        if (ind.nodos[izq].prioridad > ind.nodos[der].prioridad) { // La raiz izquierda queda arriba
+                ind.nodos[izq].der = unirIndice(ind, ind.nodos[izq].der, der); // Une por su lado derecho
+                recalcularNodo(ind, izq); // Nuevo tamano
+                return izq; // Raiz del resultado
+        }
+        ind.nodos[der].izq = unirIndice(ind, izq, ind.nodos[der].izq); // La raiz derecha queda arriba
+        recalcularNodo(ind, der); // Nuevo tamano
+        return der; // Raiz del resultado
+}
+
+void insertarEnIndice(Clasificacion& c, IndiceClasificacion& ind, int registro) {
+        int nodo; // Nodo para la partida
+        if (!ind.libres.empty()) { // Reutiliza un nodo borrado
+                nodo = ind.libres.back(); // Ultimo liberado
+                ind.libres.pop_back(); // Ya no esta libre
+        } else { // Crece el almacenamiento
+                nodo = (int)ind.nodos.size(); // Siguiente indice
+                ind.nodos.push_back(NodoClasificacion()); // Nodo nuevo
+        }
+        c.semilla = c.semilla * 1103515245u + 12345u; // Generador congruencial, suficiente para equilibrar el arbol
+        NodoClasificacion& n = ind.nodos[nodo]; // Nodo reservado
+        n.registro = registro; // Partida indexada
+        n.prioridad = c.semilla >> 8; // Descarta los bits bajos, los menos aleatorios
+        n.izq = n.der = -1; // Hoja
+        n.tamano = 1; // Solo el mismo
+
+        int izq, der; // Partes del arbol antes y despues de la partida
+        partirIndice(c, ind, ind.raiz, c.registros[registro], registro, izq, der); // Separa por la posicion de la partida
+        ind.raiz = unirIndice(ind, unirIndice(ind, izq, nodo), der); // La engancha en medio
+}
+
+// Separa los primeros 'k' nodos en orden (izq) del resto (der)
+void partirPorPosicion(IndiceClasificacion& ind, int nodo, int k, int& izq, int& der) {
+        if (nodo < 0) { izq = der = -1; return; } // Arbol vacio
+        int tam_izq = tamanoNodo(ind, ind.nodos[nodo].izq); // Nodos antes de este
+        if (k <= tam_izq) { // El corte cae en el subarbol izquierdo
+                partirPorPosicion(ind, ind.nodos[nodo].izq, k, izq, ind.nodos[nodo].izq); // Sigue por la izquierda
+                der = nodo; // El nodo queda a la derecha
+        } else { // El nodo queda a la izquierda
+                partirPorPosicion(ind, ind.nodos[nodo].der, k - tam_izq - 1, ind.nodos[nodo].der, der); // Sigue por la derecha
+                izq = nodo; // El nodo encabeza la parte izquierda
+        }
+        recalcularNodo(ind, nodo); // Sus hijos pudieron cambiar
+}
+
+void borrarDeIndice(Clasificacion& c, IndiceClasificacion& ind, int registro) {
+        int izq, resto, nodo, der; // Antes de la partida, la partida y lo que sigue
+        partirIndice(c, ind, ind.raiz, c.registros[registro], registro, izq, resto); // Todo lo que va antes
+        partirPorPosicion(ind, resto, 1, nodo, der); // El primero del resto es la propia partida
+        if (nodo >= 0) ind.libres.push_back(nodo); // Su nodo se reutilizara
+        ind.raiz = unirIndice(ind, izq, der); // Cierra el hueco
+}
+
+// Registro en la posicion k (desde 0) de la vista, o -1 si no existe
+int registroEnPosicion(const IndiceClasificacion& ind, int k) {
+        int nodo = ind.raiz; // Desciende desde la raiz
+        while (nodo >= 0) { // Hasta encontrar la posicion
+                int tam_izq = tamanoNodo(ind, ind.nodos[nodo].izq); // Nodos antes de este
+                if (k < tam_izq) nodo = ind.nodos[nodo].izq; // Esta a la izquierda
+                else if (k == tam_izq) return ind.nodos[nodo].registro; // Es este
+                else { k -= tam_izq + 1; nodo = ind.nodos[nodo].der; } // Esta a la derecha
+        }
+        return -1; // Fuera de rango
+}
+
+// ========== CONSULTAS ==========
+
+int totalVista(const Clasificacion& c, int vista) {
+        return tamanoNodo(c.indices[vista], c.indices[vista].raiz); // Entradas de la vista
+}
+
+// Posicion (desde 1) que ocuparia la partida en la vista si se agregara ahora, sin agregarla
+int posicionEnVista(const Clasificacion& c, int vista, const Estadistica& s) {
+        const IndiceClasificacion& ind = c.indices[vista]; // Indice consultado
+        int registro = (int)c.registros.size(); // Seria la partida mas reciente
+        int antes = 0; // Entradas que van por delante
+        int nodo = ind.raiz; // Desciende desde la raiz
+        while (nodo >= 0) { // Un camino de la raiz a una hoja
+                const NodoClasificacion& n = ind.nodos[nodo]; // Nodo actual
+                if (vaAntes(c.registros[n.registro], n.registro, s, registro, ind.criterio)) { // El nodo y su izquierda van antes
+                        antes += tamanoNodo(ind, n.izq) + 1; // Los cuenta
+                        nodo = n.der; // Sigue por la derecha
+                } else {
+                        nodo = n.izq; // Sigue por la izquierda
+                }
+        }
+        return antes + 1; // Posicion en la tabla
+}
+
+// Mejor partida registrada con ese nombre, o NULL si no hay ninguna
+const Estadistica* mejorMarca(const Clasificacion& c, const string& nombre) {
+        map<string, int>::const_iterator it = c.mejor_por_nombre.find(nombre); // Busqueda logaritmica
+        return it == c.mejor_por_nombre.end() ? NULL : &c.registros[it->second]; // Registro de la mejor partida
+}
+
+// Copia 'cantidad' entradas de la vista desde la posicion 'desde' (desde 0)
+vector<Estadistica> mejoresDeVista(const Clasificacion& c, int vista, int desde, int cantidad) {
+        vector<Estadistica> filas; // Entradas pedidas
+        for (int k = desde; k < desde + cantidad; k++) { // Cada posicion, O(log n)
+                int registro = registroEnPosicion(c.indices[vista], k); // Partida en esa posicion
+                if (registro < 0) break; // Fin de la vista
+                filas.push_back(c.registros[registro]); // Copia la fila
+        }
+        return filas; // Entradas encontradas
+}
+
+// ========== GESTION ==========
+
+void iniciarClasificacion(Clasificacion& c) {
+        c.registros.clear(); // Sin partidas
+        c.mejor_por_nombre.clear(); // Sin jugadores
+        c.semilla = 2463534242u; // Semilla fija: el equilibrio del arbol no depende de la ejecucion
+        for (int v = 0; v < NUM_VISTAS_CLASIFICACION; v++) { // Cada indice
+                c.indices[v].criterio = (v == VISTA_JUGADORES) ? VISTA_PUNTUACION : v; // Las mejores marcas se ordenan por puntos
+                c.indices[v].nodos.clear(); // Sin nodos
+                c.indices[v].libres.clear(); // Sin nodos libres
+                c.indices[v].raiz = -1; // Arbol vacio
+        }
+}
+
+// Agrega una partida a todos los indices en O(log n) y actualiza la mejor marca de su nombre
+void agregarAClasificacion(Clasificacion& c, const Estadistica& s) {
+        ZonaMemoria zona(MEM_PERSISTENCIA); // Los indices forman parte del historial
+        int registro = (int)c.registros.size(); // Indice de la partida nueva
+        c.registros.push_back(s); // La guarda en orden de llegada
+        for (int v = 0; v < VISTA_JUGADORES; v++) insertarEnIndice(c, c.indices[v], registro); // Vistas de todas las partidas
+
+        map<string, int>::iterator it = c.mejor_por_nombre.find(s.nombre); // Mejor marca previa del nombre
+        if (it == c.mejor_por_nombre.end()) { // Primera partida con ese nombre
+                c.mejor_por_nombre[s.nombre] = registro; // Es su mejor marca
+                insertarEnIndice(c, c.indices[VISTA_JUGADORES], registro); // Entra en la vista de jugadores
+        } else if (vaAntes(s, registro, c.registros[it->second], it->second, VISTA_PUNTUACION)) { // Supera su mejor marca
+                borrarDeIndice(c, c.indices[VISTA_JUGADORES], it->second); // Retira la marca anterior
+                it->second = registro; // Nueva mejor marca
+                insertarEnIndice(c, c.indices[VISTA_JUGADORES], registro); // Y la indexa
+        }
+}
+
+// Lee el historial completo una sola vez; las partidas nuevas se agregan con agregarAClasificacion
+void cargarClasificacion(Clasificacion& c, const char* ruta) {
+        ZonaMemoria zona(MEM_PERSISTENCIA); // Lineas y nodos cuentan como persistencia
+        iniciarClasificacion(c); // Parte de cero
+        ifstream archivo(ruta); // Abre el historial en modo lectura
+        if (!archivo.is_open()) return; // Sin historial todavia
+
+        string linea; // Cada linea del archivo
+        Estadistica stat; // Partida leida
+        while (getline(archivo, linea)) { // Lee el archivo linea a linea
+                if (interpretarEstadistica(linea, stat)) agregarAClasificacion(c, stat); // Ignora las lineas mal formadas
+        }
+}
+
+// Resuelve las filas de una pagina, ajustando la pagina al rango de la vista
+void prepararPaginaClasificacion(const Clasificacion& c, PaginaClasificacion& p, int vista, int pagina) {
+        ZonaMemoria zona(MEM_INTERFAZ); // Las filas copiadas son de la interfaz
+        int total = totalVista(c, vista); // Entradas de la vista
+        p.vista = vista; // Vista mostrada
+        p.paginas = total > 0 ? (total + FILAS_PAGINA_CLASIFICACION - 1) / FILAS_PAGINA_CLASIFICACION : 1; // Al menos una pagina
+        p.pagina = pagina < 0 ? 0 : (pagina >= p.paginas ? p.paginas - 1 : pagina); // Dentro del rango
+        p.primera_posicion = p.pagina * FILAS_PAGINA_CLASIFICACION + 1; // Posicion de la primera fila
+        p.filas = mejoresDeVista(c, vista, p.pagina * FILAS_PAGINA_CLASIFICACION, FILAS_PAGINA_CLASIFICACION); // O(k log n)
+}
+
+vector<Estadistica> obtenerTop5() {
+        return mejoresDeVista(clasificacion, VISTA_PUNTUACION, 0, 5); // Las cinco mejores puntuaciones, sin reordenar el historial
+}
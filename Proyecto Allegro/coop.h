@@ -0,0 +1,244 @@
+/*
+ * COOP.H
+ * ------
+ * Cooperativo para dos instancias sobre UDP en localhost con rollback:
+ * la entrada remota se predice, y cuando llega la real y difiere se
+ * restaura la instantanea de ese tick y se re-simula hasta el presente
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Evita que windows.h defina las macros min y max
+#endif
+#include <winsock2.h> // Sockets UDP de Windows
+#pragma comment(lib, "ws2_32.lib") // Biblioteca de Winsock
+typedef SOCKET SocketCoop; // Descriptor de socket en Windows
+#else
+#include <sys/socket.h> // Sockets POSIX
+#include <netinet/in.h> // sockaddr_in
+#include <arpa/inet.h> // htonl y htons
+#include <fcntl.h> // Socket no bloqueante
+#include <unistd.h> // close
+typedef int SocketCoop; // Descriptor de socket POSIX
+#endif
+
+#include <cstring> // memset y memcpy de los paquetes
+#include <allegro5/allegro.h> // Temporizacion de alta resolucion
+#include "simulacion.h" // Estado de la partida, tick e instantaneas
+
+// ========== CONSTANTES ==========
+
+const int PUERTO_COOP = 47000; // Puerto del jugador 1; el jugador 2 usa el siguiente
+const unsigned int MAGIA_COOP = 0x564F4E31u; // Identifica los paquetes del juego ("VON1")
+const int VENTANA_ROLLBACK = 12; // Ticks maximos que se puede adelantar a la ultima entrada remota confirmada
+const int ANILLO_ENTRADAS = 64; // Entradas de cada jugador que se recuerdan (mayor que la ventana)
+const int ENTRADAS_POR_PAQUETE = 16; // Entradas sin confirmar que viajan en cada paquete (redundancia)
+
+// ========== ESTRUCTURAS ==========
+
+struct PaqueteCoop {
+        unsigned int magia; // MAGIA_COOP
+        unsigned int semilla; // Semilla de la partida (la decide el jugador 1)
+        int primer_tick; // Tick de la primera entrada del paquete
+        int confirmado; // Ultimo tick del emisor confirmado por el receptor (acuse)
+        int cantidad; // Entradas validas en el paquete
+        unsigned char entradas[ENTRADAS_POR_PAQUETE]; // Entradas consecutivas desde primer_tick
+};
+
+struct SesionCoop {
+        SocketCoop socket; // Socket UDP no bloqueante
+        sockaddr_in destino; // Direccion de la otra instancia
+        int local, remoto; // Indice del jugador propio y del otro
+        bool conectado; // Ya se recibio algun paquete de la otra instancia
+        unsigned int semilla; // Semilla acordada de la partida
+
+        unsigned char entradas_locales[ANILLO_ENTRADAS]; // Entrada propia de cada tick
+        unsigned char entradas_remotas[ANILLO_ENTRADAS]; // Entrada remota confirmada de cada tick
+        int tick_remoto[ANILLO_ENTRADAS]; // Tick al que corresponde cada entrada remota (-1 = sin confirmar)
+        unsigned char usadas[ANILLO_ENTRADAS]; // Entrada remota con la que se simulo cada tick (real o predicha)
+        int ultimo_confirmado; // Ultimo tick remoto confirmado sin huecos
+        int acuse_remoto; // Ultimo tick propio que la otra instancia ya recibio
+        int rollback_desde; // Primer tick a re-simular (-1 = no hace falta)
+
+        AnilloInstantaneas instantaneas; // Estados al comienzo de los ultimos ticks
+
+        int rollbacks; // Rollbacks realizados
+        int max_resimulados; // Mayor numero de ticks re-simulados en un solo frame
+        int ticks_esperando; // Ticks detenidos esperando a la otra instancia
+        double ms_rollback; // Coste del ultimo rollback
+        double ms_rollback_max; // Peor coste registrado
+        long paquetes_enviados, paquetes_recibidos; // Trafico
+};
+
+// ========== SOCKETS ==========
+
+void cerrarSocketCoop(SocketCoop s) {
+#ifdef _WIN32
+        closesocket(s); // Cierra el socket de Winsock
+#else
+        close(s); // Cierra el descriptor
+#endif
+}
+
+// Pareja del WSAStartup de abrirSesionCoop: una sola vez por sesion
+void terminarRedCoop() {
+#ifdef _WIN32
+        WSACleanup(); // Libera Winsock
+#endif
+}
+
+bool abrirSesionCoop(SesionCoop& sesion, int jugador) {
+#ifdef _WIN32
+        WSADATA wsa; // Datos de inicializacion de Winsock
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false; // Winsock no disponible
+#endif
+        sesion.local = jugador; // 0 = jugador 1, 1 = jugador 2
+        sesion.remoto = 1 - jugador; // La otra instancia
+        sesion.socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP); // Socket UDP
+#ifdef _WIN32
+        if (sesion.socket == INVALID_SOCKET) { WSACleanup(); return false; } // No se pudo crear
+        u_long no_bloqueante = 1; // Las lecturas nunca deben detener el frame
+        ioctlsocket(sesion.socket, FIONBIO, &no_bloqueante); // Activa el modo no bloqueante
+#else
+        if (sesion.socket < 0) return false; // No se pudo crear
+        fcntl(sesion.socket, F_SETFL, fcntl(sesion.socket, F_GETFL, 0) | O_NONBLOCK); // Activa el modo no bloqueante
+#endif
+
+        sockaddr_in propia; // Direccion en la que escucha esta instancia
+        memset(&propia, 0, sizeof(propia)); // Limpia la estructura
+        propia.sin_family = AF_INET; // IPv4
+        propia.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Solo localhost
+        propia.sin_port = htons((unsigned short)(PUERTO_COOP + jugador)); // Puerto propio
+        if (bind(sesion.socket, (sockaddr*)&propia, sizeof(propia)) != 0) { cerrarSocketCoop(sesion.socket); terminarRedCoop(); return false; } // Puerto ocupado
+
+        memset(&sesion.destino, 0, sizeof(sesion.destino)); // Limpia la direccion remota
+        sesion.destino.sin_family = AF_INET; // IPv4
+        sesion.destino.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // La otra instancia esta en la misma maquina
+        sesion.destino.sin_port = htons((unsigned short)(PUERTO_COOP + sesion.remoto)); // Puerto de la otra instancia
+
+        sesion.conectado = false; // Todavia no se recibio nada
+        sesion.semilla = (jugador == 0) ? (unsigned int)rand() * 32768u + (unsigned int)rand() : 0u; // El jugador 1 decide la semilla
+        for (int i = 0; i < ANILLO_ENTRADAS; i++) { // Vacia los anillos de entradas
+                sesion.entradas_locales[i] = 0; // Sin entrada propia
+                sesion.entradas_remotas[i] = 0; // Sin entrada remota
+                sesion.tick_remoto[i] = -1; // Nada confirmado
+                sesion.usadas[i] = 0; // Nada simulado
+        }
+        sesion.ultimo_confirmado = -1; // Ninguna entrada remota confirmada
+        sesion.acuse_remoto = -1; // La otra instancia no recibio nada todavia
+        sesion.rollback_desde = -1; // No hay nada que corregir
+        iniciarInstantaneas(sesion.instantaneas); // Reserva el anillo de estados
+
+        sesion.rollbacks = 0; // Reinicia las estadisticas
+        sesion.max_resimulados = 0; // Sin re-simulaciones
+        sesion.ticks_esperando = 0; // Sin esperas
+        sesion.ms_rollback = 0.0; // Sin mediciones
+        sesion.ms_rollback_max = 0.0; // Sin peor caso
+        sesion.paquetes_enviados = 0; // Sin trafico
+        sesion.paquetes_recibidos = 0; // Sin trafico
+        return true; // Sesion lista
+}
+
+void cerrarSesionCoop(SesionCoop& sesion) {
+        cerrarSocketCoop(sesion.socket); // Libera el puerto
+        terminarRedCoop(); // Cierra Winsock despues del ultimo socket
+}
+
+// ========== INTERCAMBIO ==========
+
+void enviarEntradasCoop(SesionCoop& sesion, int tick_actual) {
+        PaqueteCoop paquete; // Paquete a enviar
+        memset(&paquete, 0, sizeof(paquete)); // Sin basura en los bytes no usados
+        paquete.magia = MAGIA_COOP; // Identificador del juego
+        paquete.semilla = sesion.semilla; // Semilla de la partida
+        paquete.confirmado = sesion.ultimo_confirmado; // Acuse de las entradas remotas recibidas
+        paquete.primer_tick = sesion.acuse_remoto + 1; // Reenvia todo lo que la otra instancia no confirmo
+        if (paquete.primer_tick < tick_actual - ANILLO_ENTRADAS + 1) paquete.primer_tick = tick_actual - ANILLO_ENTRADAS + 1; // Lo mas antiguo que se recuerda
+        if (paquete.primer_tick < 0) paquete.primer_tick = 0; // La partida empieza en el tick 0
+        paquete.cantidad = tick_actual - paquete.primer_tick; // Entradas ya decididas (hasta el tick anterior al actual)
+        if (paquete.cantidad > ENTRADAS_POR_PAQUETE) paquete.cantidad = ENTRADAS_POR_PAQUETE; // Cabe en un paquete
+        if (paquete.cantidad < 0) paquete.cantidad = 0; // Nada pendiente
+        for (int i = 0; i < paquete.cantidad; i++) paquete.entradas[i] = sesion.entradas_locales[(paquete.primer_tick + i) % ANILLO_ENTRADAS]; // Copia las entradas consecutivas
+
+        sendto(sesion.socket, (const char*)&paquete, sizeof(paquete), 0, (sockaddr*)&sesion.destino, sizeof(sesion.destino)); // Envio sin bloqueo; si se pierde, el siguiente lo repite
+        sesion.paquetes_enviados++; // Cuenta el paquete
+}
+
+void recibirEntradasCoop(SesionCoop& sesion, int tick_actual) {
+        PaqueteCoop paquete; // Paquete recibido
+        while (recvfrom(sesion.socket, (char*)&paquete, sizeof(paquete), 0, NULL, NULL) == (int)sizeof(paquete)) { // Vacia todo lo que haya llegado
+                if (paquete.magia != MAGIA_COOP) continue; // No es de este juego
+                sesion.paquetes_recibidos++; // Cuenta el paquete
+
+                if (!sesion.conectado) { // Primer contacto
+                        sesion.conectado = true; // Ya se puede empezar
+                        if (sesion.local == 1) sesion.semilla = paquete.semilla; // El jugador 2 adopta la semilla del jugador 1
+                }
+                if (paquete.confirmado > sesion.acuse_remoto) sesion.acuse_remoto = paquete.confirmado; // La otra instancia ya tiene hasta este tick
+
+                for (int i = 0; i < paquete.cantidad && i < ENTRADAS_POR_PAQUETE; i++) { // Cada entrada del paquete
+                        int tick = paquete.primer_tick + i; // Tick de la entrada
+                        if (tick <= sesion.ultimo_confirmado) continue; // Ya se tenia
+                        if (tick > sesion.ultimo_confirmado + 1) break; // Hueco: se espera al reenvio para mantener el orden
+                        int ranura = tick % ANILLO_ENTRADAS; // Ranura circular
+                        sesion.entradas_remotas[ranura] = paquete.entradas[i]; // Guarda la entrada real
+                        sesion.tick_remoto[ranura] = tick; // La marca como confirmada
+                        sesion.ultimo_confirmado = tick; // Avanza el tramo confirmado
+
+                        if (tick < tick_actual && sesion.usadas[ranura] != paquete.entradas[i]) { // Se simulo con una prediccion equivocada
+                                if (sesion.rollback_desde < 0 || tick < sesion.rollback_desde) sesion.rollback_desde = tick; // Hay que volver a ese tick
+                        }
+                }
+        }
+}
+
+unsigned char entradaRemotaCoop(const SesionCoop& sesion, int tick) {
+        int ranura = tick % ANILLO_ENTRADAS; // Ranura circular
+        if (sesion.tick_remoto[ranura] == tick) return sesion.entradas_remotas[ranura]; // Entrada real
+        if (sesion.ultimo_confirmado < 0) return 0; // Sin historial se predice "nada pulsado"
+        return sesion.entradas_remotas[sesion.ultimo_confirmado % ANILLO_ENTRADAS]; // Prediccion: se mantiene la ultima entrada conocida
+}
+
+// ========== AVANCE ==========
+
+void simularTickCoop(SesionCoop& sesion, EstadoPartida& e, CampoFlujo& campo, SistemaParticulas* particulas, bool efectos, VistaTick* vista = NULL) {
+        int tick = e.tick; // Tick que se va a simular
+        unsigned char entradas[MAX_JUGADORES]; // Entradas de ambos jugadores
+        entradas[sesion.local] = sesion.entradas_locales[tick % ANILLO_ENTRADAS]; // Propia
+        entradas[sesion.remoto] = entradaRemotaCoop(sesion, tick); // Real o predicha
+        sesion.usadas[tick % ANILLO_ENTRADAS] = entradas[sesion.remoto]; // Para detectar predicciones fallidas
+        guardarInstantanea(sesion.instantaneas, e); // Estado al comienzo del tick
+        simularTick(e, campo, entradas, particulas, efectos, vista); // Avanza la partida
+}
+
+// Aplica la entrada propia del tick actual; devuelve false si hay que esperar a la otra instancia
+bool avanzarCoop(SesionCoop& sesion, EstadoPartida& e, CampoFlujo& campo, unsigned char entrada_local, SistemaParticulas* particulas, VistaTick* vista = NULL) {
+        recibirEntradasCoop(sesion, e.tick); // Entradas remotas llegadas desde el ultimo frame
+
+        if (e.tick - sesion.ultimo_confirmado > VENTANA_ROLLBACK) { // Demasiado adelantado respecto a la otra instancia
+                enviarEntradasCoop(sesion, e.tick); // Sigue reenviando para que la otra pueda avanzar
+                sesion.ticks_esperando++; // Cuenta la espera
+                return false; // No se simula este tick
+        }
+
+        if (sesion.rollback_desde >= 0) { // Alguna prediccion fue incorrecta
+                double inicio = al_get_time(); // Mide el coste completo del rollback
+                int presente = e.tick; // Tick al que hay que volver a llegar
+                if (restaurarInstantanea(sesion.instantaneas, sesion.rollback_desde, e)) { // Vuelve al comienzo del primer tick equivocado
+                        while (e.tick < presente) simularTickCoop(sesion, e, campo, NULL, false); // Re-simula sin sonido ni particulas
+                        int resimulados = presente - sesion.rollback_desde; // Ticks repetidos en este frame
+                        if (resimulados > sesion.max_resimulados) sesion.max_resimulados = resimulados; // Peor caso
+                        sesion.rollbacks++; // Cuenta el rollback
+                }
+                sesion.rollback_desde = -1; // Corregido
+                sesion.ms_rollback = (al_get_time() - inicio) * 1000.0; // Coste en milisegundos
+                if (sesion.ms_rollback > sesion.ms_rollback_max) sesion.ms_rollback_max = sesion.ms_rollback; // Peor caso
+        }
+
+        sesion.entradas_locales[e.tick % ANILLO_ENTRADAS] = entrada_local; // Entrada propia de este tick
+        simularTickCoop(sesion, e, campo, particulas, true, vista); // Tick del presente, con efectos y vista para el dibujo
+        enviarEntradasCoop(sesion, e.tick); // Publica la entrada (incluida la de este tick)
+        return true; // Se avanzo un tick
+}
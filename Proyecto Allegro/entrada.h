@@ -0,0 +1,139 @@
+/*
+ * ENTRADA.H
+ * ---------
+ * Captura de teclado en un hilo dedicado con cola SPSC sin bloqueos
+ * y medicion de la latencia entre la pulsacion y la presentacion
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <atomic> // Indices de la cola compartidos entre hilos sin mutex
+#include <thread> // Hilo dedicado a la captura de entrada
+#include <vector> // Muestras de latencia preasignadas
+#include <algorithm> // nth_element para los percentiles
+#include <allegro5/allegro.h> // Cola de eventos y fuente de teclado de Allegro
+#include "memoria.h" // Etiqueta del hilo para la medicion de asignaciones
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const unsigned int CAPACIDAD_ENTRADA = 256; // Eventos que caben en la cola (potencia de dos)
+const int MAX_MUESTRAS_LATENCIA = 8192; // Muestras de latencia conservadas (las mas recientes)
+
+// ========== ESTRUCTURAS ==========
+
+struct EventoEntrada {
+        int tipo; // ALLEGRO_EVENT_KEY_DOWN o ALLEGRO_EVENT_KEY_UP
+        int tecla; // Codigo de la tecla
+        double marca; // Instante en que Allegro genero el evento (segundos)
+};
+
+struct ColaEntrada {
+        EventoEntrada eventos[CAPACIDAD_ENTRADA]; // Almacenamiento circular fijo
+        atomic<unsigned int> escritura; // Proxima posicion a escribir (solo la modifica el productor)
+        atomic<unsigned int> lectura; // Proxima posicion a leer (solo la modifica el consumidor)
+        atomic<unsigned int> descartados; // Eventos perdidos porque la cola estaba llena
+};
+
+struct HiloEntrada {
+        ColaEntrada cola; // Cola SPSC entre el hilo de entrada y la simulacion
+        ALLEGRO_EVENT_QUEUE* eventos; // Cola de Allegro propia del hilo, solo con el teclado
+        atomic<bool> activo; // Mantiene vivo el bucle del hilo
+        thread hilo; // Hilo de captura
+};
+
+struct MedidorLatencia {
+        vector<float> muestras; // Latencias en milisegundos (anillo)
+        vector<float> orden; // Copia de trabajo para calcular percentiles sin reservar memoria
+        int total; // Muestras registradas desde el inicio
+        double pendientes[CAPACIDAD_ENTRADA]; // Marcas de los eventos consumidos en el tick actual
+        int num_pendientes; // Eventos esperando a que se presente su frame
+};
+
+// ========== COLA SPSC ==========
+
+bool encolarEntrada(ColaEntrada& cola, const EventoEntrada& evento) {
+        unsigned int escritura = cola.escritura.load(memory_order_relaxed); // Solo el productor modifica este indice
+        unsigned int lectura = cola.lectura.load(memory_order_acquire); // Observa cuanto consumio la simulacion
+        if (escritura - lectura >= CAPACIDAD_ENTRADA) { // Cola llena
+                cola.descartados.fetch_add(1, memory_order_relaxed); // Cuenta el evento perdido
+                return false; // No se bloquea nunca al productor
+        }
+        cola.eventos[escritura & (CAPACIDAD_ENTRADA - 1)] = evento; // Copia el evento en su ranura
+        cola.escritura.store(escritura + 1, memory_order_release); // Publica el evento al consumidor
+        return true; // Evento encolado
+}
+
+bool desencolarEntrada(ColaEntrada& cola, EventoEntrada& evento) {
+        unsigned int lectura = cola.lectura.load(memory_order_relaxed); // Solo el consumidor modifica este indice
+        if (lectura == cola.escritura.load(memory_order_acquire)) return false; // Cola vacia
+        evento = cola.eventos[lectura & (CAPACIDAD_ENTRADA - 1)]; // Copia el evento mas antiguo
+        cola.lectura.store(lectura + 1, memory_order_release); // Libera la ranura para el productor
+        return true; // Evento obtenido
+}
+
+// ========== HILO DE ENTRADA ==========
+
+void bucleHiloEntrada(HiloEntrada* entrada) {
+        ZonaMemoria zona(MEM_ENTRADA); // Todo lo que asigne este hilo se atribuye a la entrada
+        while (entrada->activo.load(memory_order_acquire)) { // Hasta que se solicite detener el hilo
+                ALLEGRO_EVENT ev; // Evento recibido del teclado
+                if (!al_wait_for_event_timed(entrada->eventos, &ev, 0.05f)) continue; // Despierta periodicamente para comprobar si debe terminar
+
+                if (ev.type == ALLEGRO_EVENT_KEY_DOWN || ev.type == ALLEGRO_EVENT_KEY_UP) { // Solo interesan pulsaciones y liberaciones
+                        EventoEntrada evento; // Copia compacta del evento
+                        evento.tipo = ev.type; // Tipo de evento
+                        evento.tecla = ev.keyboard.keycode; // Tecla afectada
+                        evento.marca = ev.any.timestamp; // Momento en que se produjo la pulsacion
+                        encolarEntrada(entrada->cola, evento); // Lo entrega a la simulacion sin bloquear
+                }
+        }
+}
+
+void iniciarHiloEntrada(HiloEntrada& entrada) {
+        entrada.cola.escritura.store(0); // Cola vacia
+        entrada.cola.lectura.store(0); // Nada consumido
+        entrada.cola.descartados.store(0); // Sin eventos perdidos
+        entrada.eventos = al_create_event_queue(); // Cola de Allegro exclusiva del hilo
+        al_register_event_source(entrada.eventos, al_get_keyboard_event_source()); // Recibe el teclado directamente
+        entrada.activo.store(true); // Permite que el bucle del hilo se ejecute
+        entrada.hilo = thread(bucleHiloEntrada, &entrada); // Lanza el hilo de captura
+}
+
+void detenerHiloEntrada(HiloEntrada& entrada) {
+        entrada.activo.store(false, memory_order_release); // Pide al hilo que termine
+        if (entrada.hilo.joinable()) entrada.hilo.join(); // Espera a que termine su ultima espera
+        al_destroy_event_queue(entrada.eventos); // Libera la cola propia del hilo
+        entrada.eventos = NULL; // Evita usos posteriores
+}
+
+// ========== MEDICION DE LATENCIA ==========
+
+void iniciarMedidorLatencia(MedidorLatencia& medidor) {
+        medidor.muestras.assign(MAX_MUESTRAS_LATENCIA, 0.0f); // Reserva todas las muestras de una vez
+        medidor.orden.assign(MAX_MUESTRAS_LATENCIA, 0.0f); // Reserva la copia de trabajo
+        medidor.total = 0; // Sin muestras aun
+        medidor.num_pendientes = 0; // Sin eventos esperando presentacion
+}
+
+void registrarEntradaConsumida(MedidorLatencia& medidor, double marca) {
+        if (medidor.num_pendientes < (int)CAPACIDAD_ENTRADA) medidor.pendientes[medidor.num_pendientes++] = marca; // Espera al flip de este frame
+}
+
+void registrarPresentacion(MedidorLatencia& medidor, double instante) {
+        for (int i = 0; i < medidor.num_pendientes; i++) { // Cada evento aplicado en este frame ya es visible
+                medidor.muestras[medidor.total % MAX_MUESTRAS_LATENCIA] = (float)((instante - medidor.pendientes[i]) * 1000.0); // Latencia en milisegundos
+                medidor.total++; // Cuenta la muestra
+        }
+        medidor.num_pendientes = 0; // Todos los pendientes quedaron medidos
+}
+
+float percentilLatencia(MedidorLatencia& medidor, float percentil) {
+        int n = min(medidor.total, MAX_MUESTRAS_LATENCIA); // Muestras validas
+        if (n == 0) return 0.0f; // Sin datos
+        copy(medidor.muestras.begin(), medidor.muestras.begin() + n, medidor.orden.begin()); // Copia sin reservar memoria
+        int k = (int)(percentil * (n - 1)); // Posicion del percentil
+        nth_element(medidor.orden.begin(), medidor.orden.begin() + k, medidor.orden.begin() + n); // Seleccion en tiempo lineal
+        return medidor.orden[k]; // Valor del percentil
+}
@@ -0,0 +1,166 @@
+/*
+ * FLUJO.H
+ * -------
+ * Campo de flujo (flow field) que guia a los seekers hacia el jugador
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cmath> // Raiz cuadrada para normalizar los vectores de cada celda
+#include <vector> // Almacenamiento contiguo de la rejilla
+#include <algorithm> // push_heap/pop_heap para la cola de prioridad de Dijkstra
+#include <functional> // Comparador greater utilizado por el monticulo
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const float TAM_CELDA_FLUJO = 40.0f; // Lado en pixeles de cada celda de la rejilla
+const float DISTANCIA_INFINITA = 1.0e9f; // Marca de celda inalcanzable desde el jugador
+const float COSTO_DIAGONAL = 1.41421356f; // Costo de moverse en diagonal entre celdas
+
+// ========== ESTRUCTURAS ==========
+
+struct CampoFlujo {
+        int columnas, filas; // Dimensiones de la rejilla en celdas
+        float inv_celda; // Inverso del tamano de celda para muestrear sin divisiones
+        int celda_objetivo; // Celda donde estaba el jugador en el ultimo recalculo (-1 si nunca se calculo)
+        int recalculos; // Numero de recalculos completos realizados (diagnostico)
+        vector<float> distancia; // Costo de camino minimo desde cada celda hasta el jugador
+        vector<float> dir_x, dir_y; // Direccion normalizada a seguir en cada celda (0,0 = ir directo)
+        vector<pair<float, int> > monticulo; // Cola de prioridad preasignada (costo, celda)
+};
+
+// ========== INICIALIZACION ==========
+
+void iniciarCampoFlujo(CampoFlujo& campo, int anchoMax, int altoMax) {
+        campo.columnas = (int)ceil(anchoMax / TAM_CELDA_FLUJO); // Columnas necesarias para cubrir el ancho del area de juego
+        campo.filas = (int)ceil(altoMax / TAM_CELDA_FLUJO); // Filas necesarias para cubrir el alto
+        campo.inv_celda = 1.0f / TAM_CELDA_FLUJO; // Precalcula el inverso para el muestreo
+        campo.celda_objetivo = -1; // Obliga a calcular el campo en la primera actualizacion
+        campo.recalculos = 0; // Reinicia el contador de diagnostico
+
+        int total = campo.columnas * campo.filas; // Numero total de celdas
+        campo.distancia.assign(total, DISTANCIA_INFINITA); // Reserva las distancias una sola vez
+        campo.dir_x.assign(total, 0.0f); // Reserva la componente X de las direcciones
+        campo.dir_y.assign(total, 0.0f); // Reserva la componente Y de las direcciones
+        campo.monticulo.clear(); // Vacia la cola de prioridad
+        campo.monticulo.reserve(total * 8); // Capacidad suficiente para no reasignar durante el juego
+}
+
+// ========== CALCULO ==========
+
+float distanciaVecinoFlujo(const CampoFlujo& campo, int c, int f, float propia) {
+        if (c < 0 || f < 0 || c >= campo.columnas || f >= campo.filas) return propia + 1.0f; // Fuera de la arena cuenta como cuesta arriba
+        int i = f * campo.columnas + c; // Indice lineal del vecino
+        if (campo.distancia[i] >= DISTANCIA_INFINITA) return propia + 1.0f; // Una celda sin calcular tambien empuja hacia afuera
+        return campo.distancia[i]; // Distancia real del vecino
+}
+
+void calcularDistanciasFlujo(CampoFlujo& campo, int objetivo) {
+        static const int dc[8] = {1, -1, 0, 0, 1, 1, -1, -1}; // Desplazamientos de columna de los 8 vecinos
+        static const int df[8] = {0, 0, 1, -1, 1, -1, 1, -1}; // Desplazamientos de fila de los 8 vecinos
+
+        fill(campo.distancia.begin(), campo.distancia.end(), DISTANCIA_INFINITA); // Reinicia todas las distancias
+        campo.monticulo.clear(); // Vacia la cola sin liberar su capacidad
+
+        campo.distancia[objetivo] = 0.0f; // El jugador esta a distancia cero de si mismo
+        campo.monticulo.push_back(make_pair(0.0f, objetivo)); // Semilla de Dijkstra
+
+        while (!campo.monticulo.empty()) { // Expande celdas en orden de costo creciente
+                pop_heap(campo.monticulo.begin(), campo.monticulo.end(), greater<pair<float, int> >()); // Lleva la celda mas barata al final
+                pair<float, int> actual = campo.monticulo.back(); // Extrae la celda mas barata
+                campo.monticulo.pop_back(); // La retira de la cola
+
+                if (actual.first > campo.distancia[actual.second]) continue; // Entrada obsoleta de la cola, se ignora
+
+                int c = actual.second % campo.columnas; // Columna de la celda actual
+                int f = actual.second / campo.columnas; // Fila de la celda actual
+
+                for (int k = 0; k < 8; k++) { // Relaja los ocho vecinos
+                        int nc = c + dc[k], nf = f + df[k]; // Coordenadas del vecino
+                        if (nc < 0 || nf < 0 || nc >= campo.columnas || nf >= campo.filas) continue; // Descarta vecinos fuera de la rejilla
+
+                        int vecino = nf * campo.columnas + nc; // Indice lineal del vecino
+                        bool diagonal = (k >= 4); // Los ultimos cuatro desplazamientos son diagonales
+
+                        float costo = actual.first + (diagonal ? COSTO_DIAGONAL : 1.0f); // Costo acumulado hasta el vecino
+                        if (costo < campo.distancia[vecino]) { // Se encontro un camino mas corto
+                                campo.distancia[vecino] = costo; // Actualiza la distancia del vecino
+                                campo.monticulo.push_back(make_pair(costo, vecino)); // Lo encola con su nuevo costo
+                                push_heap(campo.monticulo.begin(), campo.monticulo.end(), greater<pair<float, int> >()); // Restablece la propiedad de monticulo
+                        }
+                }
+        }
+}
+
+void calcularDireccionesFlujo(CampoFlujo& campo) {
+        for (int f = 0; f < campo.filas; f++) { // Recorre cada fila de la rejilla
+                for (int c = 0; c < campo.columnas; c++) { // Recorre cada columna
+                        int i = f * campo.columnas + c; // Indice lineal de la celda
+                        float d = campo.distancia[i]; // Distancia de la celda al jugador
+                        campo.dir_x[i] = 0.0f; // Por defecto el seeker apunta directo al jugador
+                        campo.dir_y[i] = 0.0f; // Vector nulo = persecucion directa
+
+                        if (d >= DISTANCIA_INFINITA || d < 1.5f) continue; // Celdas sin calcular y vecindad del jugador usan persecucion directa
+
+                        float nw = distanciaVecinoFlujo(campo, c - 1, f - 1, d), n = distanciaVecinoFlujo(campo, c, f - 1, d), ne = distanciaVecinoFlujo(campo, c + 1, f - 1, d); // Vecinos superiores
+                        float w = distanciaVecinoFlujo(campo, c - 1, f, d), e = distanciaVecinoFlujo(campo, c + 1, f, d); // Vecinos laterales
+                        float sw = distanciaVecinoFlujo(campo, c - 1, f + 1, d), s = distanciaVecinoFlujo(campo, c, f + 1, d), se = distanciaVecinoFlujo(campo, c + 1, f + 1, d); // Vecinos inferiores
+
+                        float gx = (ne + 2.0f * e + se) - (nw + 2.0f * w + sw); // Gradiente horizontal (operador de Sobel)
+                        float gy = (sw + 2.0f * s + se) - (nw + 2.0f * n + ne); // Gradiente vertical
+                        float largo = sqrt(gx * gx + gy * gy); // Magnitud del gradiente
+
+                        if (largo > 0.0001f) { // Hay pendiente clara: se desciende por ella
+                                float dx = -gx / largo, dy = -gy / largo; // Direccion de descenso normalizada
+                                int sc = c + (int)floor(dx + 0.5f), sf = f + (int)floor(dy + 0.5f); // Celda hacia la que apunta la direccion
+                                if (sc >= 0 && sf >= 0 && sc < campo.columnas && sf < campo.filas) { // Comprueba que no apunte fuera de la arena
+                                        campo.dir_x[i] = dx; // Guarda la direccion suavizada en X
+                                        campo.dir_y[i] = dy; // Guarda la direccion suavizada en Y
+                                        continue; // La celda ya tiene direccion
+                                }
+                        }
+
+                        int mejor_c = c, mejor_f = f; // Respaldo: vecino con menor distancia
+                        float mejor = d; // Distancia del mejor vecino encontrado
+                        for (int vf = f - 1; vf <= f + 1; vf++) { // Recorre la vecindad 3x3
+                                for (int vc = c - 1; vc <= c + 1; vc++) { // Recorre las columnas vecinas
+                                        if (vc < 0 || vf < 0 || vc >= campo.columnas || vf >= campo.filas) continue; // Ignora posiciones fuera de la rejilla
+                                        float dv = campo.distancia[vf * campo.columnas + vc]; // Distancia del vecino
+                                        if (dv < mejor) { mejor = dv; mejor_c = vc; mejor_f = vf; } // Conserva el vecino mas cercano al jugador
+                                }
+                        }
+                        float dx = (float)(mejor_c - c), dy = (float)(mejor_f - f); // Paso hacia el mejor vecino
+                        float paso = sqrt(dx * dx + dy * dy); // Longitud del paso (1 o raiz de 2)
+                        if (paso > 0.0f) { campo.dir_x[i] = dx / paso; campo.dir_y[i] = dy / paso; } // Normaliza el paso
+                }
+        }
+}
+
+void actualizarCampoFlujo(CampoFlujo& campo, float objetivo_x, float objetivo_y) {
+        int c = min(campo.columnas - 1, max(0, (int)(objetivo_x * campo.inv_celda))); // Columna donde se encuentra el jugador
+        int f = min(campo.filas - 1, max(0, (int)(objetivo_y * campo.inv_celda))); // Fila donde se encuentra el jugador
+        int objetivo = f * campo.columnas + c; // Celda objetivo actual
+
+        if (objetivo == campo.celda_objetivo) return; // Si el jugador no cambio de celda el campo sigue siendo valido
+
+        calcularDistanciasFlujo(campo, objetivo); // Recalcula los costos desde el jugador (Dijkstra)
+        calcularDireccionesFlujo(campo); // Convierte los costos en direcciones por celda
+        campo.celda_objetivo = objetivo; // Recuerda para que celda se calculo
+        campo.recalculos++; // Registra el recalculo
+}
+
+// ========== MUESTREO ==========
+
+bool muestrearCampoFlujo(const CampoFlujo& campo, float x, float y, float& dir_x, float& dir_y) {
+        if (campo.celda_objetivo < 0) return false; // Sin campo calculado el llamador persigue en linea recta
+
+        int c = min(campo.columnas - 1, max(0, (int)(x * campo.inv_celda))); // Columna de la posicion consultada
+        int f = min(campo.filas - 1, max(0, (int)(y * campo.inv_celda))); // Fila de la posicion consultada
+        int i = f * campo.columnas + c; // Indice lineal de la celda
+
+        dir_x = campo.dir_x[i]; // Direccion precalculada en X
+        dir_y = campo.dir_y[i]; // Direccion precalculada en Y
+        return dir_x != 0.0f || dir_y != 0.0f; // Un vector nulo indica que hay que perseguir directamente
+}
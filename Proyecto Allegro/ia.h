@@ -0,0 +1,146 @@
+/*
+ * IA.H
+ * ----
+ * Planificador de las decisiones de los enemigos: un cupo fijo de decisiones por tick que se
+ * reparten los seekers cercanos al jugador y un turno que recorre el pool de naves por indice,
+ * de modo que el coste de la IA no crece con el tamano de la oleada
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cstring> // memset para las marcas de cercanos
+
+#include "Funciones.h" // Naves y decision de cada seeker
+#include "flujo.h" // Campo de flujo que consultan las decisiones
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const float RADIO_PRIORIDAD_IA = 320.0f; // Seekers a menos de esta distancia del objetivo deciden en cada tick
+const int CUPO_IA_MIN = 8; // Cupo minimo al que puede bajar el ajuste por presupuesto
+const int CUPO_IA_MAX = MAX_NAVES_POOL; // Con este cupo todos los seekers deciden en cada tick
+const int MAX_CERCANOS_IA = 64; // Seekers cercanos que se siguen a la vez (como mucho la mitad del cupo)
+const int RECORRIDO_IA_POR_DECISION = 4; // Nodos del pool que el turno puede mirar por cada decision del cupo
+
+// ========== ESTRUCTURAS ==========
+
+// Parte del estado de la partida: viaja en las instantaneas y la re-simulacion decide lo mismo
+struct PlanIA {
+        int cupo; // Decisiones por tick, cercanos incluidos
+        int cursor; // Indice del pool por el que sigue el turno en el proximo tick
+        int cercanos[MAX_CERCANOS_IA]; // Indices del pool de los seekers cercanos
+        int n_cercanos; // Cercanos que se siguen
+        unsigned char es_cercano[MAX_NAVES_POOL]; // Marca de los indices que estan en cercanos
+        int ticks_en_vuelta; // Ticks que lleva la vuelta actual del turno
+        int ticks_vuelta; // Ticks que tardo la ultima vuelta completa al pool
+        int decisiones_tick; // Decisiones del ultimo tick (cercanos incluidos)
+        long decisiones; // Decisiones desde el inicio de la partida
+};
+
+// Medicion fuera del estado: depende del reloj y no debe influir en la re-simulacion
+struct PresupuestoIA {
+        double presupuesto_us; // Microsegundos por tick disponibles para las decisiones
+        bool adaptable; // El cupo se ajusta al tiempo medido (solo en solitario)
+        double us_tick; // Coste del ultimo tick
+        double us_media; // Media movil del coste
+        double us_maximo; // Peor tick
+        long ticks; // Ticks medidos
+        long excesos; // Ticks que superaron el presupuesto
+};
+
+// ========== PLANIFICACION ==========
+
+void iniciarPlanIA(PlanIA& plan, int cupo) {
+        plan.cupo = cupo < CUPO_IA_MIN ? CUPO_IA_MIN : cupo; // Cupo inicial
+        plan.cursor = 0; // El turno empieza por el primer nodo
+        plan.n_cercanos = 0; // Sin cercanos todavia
+        memset(plan.es_cercano, 0, sizeof(plan.es_cercano)); // Ningun indice marcado
+        plan.ticks_en_vuelta = 0; // Vuelta recien empezada
+        plan.ticks_vuelta = 0; // Sin vueltas completas
+        plan.decisiones_tick = 0; // Sin decisiones
+        plan.decisiones = 0; // Sin historial
+}
+
+// Cerca del objetivo: decide en cada tick mientras quede sitio entre los cercanos
+bool seekerCercano(const Nave& s, const Nave& objetivo) {
+        float dx = objetivo.x - s.x, dy = objetivo.y - s.y; // Vector hacia el objetivo
+        return dx * dx + dy * dy < RADIO_PRIORIDAD_IA * RADIO_PRIORIDAD_IA; // Dentro del radio de prioridad
+}
+
+// Decide la direccion de los seekers que les toca en este tick, sin pasar de 'cupo' decisiones ni de
+// 'cupo' * RECORRIDO_IA_POR_DECISION nodos mirados. Primero los cercanos ya conocidos (hasta la mitad
+// del cupo); el resto del cupo es del turno, que sigue por el pool desde donde quedo y apunta como
+// cercanos a los que encuentra dentro del radio. Devuelve las decisiones tomadas
+int planificarDecisiones(PlanIA& plan, PoolNaves& pool, const Nave& objetivo, const CampoFlujo& campo) {
+        int limite_cercanos = min(MAX_CERCANOS_IA, plan.cupo / 2); // Parte del cupo reservada a los cercanos
+        int decisiones = 0; // Decisiones del tick
+
+        int n = 0; // Cercanos que siguen siendolo
+        for (int k = 0; k < plan.n_cercanos; k++) { // Cercanos del tick anterior
+                int i = plan.cercanos[k]; // Indice en el pool
+                Nave& s = pool.nodos[i]; // El nodo pudo morir o reutilizarse: se comprueba de nuevo
+                if (n < limite_cercanos && s.activo && s.tipo == 2 && seekerCercano(s, objetivo)) { // Sigue cerca y cabe
+                        decidirSeeker(s, objetivo, campo); // Nueva direccion
+                        decisiones++; // Cuenta contra el cupo
+                        plan.cercanos[n++] = i; // Se queda
+                } else plan.es_cercano[i] = 0; // Vuelve al turno
+        }
+        plan.n_cercanos = n; // Cercanos compactados
+
+        int recorrido = min(MAX_NAVES_POOL, plan.cupo * RECORRIDO_IA_POR_DECISION); // Nodos que el turno puede mirar
+        int i = plan.cursor; // Sigue donde quedo el turno
+        bool vuelta = false; // El turno paso por el final del pool
+        for (int paso = 0; paso < recorrido && decisiones < plan.cupo; paso++) { // Hasta agotar el cupo o el recorrido
+                Nave& s = pool.nodos[i]; // Nodo del turno
+                if (s.activo && s.tipo == 2 && !plan.es_cercano[i]) { // Los drones no deciden y los cercanos ya decidieron
+                        decidirSeeker(s, objetivo, campo); // Nueva direccion
+                        decisiones++; // Cuenta contra el cupo
+                        if (plan.n_cercanos < limite_cercanos && seekerCercano(s, objetivo)) { // Entra en los cercanos
+                                plan.cercanos[plan.n_cercanos++] = i; // Decide en cada tick desde el proximo
+                                plan.es_cercano[i] = 1; // El turno lo salta
+                        }
+                }
+                if (++i == MAX_NAVES_POOL) { // Fin del pool
+                        i = 0; // Da la vuelta
+                        vuelta = true; // Vuelta completa
+                }
+        }
+        plan.cursor = i; // Proximo nodo del turno
+
+        plan.ticks_en_vuelta++; // Cuenta el tick en la vuelta actual
+        if (vuelta) { // Se cerro una vuelta
+                plan.ticks_vuelta = plan.ticks_en_vuelta; // Cada seeker lejano decide al menos cada tantos ticks
+                plan.ticks_en_vuelta = 0; // Empieza la siguiente
+        }
+        plan.decisiones_tick = decisiones; // Estadistica del tick
+        plan.decisiones += decisiones; // Total de la partida
+        return decisiones; // Decisiones tomadas
+}
+
+// ========== PRESUPUESTO ==========
+
+void iniciarPresupuestoIA(PresupuestoIA& p, double presupuesto_us, bool adaptable) {
+        p.presupuesto_us = presupuesto_us; // Limite por tick
+        p.adaptable = adaptable; // En cooperativo el cupo no puede cambiar en una sola instancia
+        p.us_tick = 0.0; // Sin mediciones
+        p.us_media = 0.0; // Sin mediciones
+        p.us_maximo = 0.0; // Sin mediciones
+        p.ticks = 0; // Sin ticks
+        p.excesos = 0; // Sin excesos
+}
+
+// Registra el coste de las decisiones del tick. Si supera el presupuesto cuenta el exceso y, si es
+// adaptable, baja el cupo un cuarto; con holgura de sobra y vueltas de mas de un tick lo sube de a uno
+void ajustarPresupuestoIA(PresupuestoIA& p, PlanIA& plan, double us) {
+        p.us_tick = us; // Ultimo tick
+        p.us_media = p.ticks == 0 ? us : p.us_media * 0.95 + us * 0.05; // Media movil
+        if (us > p.us_maximo) p.us_maximo = us; // Peor tick
+        p.ticks++; // Cuenta el tick
+        if (us > p.presupuesto_us) { // Presupuesto superado
+                p.excesos++; // Se informa en el panel y al terminar
+                if (p.adaptable) plan.cupo = max(CUPO_IA_MIN, plan.cupo * 3 / 4); // Menos decisiones por tick
+        } else if (p.adaptable && us < p.presupuesto_us * 0.5 && plan.cupo < CUPO_IA_MAX && plan.ticks_vuelta > 1) { // Holgura y seekers esperando turno
+                plan.cupo++; // Prueba con una decision mas
+        }
+}
@@ -9,19 +9,25 @@
 #include <allegro5/allegro.h> // Tipos basicos y funciones generales de Allegro
 #include <allegro5/allegro_font.h> // Soporte para dibujar texto en pantalla
 #include <allegro5/allegro_primitives.h> // Permite dibujar primitivas geometricas
+#include <allegro5/allegro_native_dialog.h> // Aviso si no se puede abrir el modo cooperativo
 #include <cmath> // Utiliza funciones matematicas como seno, coseno y raiz cuadrada
+#include <cstdio> // printf para los informes por consola
 #include "Funciones.h" // Acceso a estructuras, constantes y utilidades compartidas
+#include "simulacion.h" // Estado copiable de la partida y tick de simulacion
+#include "coop.h" // Cooperativo con rollback sobre UDP local
+#include "entrada.h" // Hilo de captura de teclado y medicion de latencia
+#include "opciones.h" // Opciones de linea de comandos
+#include "resolucion.h" // Escalado dinamico de la resolucion de la escena
+#include "planificador.h" // Redibujado bajo demanda y suspension sin foco
+#include "memoria.h" // Asignaciones por frame y por subsistema
+#include "arena.h" // Textos temporales del frame sin memoria dinamica
+#include "telemetria.h" // Registro por tick y volcado al terminar la partida
+#include "clasificacion.h" // Top 5, posicion de la partida y mejor marca por nombre
+#include "metricas.h" // Publicacion de las metricas en vivo
+#include "captura.h" // Capturas y clips codificados fuera del hilo del juego
 
 using namespace std; // Evita el uso de std:: en cada referencia a tipos estandar
 
-// ========== CONSTANTES DE FISICA ==========
-
-const float FPS = 60.0f; // Frecuencia objetivo en fotogramas por segundo
-const float ROTACION = 0.07f; // Variacion angular aplicada por frame al rotar la nave
-const float ACELERACION = 0.35f; // Magnitud de aceleracion aplicada al impulsar la nave
-const float ROZAMIENTO = 0.985f; // Factor de amortiguamiento aplicado cada frame para frenar
-const float VELOCIDAD_MAX = 9.0f; // Velocidad maxima permitida para el jugador
-
 // ========== GEOMETRIA ==========
 
 static float Puntos_jugador[] = {
@@ -37,276 +43,371 @@ static float v[] = {
         35.0f, 27.0f // Vertice inferior derecho del triangulo
 };
 
+// ========== RENDERIZADO ==========
+
+void dibujarFondo(ALLEGRO_BITMAP* fondo, int ancho, int alto) {
+        if (fondo) {
+                al_draw_scaled_bitmap(fondo, 0, 0, al_get_bitmap_width(fondo), al_get_bitmap_height(fondo), 0, 0, ancho, alto, 0); // Dibuja el fondo del gameplay ajustado al area de juego
+        }
+}
+
+void dibujarJugador(const Nave& player, ALLEGRO_COLOR color) {
+        ALLEGRO_TRANSFORM guardado, t; // Transformaciones para posicionar la nave
+        al_copy_transform(&guardado, al_get_current_transform()); // Guarda la transformacion actual
+        al_identity_transform(&t); // Inicializa una transformacion identidad
+        al_rotate_transform(&t, player.ang); // Aplica la rotacion de la nave
+        al_translate_transform(&t, player.x, player.y); // Traslada la transformacion a la posicion del jugador
+        al_compose_transform(&t, &guardado); // Respeta la escala de la escena si la hay
+        al_use_transform(&t); // Activa la transformacion combinada
+
+        al_draw_filled_polygon(Puntos_jugador, 4, color); // Dibuja el cuerpo de la nave del jugador
+        al_draw_polygon(Puntos_jugador, 4, ALLEGRO_LINE_JOIN_ROUND, al_map_rgb(255, 255, 255), 1.5f, 1.0f); // Dibuja el contorno de la nave
+
+        al_use_transform(&guardado); // Restaura la transformacion previa para no afectar dibujos posteriores
+}
+
+void dibujarDrone(float x, float y) {
+        al_draw_circle(x, y, 50.0f, al_map_rgb(170, 255, 170), 2); // Dibuja el contorno exterior del drone
+        al_draw_circle(x, y, 45.0f, al_map_rgb(170, 255, 170), 3); // Dibuja un segundo circulo para efecto visual
+}
+
+void dibujarSeeker(float x, float y, const Nave& player) {
+        ALLEGRO_TRANSFORM old, Ts; // Transformaciones para orientar el seeker
+        al_copy_transform(&old, al_get_current_transform()); // Guarda la transformacion actual
+        al_identity_transform(&Ts); // Reinicia una transformacion identidad
+
+        float ang = atan2f(player.y - y, player.x - x) + 3.14159f / 2.0f; // Calcula el angulo hacia el jugador
+        al_rotate_transform(&Ts, ang); // Rota el triangulo del seeker para que apunte al jugador
+        al_translate_transform(&Ts, x, y); // Posiciona el triangulo en la ubicacion del enemigo
+        al_compose_transform(&Ts, &old); // Respeta la escala de la escena si la hay
+        al_use_transform(&Ts); // Aplica la transformacion temporal
+
+        al_draw_triangle(v[0], v[1], v[2], v[3], v[4], v[5], al_map_rgb(255, 100, 220), 6); // Dibuja el contorno grueso del seeker
+        al_draw_triangle(v[0], v[1], v[2], v[3], v[4], v[5], al_map_rgb(255, 255, 255), 3); // Dibuja un contorno adicional blanco
+        al_draw_triangle(v[0], v[1] + 20, v[2] + 15, v[3] - 10, v[4] - 15, v[5] - 10, al_map_rgb(255, 100, 220), 3); // Dibuja una franja interior
+        al_draw_triangle(v[0], v[1] + 20, v[2] + 15, v[3] - 10, v[4] - 15, v[5] - 10, al_map_rgb(255, 255, 255), 1); // Dibuja el borde de la franja interior
+
+        al_use_transform(&old); // Restaura la transformacion previa
+}
+
+void dibujarEnemigos(PtrNave enemigos, const Nave& player) {
+        PtrNave e = enemigos; // Inicia el recorrido para dibujar cada enemigo
+        while (e != NULL) {
+                if (e->activo) {
+                        if (e->tipo == 1) dibujarDrone(e->x, e->y); // Circulos verdes
+                        else if (e->tipo == 2) dibujarSeeker(e->x, e->y, player); // Triangulo orientado al jugador
+                }
+                e = e->siguiente; // Avanza al siguiente enemigo en la lista
+        }
+}
+
+void dibujarBalas(PtrBala balas) {
+        PtrBala b = balas; // Recorre la lista de balas activas
+        while (b != NULL) {
+                if (b->activa) {
+                        al_draw_filled_circle(b->x, b->y, 5.0f, al_map_rgb(255, 255, 0)); // Dibuja la bala como un circulo amarillo
+                }
+                b = b->siguiente; // Continua con la siguiente bala
+        }
+}
+
+// Dibuja drones y seekers desde la vista del tick, sin recorrer la lista de enemigos
+void dibujarVistaEnemigos(const EnemigosTick& vista, const Nave& player) {
+        for (int i = 0; i < vista.n; i++) { // Supervivientes del tick
+                if (vista.tipo[i] == 1) dibujarDrone(vista.x[i], vista.y[i]); // Posicion final del tick
+                else if (vista.tipo[i] == 2) dibujarSeeker(vista.x[i], vista.y[i], player); // Apunta al jugador
+        }
+}
+
+void dibujarVistaBalas(const BalasTick& vista) {
+        for (int i = 0; i < vista.n; i++) { // Balas del tick
+                if (vista.visible[i]) al_draw_filled_circle(vista.x[i], vista.y[i], 5.0f, al_map_rgb(255, 255, 0)); // Las retiradas al cerrar el tick no se dibujan
+        }
+}
+
+ALLEGRO_COLOR colorPodio(size_t posicion) {
+        if (posicion == 0) return al_map_rgb(255, 215, 0); // Oro para el primer lugar
+        if (posicion == 1) return al_map_rgb(192, 192, 192); // Plata para el segundo lugar
+        if (posicion == 2) return al_map_rgb(205, 127, 50); // Bronce para el tercer lugar
+        return al_map_rgb(200, 200, 200); // Gris para el resto de posiciones
+}
+
+void dibujarHUD(ALLEGRO_FONT* font, int puntos, int ronda, float tiempo) {
+        dibujarTextoArena(font, al_map_rgb(255, 255, 255), 10, 10, ALLEGRO_ALIGN_LEFT, "PUNTUACION: %d", puntos); // Muestra la puntuacion actual
+        dibujarTextoArena(font, al_map_rgb(255, 255, 255), 10, 35, ALLEGRO_ALIGN_LEFT, "RONDA: %d", ronda); // Muestra la ronda activa
+        dibujarTextoArena(font, al_map_rgb(255, 255, 255), 10, 60, ALLEGRO_ALIGN_LEFT, "TIEMPO: %.1f", tiempo); // Muestra el tiempo de juego
+}
+
 // ========== FUNCION PRINCIPAL DEL JUEGO ==========
 
 void iniciarJuego(int ancho, int alto, ALLEGRO_FONT* font, ALLEGRO_TIMER* timer, ALLEGRO_EVENT_QUEUE* queue, ALLEGRO_BITMAP* fondo_gameplay) {
         tocarMusica(musica_gameplay, 0.05f); // Inicia la musica de fondo del gameplay con volumen bajo
 
-        EstadoJuego estado = JUGANDO; // Estado inicial de la partida
-        float timer_trans = 0.0f; // Tiempo restante de la pantalla de transicion entre rondas
-        Nave player; // Instancia que representa al jugador
-        PtrNave enemigos = NULL; // Lista enlazada de enemigos activos en la partida
-        PtrBala balas = NULL; // Lista enlazada de proyectiles disparados
-        float cooldown = 0.0f; // Temporizador entre disparos consecutivos
-        int ronda = 1; // Numero de ronda actual
-        int puntos = 0; // Puntuacion acumulada durante la partida
-        int kills = 0; // Conteo de enemigos eliminados
-        int proyectiles = 0; // Numero de proyectiles disparados por el jugador
-        float tiempo = 0.0f; // Tiempo transcurrido mientras el estado es JUGANDO
-        float tiempo_total = 0.0f; // Tiempo total transcurrido incluyendo pantallas auxiliares
-        float delay_muerte = 0.0f; // Temporizador entre la muerte y la pantalla de game over
+        bool coop = opciones.coop >= 0; // Partida cooperativa entre dos instancias
+        SesionCoop sesion; // Conexion con la otra instancia (solo en cooperativo)
+        if (coop && !abrirSesionCoop(sesion, opciones.coop)) { // No se pudo abrir el puerto
+                al_show_native_message_box(al_get_current_display(), "Error", "Error", "No se pudo abrir el puerto del modo cooperativo", NULL, 0); // Informa al usuario
+                return; // Vuelve al menu
+        }
+
+        EstadoPartida partida; // Estado completo y copiable de la partida
+        iniciarEstadoPartida(partida, ancho, alto, coop ? 2 : 1, coop ? sesion.semilla : (unsigned int)rand()); // Primera oleada generada con la semilla de la partida
+        if (!coop && opciones.cupo_ia > 0) partida.ia.cupo = opciones.cupo_ia; // En cooperativo ambas instancias usan el cupo del juego
+        AnilloInstantaneas instantaneas; // Ultimos ticks guardados en solitario (en cooperativo los guarda la sesion)
+        if (!coop) iniciarInstantaneas(instantaneas); // Reserva el anillo una sola vez
+        int jugador_local = coop ? opciones.coop : 0; // Nave controlada desde este teclado
+
+        // Alias usados por la interfaz; siguen siendo validos tras restaurar instantaneas sobre el mismo objeto
+        EstadoJuego& estado = partida.estado; // Estado actual de la partida
+        int& ronda = partida.ronda; // Numero de ronda actual
+        int& puntos = partida.puntos; // Puntuacion acumulada durante la partida
+        int& kills = partida.kills; // Conteo de enemigos eliminados
+        int& proyectiles = partida.proyectiles; // Numero de proyectiles disparados
+        float& tiempo = partida.tiempo; // Tiempo transcurrido mientras el estado es JUGANDO
+        float& tiempo_total = partida.tiempo_total; // Tiempo total transcurrido incluyendo pantallas auxiliares
+
+        CampoFlujo campo; // Rejilla de direcciones compartida por todos los seekers (cache derivada de la posicion del objetivo)
+        SistemaParticulas particulas; // Explosiones y estela del propulsor
+        VistaTick vista; // Enemigos y balas del ultimo tick, listos para el dibujo
+        bool depuracion = false; // Muestra el panel de diagnostico (F3)
+        bool esperando = coop; // En cooperativo se espera a la otra instancia antes de empezar
+        bool ingresando_nombre = false; // Pantalla de captura de nombre: vive fuera de EstadoPartida para que un rollback no la deshaga
         string nombre = ""; // Buffer de texto para el nombre del jugador
+        vector<Estadistica> top5; // Top 5 leido al llegar a la captura de nombre
+        int posicion_partida = 0; // Puesto de esta partida en la tabla de puntos
         bool W = false, D = false, A = false, SPACE = false; // Estados de las teclas principales del control
 
-        iniciarPersonaje(player, ancho, alto); // Coloca al jugador en el centro de la pantalla y reinicia sus atributos
-        generarOleada(enemigos, ronda, ancho, alto); // Crea la primera oleada de enemigos de acuerdo a la ronda inicial
+        iniciarCampoFlujo(campo, ancho, alto); // Reserva la rejilla del campo de flujo para el area de juego
+        iniciarParticulas(particulas); // Reserva de una vez todo el almacenamiento de particulas
+        iniciarVistaTick(vista); // Sin tick dibujable todavia
+        PresupuestoIA presupuesto_ia; // Coste de las decisiones de los seekers
+        iniciarPresupuestoIA(presupuesto_ia, opciones.presupuesto_ia, !coop); // En cooperativo el cupo no cambia: las dos instancias deben decidir lo mismo
 
-        bool jugando = true; // Controla la permanencia en el bucle principal del gameplay
-        while (jugando) { // Bucle que se mantiene hasta que se abandona el gameplay
-                ALLEGRO_EVENT ev; // Almacena el evento recibido desde la cola
-                al_wait_for_event(queue, &ev); // Espera de manera bloqueante un nuevo evento
+        HiloEntrada hilo_entrada; // Hilo que captura el teclado durante la partida
+        MedidorLatencia latencia; // Latencia entre pulsacion y presentacion (--latencia)
+        if (opciones.medir_latencia) iniciarMedidorLatencia(latencia); // Reserva las muestras solo si se va a medir
+        al_unregister_event_source(queue, al_get_keyboard_event_source()); // El teclado deja de pasar por la cola principal
+        iniciarHiloEntrada(hilo_entrada); // Y pasa a capturarse en su propio hilo
 
-                if (ev.type == ALLEGRO_EVENT_KEY_DOWN) { // Gestiona pulsaciones de teclado
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_ESCAPE) { // Escape durante el gameplay
-                                jugando = false; // Rompe el bucle y retorna al menu
-                        }
+        ALLEGRO_DISPLAY* pantalla = al_get_current_display(); // Pantalla sobre la que se compone cada frame
+        EscaladoDinamico escalado; // Resolucion adaptable de la escena del mundo
+        iniciarEscalado(escalado, ancho, alto, opciones.escala_min, opciones.escala_max, FPS); // Crea el bitmap intermedio una unica vez
 
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_W && estado == JUGANDO) W = true; // Registra que W esta presionada para acelerar
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_D && estado == JUGANDO) D = true; // Registra que D esta presionada para girar a la derecha
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_A && estado == JUGANDO) A = true; // Registra que A esta presionada para girar a la izquierda
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_SPACE && estado == JUGANDO) SPACE = true; // Registra que Space esta presionada para disparar
-
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_ENTER) { // Gestiona la tecla Enter
-                                if (estado == GAME_OVER) { // Si se encuentra en la pantalla de game over
-                                        estado = INPUT_NOMBRE; // Avanza al estado de captura de nombre
-                                        nombre = ""; // Limpia cualquier nombre previo
-                                } else if (estado == INPUT_NOMBRE) { // Si ya se esta capturando el nombre
-                                        if (nombre.empty()) nombre = "ANONIMO"; // Usa un nombre generico si el jugador no escribio nada
-
-                                        Estadistica s; // Estructura para guardar los datos finales
-                                        s.nombre = nombre; // Asigna el nombre capturado
-                                        s.puntuacion = puntos; // Registra la puntuacion final
-                                        s.tiempo = tiempo; // Guarda el tiempo activo de juego
-                                        s.ronda = ronda; // Guarda la ronda alcanzada
-                                        s.enemigos_eliminados = kills; // Registra la cantidad de enemigos eliminados
-                                        s.proyectiles_disparados = proyectiles; // Guarda los proyectiles disparados
-                                        guardarEstadisticas(s); // Persiste la informacion en archivo
-
-                                        jugando = false; // Finaliza el gameplay y regresa al menu
-                                }
-                        }
+        PlanificadorRender planificador; // Omite frames sin cambios y suspende la partida sin foco
+        iniciarPlanificador(planificador); // El primer frame se dibuja siempre
 
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_BACKSPACE && estado == INPUT_NOMBRE && !nombre.empty()) {
-                                nombre.pop_back(); // Elimina el ultimo caracter del nombre ingresado
-                        }
+        SistemaCaptura captura; // Capturas (F12) y clip de los ultimos segundos (F11 y game over)
+        iniciarCaptura(captura, ancho, alto, opciones.clip_segundos, opciones.clip_fps, opciones.clip_escala, opciones.hilos_captura); // Reserva todos los cuadros antes de medir la memoria
 
-                        if (estado == INPUT_NOMBRE) { // Durante la captura de nombre se procesan letras y numeros
-                                int key = ev.keyboard.keycode; // Codigo de la tecla presionada
+        MedidorMemoria memoria; // Asignaciones por frame y por subsistema (solo con MEDIR_ASIGNACIONES)
+        iniciarMedidorMemoria(memoria, opciones.archivo_asignaciones); // Lo reservado hasta aqui no cuenta para el primer frame
+        long ticks_jugando_asignando = 0; // Ticks JUGANDO cuya simulacion asigno memoria (deberian ser cero)
 
-                                if (key >= ALLEGRO_KEY_A && key <= ALLEGRO_KEY_Z && nombre.length() < 15) {
-                                        char letra = 'A' + (key - ALLEGRO_KEY_A); // Convierte el codigo de tecla a una letra mayuscula
-                                        nombre += letra; // Agrega la letra al nombre actual
-                                }
+        reiniciarTelemetria(telemetria); // El anillo empieza vacio en cada partida
+        double us_render = 0.0; // Duracion del ultimo frame dibujado
+        double us_simulacion_media = 0.0; // Coste medio del tick, referencia para el coste de la telemetria
 
-                                if (key >= ALLEGRO_KEY_0 && key <= ALLEGRO_KEY_9 && nombre.length() < 15) {
-                                        char num = '0' + (key - ALLEGRO_KEY_0); // Convierte el codigo de tecla a digito numerico
-                                        nombre += num; // Agrega el numero al nombre
-                                }
+        bool jugando = true; // Controla la permanencia en el bucle principal del gameplay
+        while (jugando) { // Bucle que se mantiene hasta que se abandona el gameplay
+                ALLEGRO_EVENT ev; // Almacena el evento recibido desde la cola
+                al_wait_for_event(queue, &ev); // Espera de manera bloqueante un nuevo evento
 
-                                if (key == ALLEGRO_KEY_SPACE && nombre.length() < 15) {
-                                        nombre += ' '; // Inserta un espacio entre palabras
-                                }
-                        }
+                if (coop && ev.type == ALLEGRO_EVENT_DISPLAY_SWITCH_OUT) { // En cooperativo una de las dos ventanas siempre esta sin foco
+                        W = D = A = SPACE = false; // Se sueltan las teclas pero la partida sigue
+                        continue; // No se suspende: la otra instancia depende de esta
                 }
 
-                if (ev.type == ALLEGRO_EVENT_KEY_UP) { // Gestiona la liberacion de teclas
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_W) W = false; // Libera la aceleracion
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_D) D = false; // Libera el giro a la derecha
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_A) A = false; // Libera el giro a la izquierda
-                        if (ev.keyboard.keycode == ALLEGRO_KEY_SPACE) SPACE = false; // Libera el disparo continuo
+                if (procesarEventoPantalla(planificador, ev, timer)) { // Foco, minimizado y exposicion de la ventana
+                        if (planificador.suspendido) W = D = A = SPACE = false; // Las liberaciones se pierden sin foco: se sueltan todas las teclas
+                        escalado.ultimo_flip = 0.0; // La pausa no debe contar como un frame lento
+                        continue; // Sin ticks no se simula nada hasta recuperar el foco
                 }
 
                 if (ev.type == ALLEGRO_EVENT_TIMER && ev.timer.source == timer) { // Actualizaciones sincronizadas con el temporizador
-                        tiempo_total += 1.0f / FPS; // Incrementa el tiempo total cada frame
-
-                        if (estado == JUGANDO) { // Solo actualiza la logica principal cuando se esta jugando
-                                tiempo += 1.0f / FPS; // Incrementa el cronometro de juego activo
-
-                                if (cooldown > 0.0f) cooldown -= 1.0f; // Reduce el tiempo restante para permitir otro disparo
-                                if (SPACE && cooldown <= 0.0f && player.activo) { // Comprueba si se puede disparar
-                                        dispararBala(balas, player); // Crea una nueva bala hacia la direccion actual
-                                        cooldown = CADENCIA_DISPARO; // Reinicia el temporizador de disparo
-                                        proyectiles++; // Incrementa el conteo de proyectiles lanzados
-                                        if (sfx_disparo) { // Si existe un sample de disparo cargado
-                                                al_play_sample(sfx_disparo, 0.3, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, NULL); // Reproduce el efecto de disparo
+                        cerrarFrameMemoria(memoria, estado); // Cierra la medicion del frame anterior
+                        EstadoJuego estado_inicio = estado; // Para detectar cambios de pantalla durante el tick
+                        EventoEntrada entrada; // Evento capturado por el hilo de entrada
+                        while (desencolarEntrada(hilo_entrada.cola, entrada)) { // Aplica toda la entrada pendiente antes de simular el tick
+                                ZonaMemoria zona_interfaz(MEM_INTERFAZ); // Nombre, top 5 y estadisticas se atribuyen a la interfaz
+                                if (opciones.medir_latencia) registrarEntradaConsumida(latencia, entrada.marca); // Queda pendiente hasta que se presente este frame
+                                marcarSucio(planificador); // La entrada puede cambiar lo que se muestra
+
+                                if (entrada.tipo == ALLEGRO_EVENT_KEY_DOWN) { // Gestiona pulsaciones de teclado
+                                        if (entrada.tecla == ALLEGRO_KEY_ESCAPE) { // Escape durante el gameplay
+                                                jugando = false; // Rompe el bucle y retorna al menu
                                         }
-                                }
 
-                                if (player.activo) {
-                                        actualizarEnemigos(enemigos, player, ancho, alto); // Actualiza el movimiento de todos los enemigos
-                                        actualizarBalas(balas); // Avanza la posicion de todas las balas activas
-                                }
+                                        if (entrada.tecla == ALLEGRO_KEY_F3) depuracion = !depuracion; // Alterna el panel de diagnostico
+                                        if (entrada.tecla == ALLEGRO_KEY_F4) volcarTelemetriaFechada(telemetria); // Vuelca la telemetria a peticion
+                                        if (entrada.tecla == ALLEGRO_KEY_F11) guardarClipCaptura(captura); // Guarda los ultimos segundos
+                                        if (entrada.tecla == ALLEGRO_KEY_F12) pedirPantallazo(captura); // Captura el proximo frame
+
+                                        if (entrada.tecla == ALLEGRO_KEY_W && estado == JUGANDO) W = true; // Registra que W esta presionada para acelerar
+                                        if (entrada.tecla == ALLEGRO_KEY_D && estado == JUGANDO) D = true; // Registra que D esta presionada para girar a la derecha
+                                        if (entrada.tecla == ALLEGRO_KEY_A && estado == JUGANDO) A = true; // Registra que A esta presionada para girar a la izquierda
+                                        if (entrada.tecla == ALLEGRO_KEY_SPACE && estado == JUGANDO) SPACE = true; // Registra que Space esta presionada para disparar
+
+                                        if (entrada.tecla == ALLEGRO_KEY_ENTER) { // Gestiona la tecla Enter
+                                                if (estado == GAME_OVER && !ingresando_nombre) { // Si se encuentra en la pantalla de game over
+                                                        if (coop && sesion.ultimo_confirmado < partida.tick - 1) continue; // Un game over aun no confirmado puede deshacerse con un rollback
+                                                        ingresando_nombre = true; // Avanza a la captura de nombre sin tocar el estado de la simulacion
+                                                        nombre = ""; // Limpia cualquier nombre previo
+                                                        top5 = obtenerTop5(); // Se consulta una sola vez, no en cada frame
+                                                        Estadistica provisional = Estadistica(); // Solo importan los puntos para el puesto
+                                                        provisional.puntuacion = puntos; // Puntuacion final
+                                                        posicion_partida = posicionEnVista(clasificacion, VISTA_PUNTUACION, provisional); // Puesto que ocupara al guardarse
+                                                } else if (ingresando_nombre) { // Si ya se esta capturando el nombre
+                                                        if (nombre.empty()) nombre = "ANONIMO"; // Usa un nombre generico si el jugador no escribio nada
+
+                                                        Estadistica s; // Estructura para guardar los datos finales
+                                                        s.nombre = nombre; // Asigna el nombre capturado
+                                                        s.puntuacion = puntos; // Registra la puntuacion final
+                                                        s.tiempo = tiempo; // Guarda el tiempo activo de juego
+                                                        s.ronda = ronda; // Guarda la ronda alcanzada
+                                                        s.enemigos_eliminados = kills; // Registra la cantidad de enemigos eliminados
+                                                        s.proyectiles_disparados = proyectiles; // Guarda los proyectiles disparados
+                                                        guardarEstadisticas(s); // Persiste la informacion en archivo
+                                                        agregarAClasificacion(clasificacion, s); // Actualiza los indices sin releer el archivo
+
+                                                        jugando = false; // Finaliza el gameplay y regresa al menu
+                                                }
+                                        }
 
-                                int muertos = verificarColisionesBalasEnemigos(balas, enemigos); // Detecta impactos de balas contra enemigos
-                                if (muertos > 0) { // Si algun enemigo fue destruido
-                                        kills += muertos; // Incrementa el total de eliminaciones
-                                        puntos += muertos * 100; // Suma puntos por cada enemigo destruido
-                                        if (sfx_explosion) al_play_sample(sfx_explosion, 0.5, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, NULL); // Reproduce el efecto de explosion
-                                }
+                                        if (entrada.tecla == ALLEGRO_KEY_BACKSPACE && ingresando_nombre && !nombre.empty()) {
+                                                nombre.pop_back(); // Elimina el ultimo caracter del nombre ingresado
+                                        }
 
-                                limpiarBalas(balas); // Elimina balas que se desactivaron
-                                limpiarEnemigosInactivos(enemigos); // Remueve enemigos destruidos de la lista
+                                        if (ingresando_nombre) { // Durante la captura de nombre se procesan letras y numeros
+                                                int key = entrada.tecla; // Codigo de la tecla presionada
 
-                                if (contarEnemigosActivos(enemigos) == 0 && player.activo) { // Comprueba si la ronda fue completada
-                                        estado = CAMBIO_RONDA; // Cambia al estado de transicion
-                                        timer_trans = DURACION_TRANSICION; // Establece la duracion de la pantalla intermedia
-                                        ronda++; // Incrementa el numero de ronda alcanzado
-                                        liberarBalas(balas); // Limpia cualquier bala restante
-                                        balas = NULL; // Reinicia el puntero de balas
-                                        resetearJugador(player, ancho, alto); // Regresa al jugador al centro y reinicia su movimiento
-                                }
+                                                if (key >= ALLEGRO_KEY_A && key <= ALLEGRO_KEY_Z && nombre.length() < 15) {
+                                                        char letra = 'A' + (key - ALLEGRO_KEY_A); // Convierte el codigo de tecla a una letra mayuscula
+                                                        nombre += letra; // Agrega la letra al nombre actual
+                                                }
 
-                                if (verificarColisionJugadorEnemigos(player, enemigos)) { // Comprueba si el jugador colisiona con un enemigo
-                                        player.activo = false; // Desactiva al jugador para detener la logica de movimiento
-                                        delay_muerte = 120.0f; // Establece un retraso antes del game over
-                                        if (sfx_muerte) al_play_sample(sfx_muerte, 0.7, 0.0, 1.0, ALLEGRO_PLAYMODE_ONCE, NULL); // Reproduce el efecto de muerte del jugador
-                                }
+                                                if (key >= ALLEGRO_KEY_0 && key <= ALLEGRO_KEY_9 && nombre.length() < 15) {
+                                                        char num = '0' + (key - ALLEGRO_KEY_0); // Convierte el codigo de tecla a digito numerico
+                                                        nombre += num; // Agrega el numero al nombre
+                                                }
 
-                                if (!player.activo && delay_muerte > 0.0f) { // Mientras espera antes de mostrar el game over
-                                        delay_muerte -= 1.0f; // Reduce el temporizador de retraso
-                                        if (delay_muerte <= 0.0f) { // Cuando termina el retraso
-                                                estado = GAME_OVER; // Cambia al estado de game over
-                                                tocarMusica(musica_gameover, 0.6f); // Reproduce la musica de game over
+                                                if (key == ALLEGRO_KEY_SPACE && nombre.length() < 15) {
+                                                        nombre += ' '; // Inserta un espacio entre palabras
+                                                }
                                         }
                                 }
 
-                                if (player.activo) { // Actualiza la fisica de la nave solo si sigue viva
-                                        if (A) player.ang -= ROTACION; // Gira hacia la izquierda cuando A esta activa
-                                        if (D) player.ang += ROTACION; // Gira hacia la derecha cuando D esta activa
-
-                                        if (W) { // Aplica impulso hacia adelante cuando se presiona W
-                                                float fx = sin(player.ang); // Componente horizontal del impulso segun el angulo actual
-                                                float fy = -cos(player.ang); // Componente vertical del impulso
-                                                player.vx += fx * ACELERACION; // Ajusta la velocidad horizontal del jugador
-                                                player.vy += fy * ACELERACION; // Ajusta la velocidad vertical del jugador
-                                        }
-
-                                        player.vx *= ROZAMIENTO; // Aplica amortiguamiento a la velocidad horizontal
-                                        player.vy *= ROZAMIENTO; // Aplica amortiguamiento a la velocidad vertical
-
-                                        float vel = player.vx * player.vx + player.vy * player.vy; // Calcula la magnitud al cuadrado de la velocidad
-                                        if (vel > VELOCIDAD_MAX * VELOCIDAD_MAX) { // Comprueba si supera el limite permitido
-                                                float factor = VELOCIDAD_MAX / sqrt(vel); // Calcula el factor de reduccion necesario
-                                                player.vx *= factor; // Escala la velocidad horizontal para respetar el limite
-                                                player.vy *= factor; // Escala la velocidad vertical
-                                        }
+                                if (entrada.tipo == ALLEGRO_EVENT_KEY_UP) { // Gestiona la liberacion de teclas
+                                        if (entrada.tecla == ALLEGRO_KEY_W) W = false; // Libera la aceleracion
+                                        if (entrada.tecla == ALLEGRO_KEY_D) D = false; // Libera el giro a la derecha
+                                        if (entrada.tecla == ALLEGRO_KEY_A) A = false; // Libera el giro a la izquierda
+                                        if (entrada.tecla == ALLEGRO_KEY_SPACE) SPACE = false; // Libera el disparo continuo
+                                }
+                        }
 
-                                        player.x += player.vx; // Actualiza la posicion horizontal del jugador
-                                        player.y += player.vy; // Actualiza la posicion vertical del jugador
+                        unsigned char entrada_local = (W ? ENTRADA_ACELERAR : 0) | (A ? ENTRADA_IZQUIERDA : 0) | (D ? ENTRADA_DERECHA : 0) | (SPACE ? ENTRADA_DISPARO : 0); // Entrada de este tick en formato compacto
 
-                                        if (player.x < 25) player.x = 25; // Evita que la nave salga por el borde izquierdo
-                                        if (player.x >= ancho - 25) player.x = ancho - 25; // Evita que la nave salga por el borde derecho
-                                        if (player.y < 25) player.y = 25; // Evita que la nave salga por la parte superior
-                                        if (player.y >= alto - 25) player.y = alto - 25; // Evita que la nave salga por la parte inferior
+                        long long asignaciones_previas = asignacionesEtiqueta(MEM_SIMULACION); // Para detectar asignaciones dentro del tick (solo las del propio tick)
+                        double inicio_simulacion = al_get_time(); // Duracion de la simulacion para la telemetria
+                        if (coop) { // Cooperativo: la sesion predice, corrige y avanza
+                                ZonaMemoria zona_simulacion(MEM_SIMULACION); // Red, rollback y tick
+                                if (!sesion.conectado) { // Todavia no hay contacto con la otra instancia
+                                        recibirEntradasCoop(sesion, 0); // Comprueba si ya respondio
+                                        enviarEntradasCoop(sesion, 0); // Se anuncia a la otra instancia
+                                        if (sesion.conectado) iniciarEstadoPartida(partida, ancho, alto, 2, sesion.semilla); // Ambas instancias arrancan del mismo estado
                                 }
+                                esperando = !sesion.conectado || !avanzarCoop(sesion, partida, campo, entrada_local, &particulas, &vista); // Sin contacto o demasiado adelantado: se espera
+                        } else { // En solitario solo hay una entrada y nunca se corrige
+                                ZonaMemoria zona_simulacion(MEM_SIMULACION); // Instantanea y tick
+                                unsigned char entradas[MAX_JUGADORES] = {entrada_local, 0}; // El segundo jugador no existe
+                                guardarInstantanea(instantaneas, partida); // Estado al comienzo del tick
+                                simularTick(partida, campo, entradas, &particulas, true, &vista); // Avanza la partida con sonido, particulas y vista
                         }
+                        if (estado_inicio == JUGANDO && asignacionesEtiqueta(MEM_SIMULACION) > asignaciones_previas) ticks_jugando_asignando++; // El tick estable no deberia tocar el heap
+
+                        double us_simulacion = (al_get_time() - inicio_simulacion) * 1000000.0; // Coste del tick (incluye red y rollback)
+                        us_simulacion_media = us_simulacion_media * 0.95 + us_simulacion * 0.05; // Media movil
+                        if (estado_inicio == JUGANDO && !esperando && vista.tick == partida.tick) ajustarPresupuestoIA(presupuesto_ia, partida.ia, vista.us_ia); // Solo los ticks de juego deciden
+
+                        double inicio_registro = al_get_time(); // Coste de la propia telemetria
+                        const Nave& nave_local = partida.jugadores[jugador_local]; // Posicion del jugador de este teclado
+                        int fila[NUM_COLUMNAS_TELEMETRIA] = {partida.tick, (int)estado, ronda, partida.pool_naves.en_uso, partida.pool_balas.en_uso, particulas.vivas, (int)nave_local.x, (int)nave_local.y, (int)us_simulacion, (int)us_render, (int)(vista.us_etapas_tick[ETAPA_DISPARO] * 1000.0), (int)(vista.us_etapas_tick[ETAPA_BALAS] * 1000.0), (int)(vista.us_etapas_tick[ETAPA_IA] * 1000.0), (int)(vista.us_etapas_tick[ETAPA_ENEMIGOS] * 1000.0), (int)(vista.us_etapas_tick[ETAPA_JUGADORES] * 1000.0), (int)(vista.us_etapas_tick[ETAPA_TEMPORIZADORES] * 1000.0)}; // Una fila por tick
+                        registrarTelemetria(telemetria, fila); // Escritura en el anillo, sin asignar
+                        telemetria.us_registro = telemetria.us_registro * 0.95 + (al_get_time() - inicio_registro) * 1000000.0 * 0.05; // Media movil del coste
+
+                        datosPartidaMetricas(metricas, partida, particulas.vivas, us_simulacion, us_render); // Estado del tick para el agente externo
+                        if (ingresando_nombre) metricas.datos.estado = INPUT_NOMBRE; // La captura de nombre no forma parte de la simulacion
+                        datosAudioMetricas(metricas, al_get_time()); // Voces en uso
+                        publicarMetricas(metricas); // Seqlock sobre memoria ya proyectada: sin llamadas al sistema
+
+                        if (estado == GAME_OVER && estado_inicio != GAME_OVER) { // La partida acaba de terminar
+                                tocarMusica(musica_gameover, 0.6f); // Reproduce la musica de game over
+                                volcarTelemetriaFechada(telemetria); // Guarda los ultimos minutos de la partida
+                                guardarClipCaptura(captura); // Y los ultimos segundos de imagen
+                        }
+                        if (!esperando && (estado == JUGANDO || estado == CAMBIO_RONDA)) actualizarParticulas(particulas); // Las ultimas explosiones se desvanecen tambien durante la transicion
 
-                        if (estado == CAMBIO_RONDA) { // Actualiza la pantalla de transicion entre rondas
-                                timer_trans -= 1.0f; // Reduce el temporizador de la pantalla intermedia
-                                if (timer_trans <= 0.0f) { // Una vez finalizado el temporizador
-                                        generarOleada(enemigos, ronda, ancho, alto); // Genera la siguiente oleada de enemigos
-                                        estado = JUGANDO; // Regresa al estado de juego activo
-                                }
+                        if (estado != estado_inicio || estado == JUGANDO || estado == CAMBIO_RONDA || esperando) marcarSucio(planificador); // La escena se anima en cada tick
+                        if (ingresando_nombre && (int)(tiempo_total * 2.0f) != (int)((tiempo_total - 1.0f / FPS) * 2.0f)) marcarSucio(planificador); // Parpadeo del cursor
+                        if (!debeDibujar(planificador)) { // Pantalla estatica (game over sin entrada): no se redibuja ni se presenta
+                                escalado.ultimo_flip = 0.0; // El hueco entre frames no es un frame lento
+                                continue; // Espera al siguiente evento
                         }
 
+                        ZonaMemoria zona_render(MEM_RENDER); // Desde aqui hasta la presentacion todo cuenta como dibujo
+                        double inicio_render = al_get_time(); // Duracion del dibujo para la telemetria
                         al_clear_to_color(al_map_rgb(0, 0, 0)); // Limpia la pantalla antes de dibujar el nuevo frame
 
                         if (estado == JUGANDO) {
-                                if (fondo_gameplay) {
-                                        al_draw_scaled_bitmap(fondo_gameplay, 0, 0, al_get_bitmap_width(fondo_gameplay), al_get_bitmap_height(fondo_gameplay), 0, 0, ancho, alto, 0); // Dibuja el fondo del gameplay ajustado a la pantalla
-                                }
-
-                                if (player.activo) {
-                                        ALLEGRO_TRANSFORM guardado, t; // Transformaciones para posicionar la nave
-                                        al_copy_transform(&guardado, al_get_current_transform()); // Guarda la transformacion actual
-                                        al_identity_transform(&t); // Inicializa una transformacion identidad
-                                        al_rotate_transform(&t, player.ang); // Aplica la rotacion de la nave
-                                        al_translate_transform(&t, player.x, player.y); // Traslada la transformacion a la posicion del jugador
-                                        al_use_transform(&t); // Activa la transformacion combinada
-
-                                        al_draw_filled_polygon(Puntos_jugador, 4, al_map_rgb(60, 180, 255)); // Dibuja el cuerpo de la nave del jugador
-                                        al_draw_polygon(Puntos_jugador, 4, ALLEGRO_LINE_JOIN_ROUND, al_map_rgb(255, 255, 255), 1.5f, 1.0f); // Dibuja el contorno de la nave
-
-                                        al_use_transform(&guardado); // Restaura la transformacion previa para no afectar dibujos posteriores
-                                }
-
-                                PtrNave e = enemigos; // Inicia el recorrido para dibujar cada enemigo
-                                while (e != NULL) {
-                                        if (e->activo) {
-                                                if (e->tipo == 1) {
-                                                        al_draw_circle(e->x, e->y, 50.0f, al_map_rgb(170, 255, 170), 2); // Dibuja el contorno exterior del drone
-                                                        al_draw_circle(e->x, e->y, 45.0f, al_map_rgb(170, 255, 170), 3); // Dibuja un segundo circulo para efecto visual
-                                                } else if (e->tipo == 2) {
-                                                        ALLEGRO_TRANSFORM old, Ts; // Transformaciones para orientar el seeker
-                                                        al_copy_transform(&old, al_get_current_transform()); // Guarda la transformacion actual
-                                                        al_identity_transform(&Ts); // Reinicia una transformacion identidad
-
-                                                        float ang = atan2f(player.y - e->y, player.x - e->x) + 3.14159f / 2.0f; // Calcula el angulo hacia el jugador
-                                                        al_rotate_transform(&Ts, ang); // Rota el triangulo del seeker para que apunte al jugador
-                                                        al_translate_transform(&Ts, e->x, e->y); // Posiciona el triangulo en la ubicacion del enemigo
-                                                        al_use_transform(&Ts); // Aplica la transformacion temporal
-
-                                                        al_draw_triangle(v[0], v[1], v[2], v[3], v[4], v[5], al_map_rgb(255, 100, 220), 6); // Dibuja el contorno grueso del seeker
-                                                        al_draw_triangle(v[0], v[1], v[2], v[3], v[4], v[5], al_map_rgb(255, 255, 255), 3); // Dibuja un contorno adicional blanco
-                                                        al_draw_triangle(v[0], v[1] + 20, v[2] + 15, v[3] - 10, v[4] - 15, v[5] - 10, al_map_rgb(255, 100, 220), 3); // Dibuja una franja interior
-                                                        al_draw_triangle(v[0], v[1] + 20, v[2] + 15, v[3] - 10, v[4] - 15, v[5] - 10, al_map_rgb(255, 255, 255), 1); // Dibuja el borde de la franja interior
-
-                                                        al_use_transform(&old); // Restaura la transformacion previa
-                                                }
-                                        }
-                                        e = e->siguiente; // Avanza al siguiente enemigo en la lista
-                                }
-
-                                PtrBala b = balas; // Recorre la lista de balas activas
-                                while (b != NULL) {
-                                        if (b->activa) {
-                                                al_draw_filled_circle(b->x, b->y, 5.0f, al_map_rgb(255, 255, 0)); // Dibuja la bala como un circulo amarillo
-                                        }
-                                        b = b->siguiente; // Continua con la siguiente bala
+                                comenzarEscena(escalado); // La escena del mundo se dibuja a la escala dinamica actual
+                                al_clear_to_color(al_map_rgb(0, 0, 0)); // Limpia la region de la escena
+                                dibujarFondo(fondo_gameplay, ancho, alto); // Fondo ajustado al area de juego
+                                for (int j = 0; j < partida.num_jugadores; j++) { // Nave de cada jugador
+                                        if (partida.jugadores[j].activo) dibujarJugador(partida.jugadores[j], j == 0 ? al_map_rgb(60, 180, 255) : al_map_rgb(255, 150, 50)); // Azul el jugador 1, naranja el jugador 2
                                 }
-
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 10, ALLEGRO_ALIGN_LEFT, "PUNTUACION: %d", puntos); // Muestra la puntuacion actual
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 35, ALLEGRO_ALIGN_LEFT, "RONDA: %d", ronda); // Muestra la ronda activa
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), 10, 60, ALLEGRO_ALIGN_LEFT, "TIEMPO: %.1f", tiempo); // Muestra el tiempo de juego
+                                Nave* objetivo = jugadorObjetivo(partida); // Los seekers apuntan al jugador que persiguen
+                                const Nave& apuntado = objetivo ? *objetivo : partida.jugadores[jugador_local]; // Jugador hacia el que miran los seekers
+                                bool vista_actual = vista.tick == partida.tick; // Solo falta antes del primer tick (cooperativo esperando a la otra instancia)
+                                if (vista_actual) dibujarVistaEnemigos(vista.enemigos, apuntado); // Drones y seekers ya recorridos por el tick
+                                else dibujarEnemigos(partida.enemigos, apuntado); // Primera oleada antes de simular
+                                dibujarParticulas(particulas); // Dibuja todas las particulas con una sola llamada
+                                if (vista_actual) dibujarVistaBalas(vista.balas); // Proyectiles activos
+                                else dibujarBalas(partida.balas); // Sin vista del tick
+                                terminarEscena(escalado, pantalla); // Reescala la escena al backbuffer
+
+                                dibujarHUD(font, puntos, ronda, tiempo); // El HUD se compone a resolucion nativa
                         }
 
                         if (estado == CAMBIO_RONDA) {
-                                float progreso = 1.0f - (timer_trans / DURACION_TRANSICION); // Calcula el avance de la transicion respecto al tiempo total
+                                comenzarEscena(escalado); // Las explosiones restantes tambien pasan por la escena escalada
+                                al_clear_to_color(al_map_rgb(0, 0, 0)); // Limpia la region de la escena
+                                dibujarParticulas(particulas); // Deja terminar las explosiones de la ronda anterior
+                                terminarEscena(escalado, pantalla); // Reescala la escena al backbuffer
+
+                                float progreso = 1.0f - (tiempoTransicion(partida) / DURACION_TRANSICION); // Calcula el avance de la transicion respecto al tiempo total
                                 float fade = (progreso < 0.3f) ? (progreso / 0.3f) : ((progreso > 0.7f) ? ((1.0f - progreso) / 0.3f) : 1.0f); // Determina la intensidad del texto para efecto de fade
 
-                                char txt[50]; // Buffer temporal para el mensaje de ronda
-                                sprintf_s(txt, 50, "RONDA %d", ronda); // Formatea el numero de ronda
+                                const char* txt = formatearArena(arena_frame, "RONDA %d", ronda); // Formatea el numero de ronda en la arena del frame
 
                                 al_draw_text(font, al_map_rgba_f(fade, fade, 0, fade), ancho / 2, alto / 2 - 50, ALLEGRO_ALIGN_CENTER, txt); // Dibuja el mensaje principal con transparencia variable
                                 al_draw_text(font, al_map_rgba_f(0.8f * fade, 0.8f * fade, 0.8f * fade, fade), ancho / 2, alto / 2, ALLEGRO_ALIGN_CENTER, "Preparate..."); // Dibuja un mensaje secundario
                         }
 
-                        if (estado == GAME_OVER) {
+                        if (estado == GAME_OVER && !ingresando_nombre) {
                                 al_draw_text(font, al_map_rgb(255, 0, 0), ancho / 2, alto / 2 - 200, ALLEGRO_ALIGN_CENTER, "GAME OVER"); // Encabezado de la pantalla de derrota
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 140, ALLEGRO_ALIGN_CENTER, "Puntuacion Final: %d", puntos); // Muestra la puntuacion final
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 110, ALLEGRO_ALIGN_CENTER, "Tiempo: %.1f segundos", tiempo); // Muestra el tiempo de juego
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 80, ALLEGRO_ALIGN_CENTER, "Enemigos Eliminados: %d", kills); // Muestra las bajas totales
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 50, ALLEGRO_ALIGN_CENTER, "Ronda Alcanzada: %d", ronda); // Muestra la ronda alcanzada
+                                dibujarTextoArena(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 140, ALLEGRO_ALIGN_CENTER, "Puntuacion Final: %d", puntos); // Muestra la puntuacion final
+                                dibujarTextoArena(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 110, ALLEGRO_ALIGN_CENTER, "Tiempo: %.1f segundos", tiempo); // Muestra el tiempo de juego
+                                dibujarTextoArena(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 80, ALLEGRO_ALIGN_CENTER, "Enemigos Eliminados: %d", kills); // Muestra las bajas totales
+                                dibujarTextoArena(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 50, ALLEGRO_ALIGN_CENTER, "Ronda Alcanzada: %d", ronda); // Muestra la ronda alcanzada
                                 al_draw_text(font, al_map_rgb(150, 150, 150), ancho / 2, alto / 2, ALLEGRO_ALIGN_CENTER, "Presiona ENTER para continuar..."); // Instruccion para avanzar a la captura de nombre
                         }
 
-                        if (estado == INPUT_NOMBRE) {
+                        if (ingresando_nombre) {
                                 al_draw_text(font, al_map_rgb(255, 255, 0), ancho / 2, alto / 2 - 250, ALLEGRO_ALIGN_CENTER, "NUEVA PUNTUACION!"); // Mensaje de felicitacion por entrar al ranking
-                                al_draw_textf(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 200, ALLEGRO_ALIGN_CENTER, "Puntuacion: %d", puntos); // Muestra la puntuacion alcanzada
+                                dibujarTextoArena(font, al_map_rgb(255, 255, 255), ancho / 2, alto / 2 - 200, ALLEGRO_ALIGN_CENTER, "Puntuacion: %d (puesto %d de %d)", puntos, posicion_partida, totalVista(clasificacion, VISTA_PUNTUACION) + 1); // Muestra la puntuacion alcanzada y su puesto
                                 al_draw_text(font, al_map_rgb(200, 200, 200), ancho / 2, alto / 2 - 140, ALLEGRO_ALIGN_CENTER, "Ingresa tu nombre:"); // Indica que se debe ingresar un nombre
 
                                 bool mostrar = ((int)(tiempo_total * 2.0f)) % 2 == 0; // Determina si el cursor debe mostrarse parpadeando
-                                string txt = nombre; // Copia el nombre actual para visualizacion
+                                CadenaArena txt(nombre.begin(), nombre.end(), AsignadorArena<char>(arena_frame)); // Copia el nombre en la arena del frame (16 caracteres no caben en el buffer interno de string)
                                 if (mostrar) txt += "_"; // Agrega un cursor visible cuando corresponde
                                 if (txt.empty()) txt = "_"; // Garantiza que al menos se muestre el cursor
 
@@ -316,24 +417,50 @@ void iniciarJuego(int ancho, int alto, ALLEGRO_FONT* font, ALLEGRO_TIMER* timer,
 
                                 al_draw_text(font, al_map_rgb(255, 255, 0), ancho / 2, alto / 2 + 40, ALLEGRO_ALIGN_CENTER, "=== TOP 5 ==="); // Encabezado de la tabla de mejores puntuaciones
 
-                                vector<Estadistica> top5 = obtenerTop5(); // Obtiene las cinco mejores estadisticas registradas
                                 int y = 75; // Posicion vertical inicial para listar el top 5
                                 for (size_t i = 0; i < top5.size(); i++) { // Recorre cada entrada del ranking
-                                        char linea[100]; // Buffer temporal para formatear la linea
-                                        sprintf_s(linea, 100, "%d. %s - %d pts (Ronda %d)", (int)(i + 1), top5[i].nombre.c_str(), top5[i].puntuacion, top5[i].ronda); // Formatea la informacion clave
+                                        dibujarTextoArena(font, colorPodio(i), ancho / 2, alto / 2 + y, ALLEGRO_ALIGN_CENTER, "%d. %s - %d pts (Ronda %d)", (int)(i + 1), top5[i].nombre.c_str(), top5[i].puntuacion, top5[i].ronda); // Dibuja la linea correspondiente del top 5
+                                        y += 25; // Ajusta la posicion vertical para la siguiente entrada
+                                }
+
+                                const Estadistica* mejor = mejorMarca(clasificacion, nombre); // Mejor partida previa con el nombre escrito
+                                if (mejor) dibujarTextoArena(font, al_map_rgb(150, 200, 255), ancho / 2, alto / 2 + y + 15, ALLEGRO_ALIGN_CENTER, "Mejor marca de %s: %d pts (Ronda %d)", mejor->nombre.c_str(), mejor->puntuacion, mejor->ronda); // Marca a batir
+                        }
 
-                                        ALLEGRO_COLOR col; // Color a aplicar segun la posicion en el ranking
-                                        if (i == 0) col = al_map_rgb(255, 215, 0); // Oro para el primer lugar
-                                        else if (i == 1) col = al_map_rgb(192, 192, 192); // Plata para el segundo lugar
-                                        else if (i == 2) col = al_map_rgb(205, 127, 50); // Bronce para el tercer lugar
-                                        else col = al_map_rgb(200, 200, 200); // Gris para el resto de posiciones
+                        if (esperando) al_draw_text(font, al_map_rgb(255, 255, 0), ancho / 2, alto / 2 + 60, ALLEGRO_ALIGN_CENTER, "Esperando al otro jugador..."); // Cooperativo detenido hasta recibir su entrada
 
-                                        al_draw_text(font, col, ancho / 2, alto / 2 + y, ALLEGRO_ALIGN_CENTER, linea); // Dibuja la linea correspondiente del top 5
-                                        y += 25; // Ajusta la posicion vertical para la siguiente entrada
+                        if (depuracion) { // Panel de diagnostico en la esquina inferior izquierda
+                                if (coop) { // Estado del rollback
+                                        dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 135, ALLEGRO_ALIGN_LEFT, "ROLLBACK: tick %d  confirmado %d  rollbacks %d  max %d ticks  %.2f ms (max %.2f)  instantanea %.1f us  esperas %d", partida.tick, sesion.ultimo_confirmado, sesion.rollbacks, sesion.max_resimulados, sesion.ms_rollback, sesion.ms_rollback_max, sesion.instantaneas.us_guardado, sesion.ticks_esperando); // Coste de las re-simulaciones
+                                } else { // Solo instantaneas
+                                        dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 135, ALLEGRO_ALIGN_LEFT, "ESTADO: tick %d  %u bytes  instantanea %.1f us  temporizadores %d (vencidos %ld, recolocados %ld)", partida.tick, (unsigned int)sizeof(EstadoPartida), instantaneas.us_guardado, partida.temporizadores.en_uso, partida.temporizadores.vencidos, partida.temporizadores.recolocados); // Coste de copiar el estado
+                                }
+                                if (opciones.medir_latencia) { // Percentiles de latencia de entrada
+                                        dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 60, ALLEGRO_ALIGN_LEFT, "LATENCIA ENTRADA: p50 %.1f ms  p95 %.1f ms  p99 %.1f ms  (%d muestras, %u descartadas)", percentilLatencia(latencia, 0.50f), percentilLatencia(latencia, 0.95f), percentilLatencia(latencia, 0.99f), latencia.total, hilo_entrada.cola.descartados.load()); // Resumen de la medicion en curso
+                                }
+                                if (etapasInstrumentadas()) { // Coste de cada etapa del tick
+                                        const double* us = vista.us_etapas; // Medias moviles en microsegundos
+                                        dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 235, ALLEGRO_ALIGN_LEFT, "ETAPAS: %s %.1f  %s %.1f  %s %.1f  %s %.1f  %s %.1f  %s %.1f us  (%d enemigos, %d balas)", NOMBRES_ETAPAS_TICK[0], us[0], NOMBRES_ETAPAS_TICK[1], us[1], NOMBRES_ETAPAS_TICK[2], us[2], NOMBRES_ETAPAS_TICK[3], us[3], NOMBRES_ETAPAS_TICK[4], us[4], NOMBRES_ETAPAS_TICK[5], us[5], vista.enemigos.n, vista.balas.n); // Pasadas del tick
                                 }
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 285, ALLEGRO_ALIGN_LEFT, "IA: cupo %d%s  %d decisiones/tick (%d cercanos)  vuelta en %d ticks  %.1f us (media %.1f, max %.1f) de %.0f  excesos %ld/%ld", partida.ia.cupo, presupuesto_ia.adaptable ? "" : " fijo", partida.ia.decisiones_tick, partida.ia.n_cercanos, partida.ia.ticks_vuelta, presupuesto_ia.us_tick, presupuesto_ia.us_media, presupuesto_ia.us_maximo, presupuesto_ia.presupuesto_us, presupuesto_ia.excesos, presupuesto_ia.ticks); // Reparto de las decisiones de los seekers
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 260, ALLEGRO_ALIGN_LEFT, "CAPTURA: %.1f us/frame (max %.1f)  clip %d cuadros (%ld grabados)  pendientes %d  guardados %ld  fallos %ld  descartados %ld  (F11 clip, F12 captura)", captura.us_frame, captura.us_maximo, captura.num_cuadros, captura.cuadros, trabajosPendientesCaptura(captura), captura.guardados.load(), captura.fallos.load(), captura.descartados); // Coste de la captura en el hilo del juego
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 210, ALLEGRO_ALIGN_LEFT, "TELEMETRIA: %d/%d ticks  registro %.3f us (%.2f%% del tick)  volcados %d (F4)", ticksTelemetria(telemetria), CAPACIDAD_TELEMETRIA, telemetria.us_registro, us_simulacion_media > 0.0 ? telemetria.us_registro * 100.0 / us_simulacion_media : 0.0, telemetria.volcados); // Coste del registro permanente
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 185, ALLEGRO_ALIGN_LEFT, "ARENA: %u/%u bytes (pico %u)  desbordes %ld", (unsigned int)arena_frame.usado, (unsigned int)arena_frame.capacidad, (unsigned int)arena_frame.pico, arena_frame.desbordes); // Ocupacion de la arena del frame
+                                if (memoriaInstrumentada()) { // Asignaciones del ultimo frame cerrado
+                                        dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 160, ALLEGRO_ALIGN_LEFT, "MEMORIA: %d asig/frame  sim %lld  render %lld  interfaz %lld  persist %lld  entrada %lld  captura %lld  (%lld B)  frames con asig %ld/%ld  ticks JUGANDO con asig %ld", asignacionesFrame(memoria), memoria.frame[MEM_SIMULACION].asignaciones, memoria.frame[MEM_RENDER].asignaciones, memoria.frame[MEM_INTERFAZ].asignaciones, memoria.frame[MEM_PERSISTENCIA].asignaciones, memoria.frame[MEM_ENTRADA].asignaciones, memoria.frame[MEM_CAPTURA].asignaciones, bytesFrame(memoria), memoria.frames_con_asignaciones, memoria.frames, ticks_jugando_asignando); // Presupuesto de asignaciones
+                                }
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 110, ALLEGRO_ALIGN_LEFT, "RENDER: %ld frames dibujados, %ld omitidos, %d suspensiones (%.1f s)", planificador.frames_dibujados, planificador.frames_omitidos, planificador.suspensiones, planificador.segundos_suspendido); // Contadores del planificador
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 85, ALLEGRO_ALIGN_LEFT, "ESCALA: %d%% (%d-%d%%)  frame %.2f ms  ajustes %d", (int)(escalado.escala * 100.0f + 0.5f), (int)(escalado.escala_min * 100.0f + 0.5f), (int)(escalado.escala_max * 100.0f + 0.5f), escalado.frame_ms, escalado.ajustes); // Estado del escalado dinamico
+                                dibujarTextoArena(font, al_map_rgb(0, 255, 255), 10, alto - 35, ALLEGRO_ALIGN_LEFT, "PARTICULAS: %d/%d  %.2f ms (max %.2f)  emision %d%%  desalojadas %ld", particulas.vivas, MAX_PARTICULAS, particulas.ms_frame, particulas.ms_maximo, (int)(particulas.escala_emision * 100.0f), particulas.desalojadas); // Coste y ocupacion del sistema de particulas
                         }
 
+                        capturarFrame(captura, pantalla, al_get_time()); // Copia el frame compuesto si toca cuadro de clip o hay una captura pedida
                         al_flip_display(); // Presenta todo el contenido dibujado en el frame actual
+                        reiniciarArena(arena_frame); // Los textos del frame ya no se necesitan
+                        us_render = (al_get_time() - inicio_render) * 1000000.0; // Se registra en el proximo tick
+                        registrarFrameMetricas(metricas, al_get_time()); // FPS publicados
+                        registrarFrameEscalado(escalado, al_get_time()); // Ajusta la escala segun la duracion medida del frame
+                        if (opciones.medir_latencia) registrarPresentacion(latencia, al_get_time()); // Cierra la medicion de la entrada aplicada en este frame
                 }
 
                 if (ev.type == ALLEGRO_EVENT_DISPLAY_CLOSE) { // Maneja el cierre de la ventana durante el gameplay
@@ -341,6 +468,79 @@ void iniciarJuego(int ancho, int alto, ALLEGRO_FONT* font, ALLEGRO_TIMER* timer,
                 }
         }
 
-        liberarEnemigos(enemigos); // Libera la memoria asociada a la lista de enemigos
-        liberarBalas(balas); // Libera la memoria de todas las balas restantes
+        destruirEscalado(escalado); // Libera el bitmap intermedio de la escena
+        int pendientes_captura = trabajosPendientesCaptura(captura); // PNG que aun faltan por escribir
+        detenerCaptura(captura); // Espera a que terminen de escribirse
+        if (captura.cuadros > 0 || captura.pantallazos_pedidos > 0) printf("Captura: %.1f us/frame de media (max %.1f), %ld cuadros de clip, %d clips, %ld capturas, %ld PNG guardados (%d al salir), %ld fallos, %ld descartados\n", captura.us_frame, captura.us_maximo, captura.cuadros, captura.clips, captura.pantallazos_pedidos, captura.guardados.load(), pendientes_captura, captura.fallos.load(), captura.descartados); // Resumen por consola
+        if (presupuesto_ia.ticks > 0) printf("IA: %.1f us/tick de media (max %.1f, presupuesto %.0f), %ld de %ld ticks excedidos, cupo final %d, %ld decisiones\n", presupuesto_ia.us_media, presupuesto_ia.us_maximo, presupuesto_ia.presupuesto_us, presupuesto_ia.excesos, presupuesto_ia.ticks, partida.ia.cupo, partida.ia.decisiones); // Resumen por consola
+        detenerHiloEntrada(hilo_entrada); // Detiene la captura dedicada
+        al_register_event_source(queue, al_get_keyboard_event_source()); // Devuelve el teclado a la cola principal para el menu
+
+        if (opciones.medir_latencia && latencia.total > 0) { // Informe final del modo de medicion
+                printf("Latencia entrada->presentacion: p50 %.2f ms | p95 %.2f ms | p99 %.2f ms | max %.2f ms (%d muestras)\n", percentilLatencia(latencia, 0.50f), percentilLatencia(latencia, 0.95f), percentilLatencia(latencia, 0.99f), percentilLatencia(latencia, 1.0f), latencia.total); // Percentiles por consola
+        }
+
+        if (memoriaInstrumentada()) { // Informe final de asignaciones
+                printf("Asignaciones: %ld de %ld frames asignaron memoria, %ld ticks JUGANDO con asignaciones\n", memoria.frames_con_asignaciones, memoria.frames, ticks_jugando_asignando); // Resumen por consola
+        }
+
+        if (coop) cerrarSesionCoop(sesion); // Libera el puerto del modo cooperativo
+}
+
+// ========== VERIFICACION DE ASIGNACIONES ==========
+
+// Simula sin ventana una partida con un piloto automatico y comprueba que ningun tick JUGANDO,
+// pasado el primer segundo, asigne memoria. Devuelve el codigo de salida del proceso
+int verificarAsignaciones(int ticks) {
+        if (!memoriaInstrumentada()) { // Sin operadores medidos no hay nada que comprobar
+                printf("--verificar-asignaciones requiere compilar con MEDIR_ASIGNACIONES (configuracion Debug)\n"); // Indica como activarlo
+                return 2; // Distinto de un fallo de la verificacion
+        }
+
+        const int ancho = ANCHO_SIN_VENTANA, alto = ALTO_SIN_VENTANA; // Area de juego de referencia
+        EstadoPartida partida; // Estado simulado
+        CampoFlujo campo; // Rejilla de los seekers
+        SistemaParticulas particulas; // Las explosiones tambien forman parte del tick
+        iniciarCampoFlujo(campo, ancho, alto); // Reservas previas a la medicion
+        iniciarParticulas(particulas); // Almacenamiento fijo de particulas
+        unsigned int semilla = 1u; // Semilla fija: la verificacion es reproducible
+        iniciarEstadoPartida(partida, ancho, alto, 1, semilla); // Primera partida
+
+        MedidorMemoria memoria; // Deltas por tick y por etiqueta
+        iniciarMedidorMemoria(memoria, opciones.archivo_asignaciones); // Volcado opcional de cada tick
+        long long asignaciones_por_etiqueta[NUM_ETIQUETAS_MEMORIA] = {}; // Asignaciones acumuladas en ticks JUGANDO
+        long ticks_medidos = 0, ticks_asignando = 0; // Resultado de la verificacion
+        int primer_tick_asignando = -1, partidas = 1; // Primer tick que fallo y partidas jugadas
+
+        for (int t = 0; t < FPS + ticks; t++) { // Un segundo de calentamiento y los ticks pedidos
+                if (partida.estado == GAME_OVER) iniciarEstadoPartida(partida, ancho, alto, 1, semilla + partidas++); // El piloto murio: nueva partida
+                unsigned char entradas[MAX_JUGADORES] = {(unsigned char)(ENTRADA_DISPARO | ENTRADA_IZQUIERDA | (((int)(t / FPS) % 2) ? ENTRADA_ACELERAR : 0)), 0}; // Dispara girando y acelera a intervalos
+                bool medir = t >= FPS && partida.estado == JUGANDO; // Solo el tick estable de juego
+
+                leerContadoresMemoria(memoria.base); // El tick empieza aqui
+                {
+                        ZonaMemoria zona(MEM_SIMULACION); // Mismo etiquetado que en la partida real
+                        simularTick(partida, campo, entradas, &particulas, true); // Sin muestras cargadas no suena nada
+                        actualizarParticulas(particulas); // Como en el bucle de juego
+                }
+                cerrarFrameMemoria(memoria, partida.estado); // Deltas del tick
+
+                if (!medir) continue; // Calentamiento, transiciones y game over no cuentan
+                ticks_medidos++; // Tick JUGANDO verificado
+                if (asignacionesFrame(memoria) == 0) continue; // Tick correcto
+                ticks_asignando++; // Tick que toco el heap
+                if (primer_tick_asignando < 0) primer_tick_asignando = t; // Recuerda el primero
+                for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) asignaciones_por_etiqueta[i] += memoria.frame[i].asignaciones; // Acumula por etiqueta
+        }
+
+        printf("Verificacion de asignaciones: %ld ticks JUGANDO medidos en %d partidas, %ld con asignaciones\n", ticks_medidos, partidas, ticks_asignando); // Resultado global
+        if (ticks_asignando == 0) { // Objetivo cumplido
+                printf("OK: el tick estable no asigna memoria\n"); // Verificacion superada
+                return 0; // Exito
+        }
+        printf("FALLO: primer tick con asignaciones %d\n", primer_tick_asignando); // Punto de partida para investigar
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) { // Detalle por etiqueta
+                if (asignaciones_por_etiqueta[i] > 0) printf("  %s: %lld asignaciones\n", NOMBRES_ETIQUETAS_MEMORIA[i], asignaciones_por_etiqueta[i]); // Subsistema responsable
+        }
+        return 1; // La verificacion falla
 }
@@ -0,0 +1,174 @@
+/*
+ * LOTE.H
+ * ------
+ * Simulacion por lotes sin ventana para ajustar el equilibrio: miles de partidas
+ * jugadas por un piloto automatico, repartidas entre todos los nucleos
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cmath> // atan2 y remainder para apuntar
+#include <cstdio> // printf para el resumen
+#include <chrono> // Reloj del rendimiento del lote
+#include <fstream> // CSV de resultados
+#include <thread> // Un hilo por nucleo
+#include <vector> // Resultados y estados por hilo
+#include <algorithm> // sort para los percentiles
+#include "simulacion.h" // Estado de la partida y tick determinista
+#include "opciones.h" // Parametros del lote desde la linea de comandos
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== PILOTO AUTOMATICO ==========
+
+struct ParametrosBot {
+        float tolerancia_apuntado; // Radianes de error con los que el bot dispara
+        float radio_esquiva; // Distancia a la que un seeker hace huir al bot
+};
+
+// Apunta al enemigo mas cercano y huye de los seekers que se acercan demasiado.
+// Solo lee el estado, asi que varios hilos pueden pilotar sus propias partidas a la vez
+unsigned char pilotarBot(const EstadoPartida& e, int j, const ParametrosBot& bot) {
+        const Nave& nave = e.jugadores[j]; // Nave controlada
+        if (!nave.activo || e.estado != JUGANDO) return 0; // Nada que hacer fuera del juego
+
+        const Nave* cercano = nullptr; // Enemigo mas proximo
+        const Nave* amenaza = nullptr; // Seeker dentro del radio de esquiva
+        float d_cercano = 1e30f; // Distancia al cuadrado al enemigo mas proximo
+        float d_amenaza = bot.radio_esquiva * bot.radio_esquiva; // Solo cuentan los seekers dentro del radio
+        for (PtrNave n = e.enemigos; n != nullptr; n = n->siguiente) { // Recorre los enemigos
+                if (!n->activo) continue; // Ignora los destruidos
+                float dx = n->x - nave.x, dy = n->y - nave.y; // Vector hacia el enemigo
+                float d = dx * dx + dy * dy; // Distancia al cuadrado
+                if (d < d_cercano) { d_cercano = d; cercano = n; } // Nuevo objetivo
+                if (n->tipo == 2 && d < d_amenaza) { d_amenaza = d; amenaza = n; } // Seeker mas peligroso
+        }
+
+        unsigned char entrada = 0; // Teclas de este tick
+        float deseado; // Angulo al que se quiere orientar la nave (0 = arriba, como ang)
+        if (amenaza) { // Huye en direccion opuesta al seeker
+                deseado = atan2(nave.x - amenaza->x, amenaza->y - nave.y); // Direccion de escape
+                entrada |= ENTRADA_ACELERAR; // Impulso para alejarse
+        } else if (cercano) { // Apunta al enemigo mas cercano
+                float t = sqrt(d_cercano) / VELOCIDAD_BALA; // Frames que tarda la bala en llegar
+                float px = cercano->x + (cercano->tipo == 1 ? cercano->vx * t : 0.0f); // Los drones se mueven en linea recta: se adelanta el tiro
+                float py = cercano->y + (cercano->tipo == 1 ? cercano->vy * t : 0.0f); // Posicion prevista en Y
+                deseado = atan2(px - nave.x, nave.y - py); // Direccion hacia la posicion prevista
+        } else {
+                return 0; // Sin enemigos: espera la siguiente oleada
+        }
+
+        float diferencia = (float)remainder(deseado - nave.ang, 2.0 * 3.14159265358979); // Error angular en [-pi, pi]
+        if (diferencia > ROTACION * 0.5f) entrada |= ENTRADA_DERECHA; // Gira en sentido horario
+        else if (diferencia < -ROTACION * 0.5f) entrada |= ENTRADA_IZQUIERDA; // Gira en sentido antihorario
+        if (!amenaza && fabs(diferencia) < bot.tolerancia_apuntado) entrada |= ENTRADA_DISPARO; // Dispara cuando esta alineado
+        if (!amenaza && fabs(diferencia) < 0.5f && d_cercano > bot.radio_esquiva * bot.radio_esquiva * 4.0f) entrada |= ENTRADA_ACELERAR; // Se acerca a los objetivos lejanos para acortar el vuelo de la bala
+        return entrada; // Entrada compacta del tick
+}
+
+// ========== PARTIDAS ==========
+
+// Juega una partida completa hasta el game over (o el limite de ticks) y devuelve sus estadisticas
+Estadistica jugarPartidaBot(EstadoPartida& e, CampoFlujo& campo, unsigned int semilla, const ParametrosBalance& balance, const ParametrosBot& bot, int max_ticks) {
+        iniciarEstadoPartida(e, ANCHO_SIN_VENTANA, ALTO_SIN_VENTANA, 1, semilla, balance); // Partida nueva con su propia semilla
+        while (e.estado != GAME_OVER && e.tick < max_ticks) { // Hasta perder o agotar el limite
+                unsigned char entradas[MAX_JUGADORES] = {pilotarBot(e, 0, bot), 0}; // Un unico jugador
+                simularTick(e, campo, entradas, NULL, false); // Sin particulas ni sonido
+        }
+
+        Estadistica s; // Mismos campos que las partidas reales
+        s.puntuacion = e.puntos; // Puntuacion final
+        s.tiempo = e.tiempo; // Tiempo jugado
+        s.ronda = e.ronda; // Ronda alcanzada
+        s.enemigos_eliminados = e.kills; // Enemigos destruidos
+        s.proyectiles_disparados = e.proyectiles; // Disparos realizados
+        return s; // Resultado de la partida
+}
+
+unsigned int semillaPartidaLote(unsigned int semilla_base, int partida) {
+        return semilla_base + (unsigned int)partida * 2654435761u; // Semillas separadas para no correlacionar el generador
+}
+
+// Cada hilo juega las partidas hilo, hilo + n, hilo + 2n... con su propio estado y campo de flujo;
+// solo escribe en sus propias posiciones de los resultados, sin nada compartido que sincronizar
+void hiloLote(int hilo, int num_hilos, int total, unsigned int semilla_base, ParametrosBalance balance, ParametrosBot bot, int max_ticks, Estadistica* resultados, int* ticks) {
+        vector<EstadoPartida> estado(1); // Unos 50 KB por hilo, fuera de la pila
+        CampoFlujo campo; // Rejilla propia del hilo
+        iniciarCampoFlujo(campo, ANCHO_SIN_VENTANA, ALTO_SIN_VENTANA); // Reserva una sola vez por hilo
+
+        for (int i = hilo; i < total; i += num_hilos) { // Reparto intercalado: equilibra partidas largas y cortas
+                resultados[i] = jugarPartidaBot(estado[0], campo, semillaPartidaLote(semilla_base, i), balance, bot, max_ticks); // Juega la partida
+                ticks[i] = estado[0].tick; // Ticks simulados para medir el rendimiento
+        }
+}
+
+// ========== RESUMEN ==========
+
+template <class T>
+void imprimirDistribucion(const char* nombre, vector<T> valores) {
+        sort(valores.begin(), valores.end()); // Ordena una copia para los percentiles
+        double suma = 0.0; // Para la media
+        for (size_t i = 0; i < valores.size(); i++) suma += (double)valores[i]; // Acumula
+        size_t n = valores.size(); // Cantidad de partidas
+        printf("  %-22s media %10.1f  p10 %10.1f  p50 %10.1f  p90 %10.1f  max %10.1f\n", nombre, suma / n, (double)valores[n / 10], (double)valores[n / 2], (double)valores[(n * 9) / 10], (double)valores[n - 1]); // Una linea por campo
+}
+
+// ========== LOTE ==========
+
+// Ejecuta el lote configurado por linea de comandos y devuelve el codigo de salida del proceso
+int ejecutarLote() {
+        int total = opciones.simular_partidas; // Partidas a jugar
+        int num_hilos = opciones.hilos > 0 ? opciones.hilos : (int)thread::hardware_concurrency(); // Por defecto, un hilo por nucleo
+        if (num_hilos < 1) num_hilos = 1; // hardware_concurrency puede devolver 0
+        if (num_hilos > total) num_hilos = total; // No se lanzan hilos sin trabajo
+
+        ParametrosBalance balance = BALANCE_POR_DEFECTO; // Parte del equilibrio normal
+        if (opciones.enemigos_iniciales > 0) balance.enemigos_ronda_inicial = opciones.enemigos_iniciales; // Enemigos de la primera ronda
+        if (opciones.incremento_ronda > 0) balance.incremento_por_ronda = opciones.incremento_ronda; // Progresion por ronda
+        if (opciones.cadencia > 0.0f) balance.cadencia_disparo = opciones.cadencia; // Frames entre disparos
+        if (opciones.velocidad_seeker > 0.0f) balance.velocidad_seeker = opciones.velocidad_seeker; // Velocidad de los seekers
+        if (opciones.cupo_ia > 0) balance.cupo_ia = opciones.cupo_ia; // Decisiones de seekers por tick (fijo: el lote no depende del reloj)
+        ParametrosBot bot = {opciones.bot_apuntado, opciones.bot_esquiva}; // Comportamiento del piloto
+
+        printf("Simulando %d partidas en %d hilos (enemigos %d +%d/ronda, cadencia %.1f, seeker %.1f, ia %d, bot apuntado %.2f esquiva %.0f)\n", total, num_hilos, balance.enemigos_ronda_inicial, balance.incremento_por_ronda, balance.cadencia_disparo, balance.velocidad_seeker, balance.cupo_ia, bot.tolerancia_apuntado, bot.radio_esquiva); // Configuracion del lote
+
+        vector<Estadistica> resultados(total); // Una entrada por partida, escrita por un unico hilo
+        vector<int> ticks(total, 0); // Ticks de cada partida
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now(); // Comienzo del lote
+
+        vector<thread> hilos; // Trabajadores
+        for (int h = 0; h < num_hilos; h++) hilos.push_back(thread(hiloLote, h, num_hilos, total, opciones.semilla_lote, balance, bot, opciones.max_ticks, resultados.data(), ticks.data())); // Lanza cada hilo
+        for (size_t h = 0; h < hilos.size(); h++) hilos[h].join(); // Espera a que terminen todos
+
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count(); // Duracion del lote
+        long long ticks_totales = 0; // Ticks simulados en total
+        for (int i = 0; i < total; i++) ticks_totales += ticks[i]; // Acumula
+
+        ofstream csv(opciones.salida_lote); // Una fila por partida
+        if (!csv.is_open()) { // Sin archivo no hay resultados que guardar
+                printf("No se pudo escribir %s\n", opciones.salida_lote); // Informa del error
+                return 1; // Fallo
+        }
+        csv << "partida,semilla,puntuacion,tiempo,ronda,enemigos_eliminados,proyectiles_disparados,ticks\n"; // Mismos campos que Estadistica
+        for (int i = 0; i < total; i++) { // Vuelca cada partida
+                const Estadistica& s = resultados[i]; // Resultado de la partida
+                csv << i << "," << semillaPartidaLote(opciones.semilla_lote, i) << "," << s.puntuacion << "," << s.tiempo << "," << s.ronda << "," << s.enemigos_eliminados << "," << s.proyectiles_disparados << "," << ticks[i] << "\n"; // Fila de la partida
+        }
+
+        vector<int> puntuaciones(total), rondas(total), eliminados(total), disparos(total); // Columnas para las distribuciones
+        vector<float> tiempos(total); // Tiempo jugado
+        for (int i = 0; i < total; i++) { // Separa cada campo
+                puntuaciones[i] = resultados[i].puntuacion; // Puntuacion
+                tiempos[i] = resultados[i].tiempo; // Tiempo
+                rondas[i] = resultados[i].ronda; // Ronda
+                eliminados[i] = resultados[i].enemigos_eliminados; // Bajas
+                disparos[i] = resultados[i].proyectiles_disparados; // Disparos
+        }
+        printf("%d partidas en %.2f s: %.0f partidas/s, %.2f M ticks/s -> %s\n", total, segundos, total / segundos, ticks_totales / segundos / 1e6, opciones.salida_lote); // Rendimiento del lote
+        imprimirDistribucion("puntuacion", puntuaciones); // Distribucion de cada campo
+        imprimirDistribucion("tiempo (s)", tiempos); // Supervivencia
+        imprimirDistribucion("ronda", rondas); // Progreso
+        imprimirDistribucion("enemigos eliminados", eliminados); // Bajas
+        imprimirDistribucion("proyectiles disparados", disparos); // Disparos
+        return 0; // Exito
+}
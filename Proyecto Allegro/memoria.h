@@ -0,0 +1,192 @@
+/*
+ * MEMORIA.H
+ * ---------
+ * Instrumentacion opcional de asignaciones de memoria: cuenta asignaciones,
+ * liberaciones y bytes por frame y por subsistema. Se activa compilando con
+ * MEDIR_ASIGNACIONES (definido en las configuraciones Debug del proyecto)
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <atomic> // Contadores compartidos con el hilo de entrada
+#include <cstdlib> // malloc y free de la asignacion medida
+#include <new> // bad_alloc y nothrow_t
+#include <fstream> // Volcado CSV
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== ETIQUETAS ==========
+
+enum EtiquetaMemoria {
+        MEM_GENERAL, // Todo lo que no pertenece a un subsistema concreto
+        MEM_SIMULACION, // Tick de la partida
+        MEM_RENDER, // Dibujo del frame
+        MEM_INTERFAZ, // Entrada de nombre, menus y textos
+        MEM_PERSISTENCIA, // Lectura y escritura de estadisticas
+        MEM_ENTRADA, // Hilo de captura de teclado
+        MEM_CAPTURA, // Hilos de codificacion de capturas y clips
+        NUM_ETIQUETAS_MEMORIA // Cantidad de etiquetas
+};
+
+const char* const NOMBRES_ETIQUETAS_MEMORIA[NUM_ETIQUETAS_MEMORIA] = {"general", "simulacion", "render", "interfaz", "persistencia", "entrada", "captura"}; // Nombres para el panel y el CSV
+
+// ========== ESTRUCTURAS ==========
+
+struct ContadoresMemoria {
+        long long asignaciones; // Llamadas a new
+        long long liberaciones; // Llamadas a delete
+        long long bytes_asignados; // Bytes pedidos
+        long long bytes_liberados; // Bytes devueltos
+};
+
+struct MedidorMemoria {
+        ContadoresMemoria base[NUM_ETIQUETAS_MEMORIA]; // Totales acumulados al cerrar el frame anterior
+        ContadoresMemoria frame[NUM_ETIQUETAS_MEMORIA]; // Diferencia del ultimo frame cerrado
+        long frames; // Frames cerrados
+        long frames_con_asignaciones; // Frames en los que hubo al menos una asignacion
+        ofstream csv; // Volcado por frame (abierto solo si se pidio)
+};
+
+// ========== CONTADORES GLOBALES ==========
+
+atomic<long long> asignaciones_memoria[NUM_ETIQUETAS_MEMORIA]; // Totales acumulados por etiqueta (inicializados a cero estaticamente)
+atomic<long long> liberaciones_memoria[NUM_ETIQUETAS_MEMORIA]; // Liberaciones acumuladas por etiqueta
+atomic<long long> bytes_asignados_memoria[NUM_ETIQUETAS_MEMORIA]; // Bytes pedidos por etiqueta
+atomic<long long> bytes_liberados_memoria[NUM_ETIQUETAS_MEMORIA]; // Bytes devueltos por etiqueta
+thread_local int etiqueta_memoria = MEM_GENERAL; // Subsistema activo en cada hilo
+
+// Marca el subsistema activo mientras dure el bloque
+struct ZonaMemoria {
+        int anterior; // Etiqueta a restaurar al salir del bloque
+        explicit ZonaMemoria(EtiquetaMemoria etiqueta) : anterior(etiqueta_memoria) { etiqueta_memoria = etiqueta; } // Activa la etiqueta
+        ~ZonaMemoria() { etiqueta_memoria = anterior; } // Restaura la etiqueta previa
+};
+
+bool memoriaInstrumentada() {
+#ifdef MEDIR_ASIGNACIONES
+        return true; // Los contadores reflejan cada new y delete
+#else
+        return false; // Los contadores permanecen en cero
+#endif
+}
+
+// ========== OPERADORES GLOBALES ==========
+
+#ifdef MEDIR_ASIGNACIONES
+
+const size_t CABECERA_MEMORIA = 16; // Bytes reservados delante de cada bloque (mantiene la alineacion de malloc)
+
+void* asignarMedido(size_t bytes) {
+        char* bloque = (char*)malloc(bytes + CABECERA_MEMORIA); // Bloque real con espacio para la cabecera
+        if (!bloque) return NULL; // El llamador decide si lanza bad_alloc
+        int etiqueta = etiqueta_memoria; // Subsistema que pide la memoria
+        *(size_t*)bloque = bytes; // Tamano pedido, necesario al liberar
+        *(int*)(bloque + sizeof(size_t)) = etiqueta; // La liberacion se atribuye a quien asigno
+        asignaciones_memoria[etiqueta].fetch_add(1, memory_order_relaxed); // Cuenta la asignacion
+        bytes_asignados_memoria[etiqueta].fetch_add((long long)bytes, memory_order_relaxed); // Suma los bytes
+        return bloque + CABECERA_MEMORIA; // Memoria visible para el llamador
+}
+
+void liberarMedido(void* puntero) {
+        if (!puntero) return; // delete de NULL no hace nada
+        char* bloque = (char*)puntero - CABECERA_MEMORIA; // Inicio real del bloque
+        size_t bytes = *(size_t*)bloque; // Tamano registrado al asignar
+        int etiqueta = *(int*)(bloque + sizeof(size_t)); // Subsistema que lo asigno
+        liberaciones_memoria[etiqueta].fetch_add(1, memory_order_relaxed); // Cuenta la liberacion
+        bytes_liberados_memoria[etiqueta].fetch_add((long long)bytes, memory_order_relaxed); // Suma los bytes devueltos
+        free(bloque); // Devuelve el bloque completo
+}
+
+void* operator new(size_t bytes) {
+        void* p = asignarMedido(bytes); // Asignacion contada
+        if (!p) throw bad_alloc(); // Mismo contrato que el operador estandar
+        return p; // Memoria asignada
+}
+
+void* operator new[](size_t bytes) {
+        void* p = asignarMedido(bytes); // Asignacion contada
+        if (!p) throw bad_alloc(); // Mismo contrato que el operador estandar
+        return p; // Memoria asignada
+}
+
+void* operator new(size_t bytes, const nothrow_t&) noexcept { return asignarMedido(bytes); } // Variante sin excepciones
+void* operator new[](size_t bytes, const nothrow_t&) noexcept { return asignarMedido(bytes); } // Variante sin excepciones de arreglos
+void operator delete(void* p) noexcept { liberarMedido(p); } // Liberacion contada
+void operator delete[](void* p) noexcept { liberarMedido(p); } // Liberacion contada de arreglos
+void operator delete(void* p, size_t) noexcept { liberarMedido(p); } // Variante con tamano
+void operator delete[](void* p, size_t) noexcept { liberarMedido(p); } // Variante con tamano de arreglos
+void operator delete(void* p, const nothrow_t&) noexcept { liberarMedido(p); } // Variante sin excepciones
+void operator delete[](void* p, const nothrow_t&) noexcept { liberarMedido(p); } // Variante sin excepciones de arreglos
+
+#endif
+
+// ========== MEDICION POR FRAME ==========
+
+void leerContadoresMemoria(ContadoresMemoria* totales) {
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) { // Copia cada etiqueta
+                totales[i].asignaciones = asignaciones_memoria[i].load(memory_order_relaxed); // Asignaciones acumuladas
+                totales[i].liberaciones = liberaciones_memoria[i].load(memory_order_relaxed); // Liberaciones acumuladas
+                totales[i].bytes_asignados = bytes_asignados_memoria[i].load(memory_order_relaxed); // Bytes pedidos
+                totales[i].bytes_liberados = bytes_liberados_memoria[i].load(memory_order_relaxed); // Bytes devueltos
+        }
+}
+
+// Solo una etiqueta: no cuenta lo que asignan a la vez otros hilos (entrada, captura)
+long long asignacionesEtiqueta(int etiqueta) {
+        return asignaciones_memoria[etiqueta].load(memory_order_relaxed); // Asignaciones desde el inicio del programa
+}
+
+void iniciarMedidorMemoria(MedidorMemoria& m, const char* ruta_csv) {
+        leerContadoresMemoria(m.base); // Lo asignado antes de empezar no cuenta para el primer frame
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) m.frame[i] = ContadoresMemoria(); // Sin frame cerrado
+        m.frames = 0; // Sin frames
+        m.frames_con_asignaciones = 0; // Sin asignaciones
+        if (ruta_csv) { // Volcado solicitado
+                m.csv.open(ruta_csv); // Sobrescribe el archivo anterior
+                if (m.csv.is_open()) { // Cabecera con una columna por etiqueta
+                        m.csv << "frame,estado,asignaciones,liberaciones,bytes"; // Totales del frame
+                        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) m.csv << "," << NOMBRES_ETIQUETAS_MEMORIA[i] << "_asig," << NOMBRES_ETIQUETAS_MEMORIA[i] << "_bytes"; // Detalle por etiqueta
+                        m.csv << "\n"; // Fin de la cabecera
+                }
+        }
+}
+
+int asignacionesFrame(const MedidorMemoria& m) {
+        int total = 0; // Suma de todas las etiquetas
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) total += (int)m.frame[i].asignaciones; // Acumula
+        return total; // Asignaciones del ultimo frame
+}
+
+long long bytesFrame(const MedidorMemoria& m) {
+        long long total = 0; // Suma de todas las etiquetas
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) total += m.frame[i].bytes_asignados; // Acumula
+        return total; // Bytes pedidos en el ultimo frame
+}
+
+// Cierra el frame actual: calcula lo ocurrido desde el cierre anterior y lo vuelca al CSV
+void cerrarFrameMemoria(MedidorMemoria& m, int estado) {
+        ContadoresMemoria ahora[NUM_ETIQUETAS_MEMORIA]; // Totales en este instante
+        leerContadoresMemoria(ahora); // Lectura sin asignar memoria
+
+        long long asig = 0, lib = 0, bytes = 0; // Totales del frame
+        for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) { // Diferencia por etiqueta
+                m.frame[i].asignaciones = ahora[i].asignaciones - m.base[i].asignaciones; // Asignaciones del frame
+                m.frame[i].liberaciones = ahora[i].liberaciones - m.base[i].liberaciones; // Liberaciones del frame
+                m.frame[i].bytes_asignados = ahora[i].bytes_asignados - m.base[i].bytes_asignados; // Bytes pedidos en el frame
+                m.frame[i].bytes_liberados = ahora[i].bytes_liberados - m.base[i].bytes_liberados; // Bytes devueltos en el frame
+                asig += m.frame[i].asignaciones; // Acumula los totales
+                lib += m.frame[i].liberaciones; // Liberaciones totales
+                bytes += m.frame[i].bytes_asignados; // Bytes totales
+                m.base[i] = ahora[i]; // El siguiente frame parte de aqui
+        }
+
+        m.frames++; // Cuenta el frame
+        if (asig > 0) m.frames_con_asignaciones++; // Frame con asignaciones
+
+        if (m.csv.is_open()) { // Una fila por frame
+                m.csv << m.frames << "," << estado << "," << asig << "," << lib << "," << bytes; // Totales
+                for (int i = 0; i < NUM_ETIQUETAS_MEMORIA; i++) m.csv << "," << m.frame[i].asignaciones << "," << m.frame[i].bytes_asignados; // Detalle por etiqueta
+                m.csv << "\n"; // Fin de la fila
+                leerContadoresMemoria(m.base); // El propio volcado no se atribuye al frame siguiente
+        }
+}
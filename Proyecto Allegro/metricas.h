@@ -0,0 +1,299 @@
+/*
+ * METRICAS.H
+ * ----------
+ * Metricas en vivo para la supervision externa: el juego publica cada tick un bloque
+ * versionado en memoria compartida con semantica de seqlock (sin bloqueos ni llamadas
+ * al sistema en el camino caliente) y --metricas lo lee desde otro proceso
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Evita que windows.h defina las macros min y max
+#endif
+#include <windows.h> // CreateFileMapping y MapViewOfFile con nombre
+#else
+#include <sys/mman.h> // shm_open, mmap y munmap
+#include <sys/stat.h> // Permisos del segmento
+#include <fcntl.h> // O_CREAT y O_RDWR
+#include <unistd.h> // ftruncate, close y getpid
+#endif
+
+#include <atomic> // Contador de secuencia del seqlock
+#include <chrono> // Intervalo de lectura del lector
+#include <cstdint> // Enteros de tamano fijo del bloque compartido
+#include <cstdio> // printf y snprintf
+#include <cstring> // memcpy
+#include <new> // new de colocacion sobre la memoria compartida
+#include <thread> // sleep_for y yield del lector
+#include "opciones.h" // Jugador del cooperativo (un segmento por instancia)
+#include "simulacion.h" // Estado de la partida que se publica
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const uint32_t MAGIA_METRICAS = 0x544D4F56; // "VOMT" en little endian
+const uint32_t VERSION_METRICAS = 1; // Cambia si cambia DatosMetricas
+const int INTENTOS_LECTURA_METRICAS = 1000; // Lecturas interrumpidas por el escritor antes de rendirse
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "El seqlock necesita un contador atomico sin bloqueos para compartirlo entre procesos"); // Un atomico con bloqueo interno no funcionaria entre procesos
+
+enum AplicacionMetricas {
+        MET_MENU, // Menu principal (mismo orden que EstadoApp)
+        MET_JUGANDO, // Dentro del gameplay
+        MET_PUNTUACIONES // Pantalla de high scores
+};
+
+const char* const NOMBRES_APLICACION_METRICAS[] = {"menu", "jugando", "puntuaciones"}; // Texto del lector
+const char* const NOMBRES_ESTADO_METRICAS[] = {"JUGANDO", "CAMBIO_RONDA", "GAME_OVER", "INPUT_NOMBRE"}; // Texto de EstadoJuego
+
+// ========== ESTRUCTURAS ==========
+
+// Bloque que se publica; solo tipos de tamano fijo para que lector y juego coincidan
+struct DatosMetricas {
+        double marca; // al_get_time del ultimo muestreo
+        int32_t activo; // 1 mientras el juego corre, 0 al cerrarse
+        int32_t pid; // Proceso que publica
+        int32_t aplicacion; // AplicacionMetricas
+        int32_t estado; // EstadoJuego de la partida (-1 = fuera de partida)
+        int32_t tick; // Tick de la partida
+        int32_t ronda; // Ronda actual
+        int32_t puntos; // Puntuacion acumulada
+        int32_t enemigos; // Enemigos en uso del pool
+        int32_t balas; // Balas en uso del pool
+        int32_t particulas; // Particulas vivas
+        int32_t jugadores_vivos; // Naves de jugador activas
+        float fps; // Frames presentados en el ultimo segundo
+        float us_tick; // Microsegundos de la ultima simulacion
+        float us_render; // Microsegundos del ultimo frame dibujado
+        int32_t voces_en_uso; // Voces de audio ocupadas (musica incluida)
+        int32_t voces_max; // Voces reservadas
+        int64_t voces_rechazadas; // Efectos que no sonaron por falta de voces
+        int64_t frames; // Frames presentados desde el arranque
+        int64_t publicaciones; // Veces que se escribio el bloque
+};
+
+// Cabecera fija y datos protegidos por la secuencia: impar mientras el escritor copia
+struct SegmentoMetricas {
+        uint32_t magia; // MAGIA_METRICAS
+        uint32_t version; // VERSION_METRICAS
+        uint32_t tamano; // sizeof(SegmentoMetricas) del escritor
+        atomic<uint32_t> secuencia; // Seqlock: par = datos estables
+        DatosMetricas datos; // Ultima publicacion
+};
+
+struct PublicadorMetricas {
+        SegmentoMetricas* segmento; // Segmento proyectado (NULL = sin metricas)
+        DatosMetricas datos; // Copia local que se rellena antes de publicar
+        double inicio_ventana; // Comienzo de la ventana de FPS
+        int frames_ventana; // Frames presentados en la ventana
+        char nombre[64]; // Nombre del segmento
+#ifdef _WIN32
+        HANDLE mapeo; // Objeto de proyeccion con nombre
+#endif
+};
+
+PublicadorMetricas metricas; // Publicador unico del proceso
+
+// ========== SEGMENTO ==========
+
+// Cada instancia del cooperativo publica en su propio segmento
+void nombreSegmentoMetricas(char* nombre, size_t capacidad) {
+#ifdef _WIN32
+        snprintf(nombre, capacidad, "Local\\VectorOnslaughtMetricas%s", opciones.coop == 1 ? "2" : ""); // Objeto con nombre de la sesion
+#else
+        snprintf(nombre, capacidad, "/vector_onslaught_metricas%s", opciones.coop == 1 ? "_2" : ""); // Segmento de /dev/shm
+#endif
+}
+
+// Crea (o reutiliza tras un cierre abrupto) el segmento y lo deja listo para publicar
+bool abrirMetricas(PublicadorMetricas& p) {
+        memset(&p.datos, 0, sizeof(p.datos)); // Sin publicaciones
+        p.segmento = NULL; // Sin segmento hasta proyectarlo
+        p.inicio_ventana = 0.0; // La primera ventana empieza con el primer frame
+        p.frames_ventana = 0; // Sin frames
+        nombreSegmentoMetricas(p.nombre, sizeof(p.nombre)); // Nombre segun la instancia
+        void* memoria = NULL; // Proyeccion del segmento
+#ifdef _WIN32
+        p.mapeo = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)sizeof(SegmentoMetricas), p.nombre); // Memoria respaldada por el archivo de paginacion
+        if (!p.mapeo) return false; // Sin metricas
+        memoria = MapViewOfFile(p.mapeo, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SegmentoMetricas)); // Proyeccion de escritura
+        if (!memoria) {
+                CloseHandle(p.mapeo); // Libera el objeto
+                return false; // Sin metricas
+        }
+#else
+        int fd = shm_open(p.nombre, O_CREAT | O_RDWR, 0644); // El agente lo lee sin poder escribirlo
+        if (fd < 0) return false; // Sin metricas
+        if (ftruncate(fd, sizeof(SegmentoMetricas)) != 0) {
+                close(fd); // Libera el descriptor
+                return false; // Sin metricas
+        }
+        memoria = mmap(NULL, sizeof(SegmentoMetricas), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); // Proyeccion compartida
+        close(fd); // La proyeccion se mantiene sin el descriptor
+        if (memoria == MAP_FAILED) return false; // Sin metricas
+#endif
+        p.segmento = new (memoria) SegmentoMetricas; // Construye el contador atomico sobre la memoria compartida
+        p.segmento->secuencia.store(0, memory_order_relaxed); // Sin datos publicados todavia
+        p.segmento->magia = MAGIA_METRICAS; // Identificacion del formato
+        p.segmento->version = VERSION_METRICAS; // Version de DatosMetricas
+        p.segmento->tamano = (uint32_t)sizeof(SegmentoMetricas); // Comprobacion adicional del lector
+#ifdef _WIN32
+        p.datos.pid = (int32_t)GetCurrentProcessId(); // Proceso que publica
+#else
+        p.datos.pid = (int32_t)getpid(); // Proceso que publica
+#endif
+        p.datos.activo = 1; // El juego esta corriendo
+        p.datos.estado = -1; // Todavia fuera de partida
+        return true; // Listo para publicar
+}
+
+// Camino caliente: solo escrituras en memoria ya proyectada. La secuencia queda impar mientras
+// se copian los datos; un lector que la vea impar o cambiada descarta su copia y reintenta
+void publicarMetricas(PublicadorMetricas& p) {
+        if (!p.segmento) return; // Sin segmento
+        p.datos.publicaciones++; // Cuenta la publicacion
+        uint32_t secuencia = p.segmento->secuencia.load(memory_order_relaxed); // Solo este hilo escribe
+        p.segmento->secuencia.store(secuencia + 1, memory_order_relaxed); // Impar: escritura en curso
+        atomic_thread_fence(memory_order_release); // La marca impar se ve antes que cualquier dato nuevo
+        memcpy(&p.segmento->datos, &p.datos, sizeof(DatosMetricas)); // Copia el bloque completo
+        p.segmento->secuencia.store(secuencia + 2, memory_order_release); // Par: datos completos
+}
+
+// Publica el cierre para que el lector termine y elimina el segmento
+void cerrarMetricas(PublicadorMetricas& p) {
+        if (!p.segmento) return; // Nunca se abrio
+        p.datos.activo = 0; // El juego termina
+        publicarMetricas(p); // Ultima publicacion
+#ifdef _WIN32
+        UnmapViewOfFile(p.segmento); // Quita la proyeccion
+        CloseHandle(p.mapeo); // El objeto desaparece al cerrarlo el ultimo proceso
+#else
+        munmap(p.segmento, sizeof(SegmentoMetricas)); // Quita la proyeccion
+        shm_unlink(p.nombre); // Un lector que aun la tenga proyectada conserva su copia
+#endif
+        p.segmento = NULL; // Sin segmento
+}
+
+// ========== DATOS ==========
+
+// Cuenta un frame presentado y recalcula los FPS cada segundo
+void registrarFrameMetricas(PublicadorMetricas& p, double ahora) {
+        p.datos.frames++; // Frames desde el arranque
+        p.frames_ventana++; // Frames de la ventana actual
+        if (p.inicio_ventana <= 0.0) p.inicio_ventana = ahora; // Primera ventana
+        if (ahora - p.inicio_ventana >= 1.0) { // Ventana cumplida
+                p.datos.fps = (float)(p.frames_ventana / (ahora - p.inicio_ventana)); // Frames por segundo
+                p.inicio_ventana = ahora; // Nueva ventana
+                p.frames_ventana = 0; // Sin frames
+        }
+}
+
+// Copia al bloque local lo que se publica de la partida en curso
+void datosPartidaMetricas(PublicadorMetricas& p, const EstadoPartida& partida, int particulas, double us_tick, double us_render) {
+        DatosMetricas& d = p.datos; // Bloque local
+        d.aplicacion = MET_JUGANDO; // Dentro del gameplay
+        d.estado = (int32_t)partida.estado; // Fase de la partida
+        d.tick = partida.tick; // Tick simulado
+        d.ronda = partida.ronda; // Ronda actual
+        d.puntos = partida.puntos; // Puntuacion
+        d.enemigos = partida.pool_naves.en_uso; // Enemigos del pool
+        d.balas = partida.pool_balas.en_uso; // Balas del pool
+        d.particulas = particulas; // Particulas vivas
+        d.jugadores_vivos = 0; // Se recuentan
+        for (int j = 0; j < partida.num_jugadores; j++) if (partida.jugadores[j].activo) d.jugadores_vivos++; // Naves en juego
+        d.us_tick = (float)us_tick; // Coste de la simulacion
+        d.us_render = (float)us_render; // Coste del ultimo frame
+}
+
+// Voces del mezclador segun lo que registra tocarSonido
+void datosAudioMetricas(PublicadorMetricas& p, double ahora) {
+        p.datos.marca = ahora; // Momento del muestreo
+        p.datos.voces_en_uso = vocesEnUso(ahora); // Voces ocupadas
+        p.datos.voces_max = VOCES_AUDIO; // Voces reservadas
+        p.datos.voces_rechazadas = voces_rechazadas; // Efectos perdidos
+}
+
+// ========== LECTOR ==========
+
+// Copia consistente de los datos: se repite mientras el escritor este a mitad de una publicacion
+bool leerSegmentoMetricas(const SegmentoMetricas* s, DatosMetricas& datos, uint32_t& secuencia) {
+        for (int intento = 0; intento < INTENTOS_LECTURA_METRICAS; intento++) { // Reintentos acotados
+                uint32_t antes = s->secuencia.load(memory_order_acquire); // Secuencia al empezar
+                if (antes & 1) { // Escritura en curso
+                        this_thread::yield(); // Deja terminar al escritor
+                        continue; // Reintenta
+                }
+                memcpy(&datos, (const void*)&s->datos, sizeof(DatosMetricas)); // Copia que puede salir rota
+                atomic_thread_fence(memory_order_acquire); // La copia termina antes de volver a leer la secuencia
+                if (s->secuencia.load(memory_order_relaxed) == antes) { // Nadie escribio durante la copia
+                        secuencia = antes; // Version leida
+                        return true; // Copia valida
+                }
+        }
+        return false; // El escritor no dejo leer
+}
+
+// --metricas [ms]: proyecta el segmento en solo lectura e imprime una linea por muestreo con datos nuevos.
+// No necesita Allegro y nunca escribe en el segmento. Devuelve el codigo de salida del proceso
+int leerMetricasEnVivo(int intervalo_ms) {
+        char nombre[64]; // Segmento del juego
+        nombreSegmentoMetricas(nombre, sizeof(nombre)); // Mismo nombre que el publicador
+        const void* memoria = NULL; // Proyeccion de lectura
+#ifdef _WIN32
+        HANDLE mapeo = OpenFileMappingA(FILE_MAP_READ, FALSE, nombre); // Objeto creado por el juego
+        if (mapeo) memoria = MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, sizeof(SegmentoMetricas)); // Proyeccion de lectura
+#else
+        int fd = shm_open(nombre, O_RDONLY, 0); // Segmento creado por el juego
+        if (fd >= 0) {
+                void* m = mmap(NULL, sizeof(SegmentoMetricas), PROT_READ, MAP_SHARED, fd, 0); // Proyeccion de lectura
+                close(fd); // La proyeccion se mantiene sin el descriptor
+                if (m != MAP_FAILED) memoria = m; // Proyeccion valida
+        }
+#endif
+        if (!memoria) {
+                printf("No hay metricas publicadas en %s (el juego no esta corriendo)\n", nombre); // Sin segmento
+                return 1; // Error
+        }
+
+        const SegmentoMetricas* s = (const SegmentoMetricas*)memoria; // Bloque del juego
+        if (s->magia != MAGIA_METRICAS || s->version != VERSION_METRICAS || s->tamano != sizeof(SegmentoMetricas)) {
+                printf("Segmento %s con formato desconocido (version %u)\n", nombre, s->version); // Otra version del juego
+                return 1; // Error
+        }
+
+        printf("Metricas de %s cada %d ms (Ctrl+C para salir)\n", nombre, intervalo_ms); // Cabecera
+        uint32_t ultima = 0; // Ultima secuencia impresa (0 = nada publicado)
+        int codigo = 0; // Codigo de salida
+        while (true) { // Hasta que el juego se cierre
+                DatosMetricas d; // Copia consistente
+                uint32_t secuencia = 0; // Version leida
+                if (!leerSegmentoMetricas(s, d, secuencia)) {
+                        printf("El escritor no libero el segmento\n"); // Juego colgado a mitad de una publicacion
+                        codigo = 1; // Error
+                        break; // Termina
+                }
+                if (secuencia != ultima) { // Publicacion nueva
+                        ultima = secuencia; // La recuerda
+                        const char* aplicacion = (d.aplicacion >= MET_MENU && d.aplicacion <= MET_PUNTUACIONES) ? NOMBRES_APLICACION_METRICAS[d.aplicacion] : "?"; // Pantalla
+                        const char* estado = (d.estado >= JUGANDO && d.estado <= INPUT_NOMBRE) ? NOMBRES_ESTADO_METRICAS[d.estado] : "-"; // Fase de la partida
+                        printf("pid %d | %s %s | tick %d ronda %d puntos %d | enemigos %d balas %d particulas %d vivos %d | %.1f fps tick %.0f us render %.0f us | voces %d/%d (perdidas %lld) | frames %lld\n", (int)d.pid, aplicacion, estado, (int)d.tick, (int)d.ronda, (int)d.puntos, (int)d.enemigos, (int)d.balas, (int)d.particulas, (int)d.jugadores_vivos, d.fps, d.us_tick, d.us_render, (int)d.voces_en_uso, (int)d.voces_max, (long long)d.voces_rechazadas, (long long)d.frames); // Una linea por publicacion
+                        fflush(stdout); // Para agentes que leen la salida por tuberia
+                }
+                if (!d.activo && secuencia != 0) {
+                        printf("El juego se cerro\n"); // Ultima publicacion
+                        break; // Termina
+                }
+                this_thread::sleep_for(chrono::milliseconds(intervalo_ms)); // Espera al siguiente muestreo
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(memoria); // Quita la proyeccion
+        CloseHandle(mapeo); // Libera el objeto
+#else
+        munmap((void*)memoria, sizeof(SegmentoMetricas)); // Quita la proyeccion
+#endif
+        return codigo; // Codigo de salida
+}
@@ -0,0 +1,98 @@
+/*
+ * OPCIONES.H
+ * ----------
+ * Opciones de linea de comandos compartidas por todos los modulos
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cstring> // Comparacion de argumentos con strcmp
+#include <cstdlib> // atof y strtoul para los argumentos numericos
+
+// ========== ESTRUCTURAS ==========
+
+struct Opciones {
+        bool medir_latencia; // --latencia: mide la latencia entre la pulsacion y la presentacion del frame
+        float escala_min; // --escala-min X: escala minima de la escena (0-1)
+        float escala_max; // --escala-max X: escala maxima de la escena (0-1)
+        int coop; // --coop 1|2: jugador de esta instancia en el cooperativo local (-1 = solitario)
+        const char* archivo_asignaciones; // --asignaciones archivo.csv: vuelca las asignaciones de cada frame (NULL = sin volcado)
+        int verificar_asignaciones; // --verificar-asignaciones [ticks]: simula sin ventana y falla si un tick JUGANDO asigna memoria (0 = desactivado)
+        int simular_partidas; // --simular N: juega N partidas sin ventana con el piloto automatico (0 = desactivado)
+        int hilos; // --hilos N: hilos del lote (0 = uno por nucleo)
+        unsigned int semilla_lote; // --semilla S: semilla base del lote
+        int max_ticks; // --max-ticks N: limite de ticks por partida simulada
+        const char* salida_lote; // --salida archivo.csv: resultados por partida del lote
+        int enemigos_iniciales; // --enemigos-iniciales N: enemigos de la primera ronda (0 = valor del juego)
+        int incremento_ronda; // --incremento-ronda N: enemigos adicionales por ronda (0 = valor del juego)
+        float cadencia; // --cadencia F: frames entre disparos (0 = valor del juego)
+        float velocidad_seeker; // --velocidad-seeker F: pixeles por frame de los seekers (0 = valor del juego)
+        float bot_apuntado; // --bot-apuntado R: error en radianes con el que dispara el piloto
+        float bot_esquiva; // --bot-esquiva P: distancia a la que el piloto huye de un seeker
+        const char* convertir_telemetria; // --telemetria archivo.tlm [salida.csv]: convierte un volcado a CSV y lo resume (NULL = desactivado)
+        const char* salida_telemetria; // CSV de la conversion (NULL = junto al volcado)
+        const char* empaquetar; // --empaquetar [recursos.pak]: reune los recursos sueltos en un paquete y termina (NULL = desactivado)
+        int benchmark; // --benchmark [N]: mide el render de escenas fijas con N elementos sobre un bitmap en memoria (0 = desactivado)
+        int frames_benchmark; // --frames F: frames medidos por escena del benchmark
+        const char* capturas_benchmark; // --capturas carpeta: guarda un PNG por escena del benchmark (NULL = sin capturas)
+        int metricas_ms; // --metricas [ms]: lee las metricas en vivo del juego cada ms milisegundos (0 = desactivado)
+        float clip_segundos; // --clip-segundos S: segundos que conserva el anillo de clips (0 = sin clips)
+        float clip_fps; // --clip-fps F: cuadros por segundo del clip
+        float clip_escala; // --clip-escala X: escala de los cuadros del clip respecto a la pantalla (0-1)
+        int hilos_captura; // --hilos-captura N: hilos que codifican los PNG
+        int cupo_ia; // --cupo-ia N: seekers que deciden por tick (0 = valor del juego)
+        float presupuesto_ia; // --presupuesto-ia us: microsegundos por tick para las decisiones de la IA
+};
+
+Opciones opciones = {false, 0.5f, 1.0f, -1, NULL, 0, 0, 0, 1u, 108000, "simulacion.csv", 0, 0, 0.0f, 0.0f, 0.08f, 180.0f, NULL, NULL, NULL, 0, 120, NULL, 0, 5.0f, 10.0f, 0.33f, 2, 0, 150.0f}; // Opciones activas durante la ejecucion (valores por defecto)
+
+// ========== LECTURA ==========
+
+void leerOpciones(int argc, char** argv) {
+        for (int i = 1; i < argc; i++) { // Recorre cada argumento recibido
+                if (strcmp(argv[i], "--latencia") == 0) opciones.medir_latencia = true; // Activa el modo de medicion de latencia
+                else if (strcmp(argv[i], "--escala-min") == 0 && i + 1 < argc) opciones.escala_min = (float)atof(argv[++i]); // Limite inferior del escalado dinamico
+                else if (strcmp(argv[i], "--escala-max") == 0 && i + 1 < argc) opciones.escala_max = (float)atof(argv[++i]); // Limite superior del escalado dinamico
+                else if (strcmp(argv[i], "--coop") == 0 && i + 1 < argc) opciones.coop = (atoi(argv[++i]) == 2) ? 1 : 0; // Jugador 1 o 2 del cooperativo
+                else if (strcmp(argv[i], "--asignaciones") == 0 && i + 1 < argc) opciones.archivo_asignaciones = argv[++i]; // CSV con las asignaciones por frame
+                else if (strcmp(argv[i], "--verificar-asignaciones") == 0) { // Modo de prueba sin ventana
+                        opciones.verificar_asignaciones = 18000; // Cinco minutos de partida por defecto
+                        if (i + 1 < argc && atoi(argv[i + 1]) > 0) opciones.verificar_asignaciones = atoi(argv[++i]); // Cantidad de ticks opcional
+                }
+                else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) opciones.simular_partidas = atoi(argv[++i]); // Lote de partidas sin ventana
+                else if (strcmp(argv[i], "--hilos") == 0 && i + 1 < argc) opciones.hilos = atoi(argv[++i]); // Hilos del lote
+                else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) opciones.semilla_lote = (unsigned int)strtoul(argv[++i], NULL, 10); // Semilla base del lote
+                else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) opciones.max_ticks = atoi(argv[++i]); // Limite por partida
+                else if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) opciones.salida_lote = argv[++i]; // CSV del lote
+                else if (strcmp(argv[i], "--enemigos-iniciales") == 0 && i + 1 < argc) opciones.enemigos_iniciales = atoi(argv[++i]); // Equilibrio: primera ronda
+                else if (strcmp(argv[i], "--incremento-ronda") == 0 && i + 1 < argc) opciones.incremento_ronda = atoi(argv[++i]); // Equilibrio: progresion
+                else if (strcmp(argv[i], "--cadencia") == 0 && i + 1 < argc) opciones.cadencia = (float)atof(argv[++i]); // Equilibrio: disparo
+                else if (strcmp(argv[i], "--velocidad-seeker") == 0 && i + 1 < argc) opciones.velocidad_seeker = (float)atof(argv[++i]); // Equilibrio: seekers
+                else if (strcmp(argv[i], "--bot-apuntado") == 0 && i + 1 < argc) opciones.bot_apuntado = (float)atof(argv[++i]); // Precision del piloto
+                else if (strcmp(argv[i], "--bot-esquiva") == 0 && i + 1 < argc) opciones.bot_esquiva = (float)atof(argv[++i]); // Prudencia del piloto
+                else if (strcmp(argv[i], "--telemetria") == 0 && i + 1 < argc) { // Conversion de un volcado
+                        opciones.convertir_telemetria = argv[++i]; // Volcado a convertir
+                        if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) opciones.salida_telemetria = argv[++i]; // CSV de salida opcional
+                }
+                else if (strcmp(argv[i], "--benchmark") == 0) { // Benchmark del render sin ventana
+                        opciones.benchmark = 200; // Elementos por escena por defecto
+                        if (i + 1 < argc && atoi(argv[i + 1]) > 0) opciones.benchmark = atoi(argv[++i]); // Cantidad opcional
+                }
+                else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) opciones.frames_benchmark = atoi(argv[++i]); // Frames por escena
+                else if (strcmp(argv[i], "--capturas") == 0 && i + 1 < argc) opciones.capturas_benchmark = argv[++i]; // Carpeta de capturas
+                else if (strcmp(argv[i], "--clip-segundos") == 0 && i + 1 < argc) opciones.clip_segundos = (float)atof(argv[++i]); // Duracion del clip
+                else if (strcmp(argv[i], "--clip-fps") == 0 && i + 1 < argc) opciones.clip_fps = (float)atof(argv[++i]); // Cuadros por segundo del clip
+                else if (strcmp(argv[i], "--clip-escala") == 0 && i + 1 < argc) opciones.clip_escala = (float)atof(argv[++i]); // Resolucion del clip
+                else if (strcmp(argv[i], "--hilos-captura") == 0 && i + 1 < argc) opciones.hilos_captura = atoi(argv[++i]); // Hilos de codificacion
+                else if (strcmp(argv[i], "--cupo-ia") == 0 && i + 1 < argc) opciones.cupo_ia = atoi(argv[++i]); // Decisiones de seekers por tick
+                else if (strcmp(argv[i], "--presupuesto-ia") == 0 && i + 1 < argc) opciones.presupuesto_ia = (float)atof(argv[++i]); // Tiempo de IA por tick
+                else if (strcmp(argv[i], "--metricas") == 0) { // Lector de las metricas en vivo
+                        opciones.metricas_ms = 500; // Dos muestreos por segundo por defecto
+                        if (i + 1 < argc && atoi(argv[i + 1]) > 0) opciones.metricas_ms = atoi(argv[++i]); // Intervalo opcional
+                }
+                else if (strcmp(argv[i], "--empaquetar") == 0) { // Empaquetado de recursos
+                        opciones.empaquetar = "recursos.pak"; // Mismo nombre que busca el juego al arrancar
+                        if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) opciones.empaquetar = argv[++i]; // Paquete de salida opcional
+                }
+        }
+}
@@ -0,0 +1,328 @@
+/*
+ * PAQUETE.H
+ * ---------
+ * Paquete unico de recursos: un empaquetador que reune imagenes, musica y fuente
+ * en un archivo indexado, y una interfaz de archivo de Allegro de solo lectura que
+ * sirve cada recurso directamente desde el archivo proyectado en memoria
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Evita que windows.h defina las macros min y max
+#endif
+#include <windows.h> // CreateFileMapping y MapViewOfFile
+#else
+#include <sys/mman.h> // mmap y munmap
+#include <sys/stat.h> // fstat para el tamano del archivo
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#endif
+
+#include <cstdint> // Enteros de tamano fijo del formato
+#include <cstdio> // printf para el resumen del empaquetado
+#include <cstring> // strcmp, strrchr y memcpy
+#include <fstream> // Lectura de los recursos sueltos y escritura del paquete
+#include <vector> // Contenido de los recursos al empaquetar
+#include <allegro5/allegro.h> // ALLEGRO_FILE_INTERFACE y carga de bitmaps
+#include <allegro5/allegro_audio.h> // al_load_sample_f
+#include <allegro5/allegro_ttf.h> // al_load_ttf_font_f
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const char* const RUTA_PAQUETE = "recursos.pak"; // Paquete que se busca al arrancar
+const uint32_t MAGIA_PAQUETE = 0x4B504F56; // "VOPK" en little endian
+const uint32_t VERSION_PAQUETE = 1; // Cambia si cambia el formato
+const int LARGO_NOMBRE_PAQUETE = 48; // Bytes del nombre de cada entrada, terminador incluido
+const uint64_t ALINEACION_PAQUETE = 16; // Alineacion del contenido de cada recurso
+
+// Recursos que se empaquetan, con la misma ruta relativa con la que los pide el juego
+const char* const RECURSOS_PAQUETE[] = {
+        "MONSTER.ttf", // Fuente de toda la interfaz
+        "Imagenes/menu.png", // Fondo del menu
+        "Imagenes/gameplay.png", // Fondo de la partida
+        "Musica/Menu.ogg", // Musica del menu
+        "Musica/fight.ogg", // Musica de la partida
+        "Musica/shoot.wav", // Disparo
+        "Musica/enemyexp.wav", // Explosion de enemigo
+        "Musica/playerexp.flac" // Muerte del jugador
+};
+const int NUM_RECURSOS_PAQUETE = sizeof(RECURSOS_PAQUETE) / sizeof(RECURSOS_PAQUETE[0]); // Cantidad de recursos
+
+// ========== ESTRUCTURAS ==========
+
+// Formato: cabecera, tabla de entradas y contenido de cada recurso alineado a 16 bytes
+struct CabeceraPaquete {
+        uint32_t magia; // MAGIA_PAQUETE
+        uint32_t version; // VERSION_PAQUETE
+        uint32_t num_entradas; // Entradas de la tabla
+        uint32_t reservado; // Siempre cero
+};
+
+struct EntradaPaquete {
+        char nombre[LARGO_NOMBRE_PAQUETE]; // Ruta relativa del recurso
+        uint64_t desplazamiento; // Inicio del contenido desde el principio del paquete
+        uint64_t tamano; // Bytes del contenido
+};
+
+struct Paquete {
+        const unsigned char* datos; // Archivo completo proyectado en memoria (NULL = sin paquete)
+        size_t tamano; // Bytes proyectados
+        const EntradaPaquete* entradas; // Tabla dentro de la proyeccion
+        int num_entradas; // Entradas de la tabla
+};
+
+// Estado de cada ALLEGRO_FILE abierto sobre el paquete: solo una ventana y una posicion
+struct ArchivoPaquete {
+        const unsigned char* datos; // Contenido del recurso dentro de la proyeccion
+        int64_t tamano; // Bytes del recurso
+        int64_t posicion; // Cursor de lectura
+        bool fin; // Se intento leer mas alla del final
+};
+
+Paquete paquete_recursos = {NULL, 0, NULL, 0}; // Paquete abierto durante la ejecucion
+
+// ========== PROYECCION ==========
+
+void cerrarPaquete(Paquete& p) {
+        if (!p.datos) return; // Nada proyectado
+#ifdef _WIN32
+        UnmapViewOfFile(p.datos); // Libera la vista
+#else
+        munmap((void*)p.datos, p.tamano); // Libera la proyeccion
+#endif
+        p.datos = NULL; // Sin paquete
+        p.tamano = 0; // Sin bytes
+        p.entradas = NULL; // Sin tabla
+        p.num_entradas = 0; // Sin entradas
+}
+
+// Proyecta el paquete completo en memoria de solo lectura y valida su tabla. Devuelve false si
+// no existe o esta corrupto: el juego sigue cargando los recursos sueltos
+bool abrirPaquete(Paquete& p, const char* ruta) {
+        p.datos = NULL; // Sin paquete hasta validarlo
+#ifdef _WIN32
+        HANDLE archivo = CreateFileA(ruta, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL); // Archivo del paquete
+        if (archivo == INVALID_HANDLE_VALUE) return false; // No hay paquete
+        LARGE_INTEGER tamano; // Tamano del archivo
+        if (!GetFileSizeEx(archivo, &tamano) || tamano.QuadPart == 0) { CloseHandle(archivo); return false; } // Vacio o ilegible
+        HANDLE mapa = CreateFileMappingA(archivo, NULL, PAGE_READONLY, 0, 0, NULL); // Objeto de proyeccion
+        CloseHandle(archivo); // La proyeccion mantiene el archivo abierto
+        if (!mapa) return false; // No se pudo proyectar
+        const void* vista = MapViewOfFile(mapa, FILE_MAP_READ, 0, 0, 0); // Vista del archivo completo
+        CloseHandle(mapa); // La vista mantiene la proyeccion
+        if (!vista) return false; // No se pudo proyectar
+        p.datos = (const unsigned char*)vista; // Inicio del paquete
+        p.tamano = (size_t)tamano.QuadPart; // Bytes proyectados
+#else
+        int archivo = open(ruta, O_RDONLY); // Archivo del paquete
+        if (archivo < 0) return false; // No hay paquete
+        struct stat info; // Tamano del archivo
+        if (fstat(archivo, &info) != 0 || info.st_size == 0) { close(archivo); return false; } // Vacio o ilegible
+        void* vista = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, archivo, 0); // Proyeccion de solo lectura
+        close(archivo); // La proyeccion mantiene el archivo abierto
+        if (vista == MAP_FAILED) return false; // No se pudo proyectar
+        p.datos = (const unsigned char*)vista; // Inicio del paquete
+        p.tamano = (size_t)info.st_size; // Bytes proyectados
+#endif
+
+        const CabeceraPaquete* cabecera = (const CabeceraPaquete*)p.datos; // Cabecera al principio del archivo
+        bool valido = p.tamano >= sizeof(CabeceraPaquete) && cabecera->magia == MAGIA_PAQUETE && cabecera->version == VERSION_PAQUETE; // Formato conocido
+        if (valido) valido = cabecera->num_entradas <= (p.tamano - sizeof(CabeceraPaquete)) / sizeof(EntradaPaquete); // La tabla cabe en el archivo
+        if (valido) { // Cada entrada debe quedar dentro del archivo y tener un nombre terminado
+                p.entradas = (const EntradaPaquete*)(p.datos + sizeof(CabeceraPaquete)); // Tabla tras la cabecera
+                p.num_entradas = (int)cabecera->num_entradas; // Entradas de la tabla
+                for (int i = 0; i < p.num_entradas && valido; i++) { // Revisa cada entrada
+                        const EntradaPaquete& e = p.entradas[i]; // Entrada actual
+                        valido = memchr(e.nombre, 0, LARGO_NOMBRE_PAQUETE) != NULL && e.desplazamiento <= p.tamano && e.tamano <= p.tamano - e.desplazamiento; // Limites correctos
+                }
+        }
+        if (!valido) { // Paquete corrupto o de otra version
+                cerrarPaquete(p); // Se ignora por completo
+                return false; // Se usaran los recursos sueltos
+        }
+        return true; // Paquete listo
+}
+
+const EntradaPaquete* buscarEntradaPaquete(const Paquete& p, const char* ruta) {
+        for (int i = 0; i < p.num_entradas; i++) { // Pocas entradas: busqueda lineal
+                if (strcmp(p.entradas[i].nombre, ruta) == 0) return &p.entradas[i]; // Recurso encontrado
+        }
+        return NULL; // El recurso no esta en el paquete
+}
+
+// Acceso directo a los bytes de un recurso empaquetado, sin abrir un ALLEGRO_FILE
+bool datosRecurso(const Paquete& p, const char* ruta, const unsigned char** datos, size_t* tamano) {
+        const EntradaPaquete* e = buscarEntradaPaquete(p, ruta); // Entrada del recurso
+        if (!e) return false; // No empaquetado
+        *datos = p.datos + e->desplazamiento; // Contenido dentro de la proyeccion
+        *tamano = (size_t)e->tamano; // Bytes del recurso
+        return true; // Recurso disponible
+}
+
+// ========== INTERFAZ DE ARCHIVO ==========
+
+// Cada funcion trabaja sobre la ventana del recurso: leer es copiar desde la proyeccion, sin
+// llamadas al sistema; las paginas se cargan del disco solo cuando se tocan por primera vez
+
+void* abrirArchivoPaquete(const char* ruta, const char* modo) {
+        if (strpbrk(modo, "wa+")) return NULL; // El paquete es de solo lectura
+        const EntradaPaquete* e = buscarEntradaPaquete(paquete_recursos, ruta); // Entrada del recurso
+        if (!e) return NULL; // No empaquetado: al_fopen_interface devuelve NULL
+        ArchivoPaquete* a = new ArchivoPaquete(); // Solo el cursor, el contenido no se copia
+        a->datos = paquete_recursos.datos + e->desplazamiento; // Contenido dentro de la proyeccion
+        a->tamano = (int64_t)e->tamano; // Bytes del recurso
+        a->posicion = 0; // Al principio
+        a->fin = false; // Sin lecturas fallidas
+        return a; // Allegro lo guarda como userdata del ALLEGRO_FILE
+}
+
+bool cerrarArchivoPaquete(ALLEGRO_FILE* f) {
+        delete (ArchivoPaquete*)al_get_file_userdata(f); // La proyeccion sigue abierta para los demas
+        return true; // Siempre se cierra
+}
+
+size_t leerArchivoPaquete(ALLEGRO_FILE* f, void* destino, size_t bytes) {
+        ArchivoPaquete* a = (ArchivoPaquete*)al_get_file_userdata(f); // Estado del archivo
+        int64_t disponibles = a->tamano - a->posicion; // Bytes hasta el final
+        size_t n = (int64_t)bytes < disponibles ? bytes : (size_t)disponibles; // Lo que se puede servir
+        memcpy(destino, a->datos + a->posicion, n); // Copia desde la proyeccion
+        a->posicion += (int64_t)n; // Avanza el cursor
+        if (n < bytes) a->fin = true; // Lectura corta: fin del recurso
+        return n; // Bytes leidos
+}
+
+size_t escribirArchivoPaquete(ALLEGRO_FILE*, const void*, size_t) { return 0; } // Solo lectura
+bool vaciarArchivoPaquete(ALLEGRO_FILE*) { return true; } // Nada pendiente de escribir
+int64_t posicionArchivoPaquete(ALLEGRO_FILE* f) { return ((ArchivoPaquete*)al_get_file_userdata(f))->posicion; } // Cursor actual
+
+bool desplazarArchivoPaquete(ALLEGRO_FILE* f, int64_t desplazamiento, int origen) {
+        ArchivoPaquete* a = (ArchivoPaquete*)al_get_file_userdata(f); // Estado del archivo
+        int64_t base = origen == ALLEGRO_SEEK_CUR ? a->posicion : (origen == ALLEGRO_SEEK_END ? a->tamano : 0); // Referencia del desplazamiento
+        int64_t destino = base + desplazamiento; // Nueva posicion
+        if (destino < 0 || destino > a->tamano) return false; // Fuera del recurso
+        a->posicion = destino; // Mueve el cursor
+        a->fin = false; // Un desplazamiento limpia el fin de archivo
+        return true; // Desplazamiento valido
+}
+
+bool finArchivoPaquete(ALLEGRO_FILE* f) { return ((ArchivoPaquete*)al_get_file_userdata(f))->fin; } // Fin alcanzado
+int errorArchivoPaquete(ALLEGRO_FILE*) { return 0; } // La memoria no produce errores de lectura
+const char* mensajeErrorArchivoPaquete(ALLEGRO_FILE*) { return ""; } // Sin mensaje
+void limpiarErrorArchivoPaquete(ALLEGRO_FILE* f) { ((ArchivoPaquete*)al_get_file_userdata(f))->fin = false; } // Limpia el fin de archivo
+
+int devolverCaracterArchivoPaquete(ALLEGRO_FILE* f, int c) {
+        ArchivoPaquete* a = (ArchivoPaquete*)al_get_file_userdata(f); // Estado del archivo
+        if (a->posicion == 0) return -1; // Nada que devolver (EOF)
+        a->posicion--; // El contenido es inmutable: basta con retroceder
+        a->fin = false; // Vuelve a haber datos
+        return c; // Caracter devuelto
+}
+
+off_t tamanoArchivoPaquete(ALLEGRO_FILE* f) { return (off_t)((ArchivoPaquete*)al_get_file_userdata(f))->tamano; } // Bytes del recurso
+
+const ALLEGRO_FILE_INTERFACE INTERFAZ_PAQUETE = {
+        abrirArchivoPaquete, // fi_fopen
+        cerrarArchivoPaquete, // fi_fclose
+        leerArchivoPaquete, // fi_fread
+        escribirArchivoPaquete, // fi_fwrite
+        vaciarArchivoPaquete, // fi_fflush
+        posicionArchivoPaquete, // fi_ftell
+        desplazarArchivoPaquete, // fi_fseek
+        finArchivoPaquete, // fi_feof
+        errorArchivoPaquete, // fi_ferror
+        mensajeErrorArchivoPaquete, // fi_ferrmsg
+        limpiarErrorArchivoPaquete, // fi_fclearerr
+        devolverCaracterArchivoPaquete, // fi_fungetc
+        tamanoArchivoPaquete // fi_fsize
+};
+
+// ========== CARGA DE RECURSOS ==========
+
+// Abre un recurso desde el paquete si esta abierto y lo contiene; si no, desde el archivo suelto
+ALLEGRO_FILE* abrirRecurso(const char* ruta) {
+        if (paquete_recursos.datos) { // Hay paquete
+                ALLEGRO_FILE* f = al_fopen_interface(&INTERFAZ_PAQUETE, ruta, "rb"); // Servido desde la proyeccion
+                if (f) return f; // Empaquetado
+        }
+        return al_fopen(ruta, "rb"); // Archivo suelto
+}
+
+const char* extensionRecurso(const char* ruta) {
+        const char* punto = strrchr(ruta, '.'); // Ultimo punto de la ruta
+        return punto ? punto : ""; // Allegro elige el decodificador por la extension con el punto
+}
+
+ALLEGRO_BITMAP* cargarBitmapRecurso(const char* ruta) {
+        ALLEGRO_FILE* f = abrirRecurso(ruta); // Paquete o archivo suelto
+        if (!f) return NULL; // Recurso inexistente
+        ALLEGRO_BITMAP* bitmap = al_load_bitmap_f(f, extensionRecurso(ruta)); // Decodifica la imagen
+        al_fclose(f); // al_load_bitmap_f no cierra el archivo
+        return bitmap; // NULL si no se pudo decodificar
+}
+
+ALLEGRO_SAMPLE* cargarSampleRecurso(const char* ruta) {
+        ALLEGRO_FILE* f = abrirRecurso(ruta); // Paquete o archivo suelto
+        if (!f) return NULL; // Recurso inexistente
+        ALLEGRO_SAMPLE* sample = al_load_sample_f(f, extensionRecurso(ruta)); // Decodifica el audio completo
+        al_fclose(f); // al_load_sample_f no cierra el archivo
+        return sample; // NULL si no se pudo decodificar
+}
+
+// La fuente se queda con el archivo: FreeType vuelve a leer del TTF al rasterizar glifos nuevos
+ALLEGRO_FONT* cargarFuenteRecurso(const char* ruta, int tamano, int flags) {
+        ALLEGRO_FILE* f = abrirRecurso(ruta); // Paquete o archivo suelto
+        if (!f) return NULL; // Recurso inexistente
+        return al_load_ttf_font_f(f, ruta, tamano, flags); // Lo cierra al destruir la fuente (o al fallar)
+}
+
+// ========== EMPAQUETADO ==========
+
+// Reune los recursos sueltos en un unico paquete. Devuelve el codigo de salida del proceso
+int empaquetarRecursos(const char* ruta_salida) {
+        vector<EntradaPaquete> entradas; // Tabla del paquete
+        vector<vector<char> > contenidos; // Contenido de cada recurso encontrado
+        uint64_t desplazamiento = sizeof(CabeceraPaquete); // El contenido empieza tras la tabla (se ajusta despues)
+
+        for (int i = 0; i < NUM_RECURSOS_PAQUETE; i++) { // Cada recurso conocido
+                const char* ruta = RECURSOS_PAQUETE[i]; // Ruta relativa
+                if (strlen(ruta) >= (size_t)LARGO_NOMBRE_PAQUETE) { printf("Ruta demasiado larga: %s\n", ruta); return 1; } // No cabe en la entrada
+                ifstream archivo(ruta, ios::binary | ios::ate); // Abre al final para conocer el tamano
+                if (!archivo.is_open()) { printf("  (falta %s, se omite)\n", ruta); continue; } // El juego ya tolera recursos ausentes
+                vector<char> contenido((size_t)archivo.tellg()); // Reserva el tamano exacto
+                archivo.seekg(0); // Vuelve al principio
+                if (!contenido.empty() && !archivo.read(contenido.data(), (streamsize)contenido.size())) { printf("No se pudo leer %s\n", ruta); return 1; } // Lectura completa
+
+                EntradaPaquete e; // Entrada de la tabla
+                memset(&e, 0, sizeof(e)); // Nombre relleno con ceros
+                memcpy(e.nombre, ruta, strlen(ruta)); // Ruta tal como la pide el juego
+                e.tamano = contenido.size(); // Bytes del recurso
+                entradas.push_back(e); // Desplazamiento pendiente
+                contenidos.push_back(contenido); // Guarda el contenido
+        }
+
+        desplazamiento += entradas.size() * sizeof(EntradaPaquete); // Fin de la tabla
+        for (size_t i = 0; i < entradas.size(); i++) { // Coloca cada recurso tras el anterior
+                desplazamiento = (desplazamiento + ALINEACION_PAQUETE - 1) & ~(ALINEACION_PAQUETE - 1); // Alinea el inicio
+                entradas[i].desplazamiento = desplazamiento; // Posicion definitiva
+                desplazamiento += entradas[i].tamano; // Siguiente recurso
+        }
+
+        ofstream salida(ruta_salida, ios::binary); // Sobrescribe el paquete anterior
+        if (!salida.is_open()) { printf("No se pudo escribir %s\n", ruta_salida); return 1; } // Sin permisos
+        CabeceraPaquete cabecera = {MAGIA_PAQUETE, VERSION_PAQUETE, (uint32_t)entradas.size(), 0}; // Cabecera del formato
+        salida.write((const char*)&cabecera, sizeof(cabecera)); // Cabecera
+        if (!entradas.empty()) salida.write((const char*)entradas.data(), (streamsize)(entradas.size() * sizeof(EntradaPaquete))); // Tabla
+        const char relleno[ALINEACION_PAQUETE] = {0}; // Bytes de alineacion
+        for (size_t i = 0; i < entradas.size(); i++) { // Contenido de cada recurso
+                salida.write(relleno, (streamsize)(entradas[i].desplazamiento - (uint64_t)salida.tellp())); // Rellena hasta el inicio alineado
+                if (!contenidos[i].empty()) salida.write(contenidos[i].data(), (streamsize)contenidos[i].size()); // Contenido
+                printf("  %-24s %10llu bytes\n", entradas[i].nombre, (unsigned long long)entradas[i].tamano); // Detalle por recurso
+        }
+        if (!salida) { printf("Error al escribir %s\n", ruta_salida); return 1; } // Disco lleno u otro fallo
+        printf("%d recursos empaquetados en %s (%llu bytes)\n", (int)entradas.size(), ruta_salida, (unsigned long long)desplazamiento); // Resumen
+        return 0; // Exito
+}
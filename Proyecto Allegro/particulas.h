@@ -0,0 +1,166 @@
+/*
+ * PARTICULAS.H
+ * ------------
+ * Sistema de particulas para explosiones y estelas del propulsor
+ * (almacenamiento SoA preasignado, presupuesto fijo y un solo draw por frame)
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cmath> // Seno y coseno para repartir las particulas en circulo
+#include <vector> // Arreglos contiguos preasignados para cada atributo
+#include <allegro5/allegro.h> // Temporizacion de alta resolucion (al_get_time)
+#include <allegro5/allegro_primitives.h> // Dibujo por lotes mediante al_draw_prim
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const int MAX_PARTICULAS = 4096; // Presupuesto fijo de particulas vivas simultaneas
+const int MAX_EMISION_FRAME = 512; // Limite de particulas nuevas por frame
+const float ROZAMIENTO_PARTICULA = 0.94f; // Frenado aplicado a cada particula por frame
+const double PRESUPUESTO_PARTICULAS_MS = 0.5; // Tiempo maximo por frame que pueden consumir las particulas
+
+// ========== ESTRUCTURAS ==========
+
+struct SistemaParticulas {
+        vector<float> x, y; // Posiciones (una entrada por particula)
+        vector<float> vx, vy; // Velocidades
+        vector<float> vida; // Frames de vida restantes (0 = libre)
+        vector<float> inv_vida; // Inverso de la vida inicial para calcular el desvanecimiento
+        vector<float> r, g, b; // Color base de cada particula
+        vector<ALLEGRO_VERTEX> vertices; // Buffer de vertices reutilizado para el dibujo por lotes
+
+        int siguiente; // Ranura a ocupar en la proxima emision (la mas antigua del anillo)
+        unsigned int semilla; // Generador propio para no alterar el rand() del juego
+        int emitidas_frame; // Particulas emitidas en el frame actual
+        float escala_emision; // Factor 0..1 que reduce la emision cuando se excede el presupuesto
+
+        int vivas; // Particulas vivas tras la ultima integracion
+        long desalojadas; // Particulas vivas reemplazadas por falta de espacio
+        long descartadas; // Emisiones descartadas por el limite por frame
+        double ms_frame; // Coste del ultimo frame (integracion + dibujo)
+        double ms_maximo; // Peor coste registrado
+        double ms_integracion; // Coste de la ultima integracion, se suma al del dibujo
+};
+
+// ========== INICIALIZACION ==========
+
+void iniciarParticulas(SistemaParticulas& sp) {
+        sp.x.assign(MAX_PARTICULAS, 0.0f); // Reserva todas las posiciones X de una vez
+        sp.y.assign(MAX_PARTICULAS, 0.0f); // Reserva todas las posiciones Y
+        sp.vx.assign(MAX_PARTICULAS, 0.0f); // Reserva las velocidades X
+        sp.vy.assign(MAX_PARTICULAS, 0.0f); // Reserva las velocidades Y
+        sp.vida.assign(MAX_PARTICULAS, 0.0f); // Todas las ranuras comienzan libres
+        sp.inv_vida.assign(MAX_PARTICULAS, 0.0f); // Sin vida inicial asignada
+        sp.r.assign(MAX_PARTICULAS, 0.0f); // Reserva el canal rojo
+        sp.g.assign(MAX_PARTICULAS, 0.0f); // Reserva el canal verde
+        sp.b.assign(MAX_PARTICULAS, 0.0f); // Reserva el canal azul
+        sp.vertices.resize(MAX_PARTICULAS * 3); // Tres vertices por particula (un triangulo alargado)
+
+        sp.siguiente = 0; // El anillo empieza en la primera ranura
+        sp.semilla = 12345u; // Semilla fija, el aspecto de las explosiones no necesita variar entre partidas
+        sp.emitidas_frame = 0; // Nada emitido todavia
+        sp.escala_emision = 1.0f; // Emision completa mientras haya presupuesto
+        sp.vivas = 0; // No hay particulas vivas
+        sp.desalojadas = 0; // Reinicia las estadisticas
+        sp.descartadas = 0; // Sin emisiones descartadas
+        sp.ms_frame = 0.0; // Sin mediciones aun
+        sp.ms_maximo = 0.0; // Sin peor caso registrado
+        sp.ms_integracion = 0.0; // Sin integraciones medidas
+}
+
+// ========== EMISION ==========
+
+float aleatorioParticula(SistemaParticulas& sp) {
+        sp.semilla = sp.semilla * 1664525u + 1013904223u; // Generador congruencial lineal
+        return (sp.semilla >> 8) * (1.0f / 16777216.0f); // Valor uniforme en [0, 1)
+}
+
+void emitirParticula(SistemaParticulas& sp, float x, float y, float vx, float vy, float vida, float r, float g, float b) {
+        if (sp.emitidas_frame >= MAX_EMISION_FRAME) { sp.descartadas++; return; } // Respeta el limite de emision por frame
+        sp.emitidas_frame++; // Cuenta la emision
+
+        int i = sp.siguiente; // Ranura mas antigua del anillo
+        sp.siguiente = (sp.siguiente + 1) % MAX_PARTICULAS; // Avanza el anillo
+        if (sp.vida[i] > 0.0f) sp.desalojadas++; // Si seguia viva se desaloja la mas antigua
+
+        sp.x[i] = x; sp.y[i] = y; // Posicion inicial
+        sp.vx[i] = vx; sp.vy[i] = vy; // Velocidad inicial
+        sp.vida[i] = vida; // Frames de vida
+        sp.inv_vida[i] = 1.0f / vida; // Inverso precalculado para el desvanecimiento
+        sp.r[i] = r; sp.g[i] = g; sp.b[i] = b; // Color base
+}
+
+void emitirExplosion(SistemaParticulas& sp, float x, float y, int cantidad, float velocidad, float r, float g, float b) {
+        int total = (int)(cantidad * sp.escala_emision); // Reduce la cantidad si se esta excediendo el presupuesto
+        for (int i = 0; i < total; i++) { // Emite cada fragmento
+                float ang = aleatorioParticula(sp) * 6.2831853f; // Direccion aleatoria
+                float vel = velocidad * (0.3f + 0.7f * aleatorioParticula(sp)); // Rapidez aleatoria
+                float vida = 25.0f + 25.0f * aleatorioParticula(sp); // Vida entre 25 y 50 frames
+                emitirParticula(sp, x, y, cos(ang) * vel, sin(ang) * vel, vida, r, g, b); // Agrega el fragmento
+        }
+}
+
+void emitirEstela(SistemaParticulas& sp, float x, float y, float ang) {
+        int total = (int)(2 * sp.escala_emision + 0.5f); // Dos particulas por frame de propulsion
+        for (int i = 0; i < total; i++) { // Emite cada chispa
+                float dispersion = (aleatorioParticula(sp) - 0.5f) * 0.6f; // Apertura del cono de escape
+                float vel = 3.0f + 2.0f * aleatorioParticula(sp); // Rapidez de la chispa
+                float dx = -sin(ang + dispersion), dy = cos(ang + dispersion); // Direccion opuesta a la punta de la nave
+                emitirParticula(sp, x + dx * 22.0f, y + dy * 22.0f, dx * vel, dy * vel, 15.0f + 10.0f * aleatorioParticula(sp), 1.0f, 0.6f, 0.15f); // Chispa anaranjada en la cola
+        }
+}
+
+// ========== ACTUALIZACION Y DIBUJO ==========
+
+void actualizarParticulas(SistemaParticulas& sp) {
+        double inicio = al_get_time(); // Comienza a medir el coste de la integracion
+        sp.emitidas_frame = 0; // Reinicia el limite de emision del nuevo frame
+
+        float* px = &sp.x[0]; float* py = &sp.y[0]; // Punteros crudos para que el compilador vectorice
+        float* pvx = &sp.vx[0]; float* pvy = &sp.vy[0]; // Velocidades
+        float* pv = &sp.vida[0]; // Vidas restantes
+
+        for (int i = 0; i < MAX_PARTICULAS; i++) { // Bucle sin ramas sobre arreglos contiguos (vectorizable)
+                px[i] += pvx[i]; // Integra la posicion X
+                py[i] += pvy[i]; // Integra la posicion Y
+                pvx[i] *= ROZAMIENTO_PARTICULA; // Frena la velocidad X
+                pvy[i] *= ROZAMIENTO_PARTICULA; // Frena la velocidad Y
+                pv[i] = pv[i] > 1.0f ? pv[i] - 1.0f : 0.0f; // Consume vida sin bajar de cero
+        }
+
+        sp.ms_integracion = (al_get_time() - inicio) * 1000.0; // Guarda el coste para sumarlo al del dibujo
+}
+
+void dibujarParticulas(SistemaParticulas& sp) {
+        double inicio = al_get_time(); // Comienza a medir el coste del dibujo
+        int n = 0; // Vertices escritos en el buffer
+        for (int i = 0; i < MAX_PARTICULAS; i++) { // Compacta las particulas vivas en el buffer de vertices
+                if (sp.vida[i] <= 0.0f) continue; // Ranura libre
+                float a = sp.vida[i] * sp.inv_vida[i]; // Opacidad proporcional a la vida restante
+                ALLEGRO_COLOR c = {sp.r[i] * a, sp.g[i] * a, sp.b[i] * a, a}; // Color premultiplicado por alfa
+
+                float x = sp.x[i], y = sp.y[i], vx = sp.vx[i], vy = sp.vy[i]; // Copias locales de la particula
+                ALLEGRO_VERTEX* v = &sp.vertices[n]; // Siguiente triangulo del lote
+                v[0].x = x + vx * 2.0f; v[0].y = y + vy * 2.0f; // Punta alargada en la direccion del movimiento
+                v[1].x = x - vy * 0.5f; v[1].y = y + vx * 0.5f; // Base izquierda
+                v[2].x = x + vy * 0.5f; v[2].y = y - vx * 0.5f; // Base derecha
+                for (int k = 0; k < 3; k++) { v[k].z = 0.0f; v[k].u = 0.0f; v[k].v = 0.0f; v[k].color = c; } // Atributos comunes del triangulo
+                n += 3; // Avanza al siguiente triangulo
+        }
+
+        sp.vivas = n / 3; // Particulas realmente dibujadas
+        if (n > 0) al_draw_prim(&sp.vertices[0], NULL, NULL, 0, n, ALLEGRO_PRIM_TRIANGLE_LIST); // Una unica llamada de dibujo para todas las particulas
+
+        sp.ms_frame = sp.ms_integracion + (al_get_time() - inicio) * 1000.0; // Coste total del frame en milisegundos
+        if (sp.ms_frame > sp.ms_maximo) sp.ms_maximo = sp.ms_frame; // Registra el peor caso
+
+        if (sp.ms_frame > PRESUPUESTO_PARTICULAS_MS) { // Se excedio el presupuesto
+                sp.escala_emision *= 0.5f; // Reduce drasticamente la emision futura
+                if (sp.escala_emision < 0.1f) sp.escala_emision = 0.1f; // Mantiene un minimo visible
+        } else if (sp.escala_emision < 1.0f) { // Hay margen
+                sp.escala_emision += 0.02f; // Recupera la emision de forma gradual
+                if (sp.escala_emision > 1.0f) sp.escala_emision = 1.0f; // Sin superar la emision completa
+        }
+}
@@ -0,0 +1,91 @@
+/*
+ * PLANIFICADOR.H
+ * --------------
+ * Planificador de renderizado: solo se redibuja cuando algo cambio y
+ * se suspende la simulacion y el dibujo mientras la ventana no tiene el foco
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <allegro5/allegro.h> // Eventos de pantalla y temporizadores
+
+// ========== ESTRUCTURAS ==========
+
+struct PlanificadorRender {
+        bool sucio; // Hay cambios pendientes de presentar
+        bool suspendido; // La ventana perdio el foco o se minimizo
+        double inicio_suspension; // Instante en que comenzo la suspension actual
+        long frames_dibujados; // Frames realmente dibujados y presentados
+        long frames_omitidos; // Ticks en los que no hubo nada que redibujar
+        int suspensiones; // Veces que se suspendio la aplicacion
+        double segundos_suspendido; // Tiempo total pasado en suspension
+};
+
+// ========== INICIALIZACION ==========
+
+void iniciarPlanificador(PlanificadorRender& p) {
+        p.sucio = true; // El primer frame siempre se dibuja
+        p.suspendido = false; // Se comienza con la ventana activa
+        p.inicio_suspension = 0.0; // Sin suspension en curso
+        p.frames_dibujados = 0; // Reinicia los contadores
+        p.frames_omitidos = 0; // Sin ticks omitidos
+        p.suspensiones = 0; // Sin suspensiones
+        p.segundos_suspendido = 0.0; // Sin tiempo suspendido
+}
+
+// ========== CONTROL ==========
+
+void marcarSucio(PlanificadorRender& p) {
+        p.sucio = true; // El proximo tick debe redibujar
+}
+
+bool debeDibujar(PlanificadorRender& p) {
+        if (p.suspendido) return false; // Nada se dibuja sin foco
+        if (!p.sucio) { // La pantalla ya muestra el estado actual
+                p.frames_omitidos++; // Cuenta el frame ahorrado
+                return false; // No hace falta dibujar ni presentar
+        }
+        p.sucio = false; // El cambio queda consumido por este frame
+        p.frames_dibujados++; // Cuenta el frame presentado
+        return true; // Hay que dibujar
+}
+
+void suspenderRender(PlanificadorRender& p, ALLEGRO_TIMER* timer) {
+        if (p.suspendido) return; // Ya estaba suspendido
+        p.suspendido = true; // Bloquea simulacion y dibujo
+        p.inicio_suspension = al_get_time(); // Recuerda cuando empezo
+        p.suspensiones++; // Cuenta la suspension
+        al_stop_timer(timer); // Sin ticks la cola queda bloqueada y el proceso no consume CPU
+}
+
+void reanudarRender(PlanificadorRender& p, ALLEGRO_TIMER* timer) {
+        if (!p.suspendido) return; // No habia suspension
+        p.suspendido = false; // Vuelve a simular y dibujar
+        p.segundos_suspendido += al_get_time() - p.inicio_suspension; // Acumula el tiempo suspendido
+        p.sucio = true; // El contenido de la ventana pudo perderse mientras tanto
+        al_resume_timer(timer); // Reanuda los ticks desde donde se detuvieron
+}
+
+// Atiende los eventos de pantalla que afectan al planificador; devuelve true si el evento fue suyo
+bool procesarEventoPantalla(PlanificadorRender& p, const ALLEGRO_EVENT& ev, ALLEGRO_TIMER* timer) {
+        switch (ev.type) {
+        case ALLEGRO_EVENT_DISPLAY_SWITCH_OUT: // La ventana pierde el foco (incluye minimizar)
+                suspenderRender(p, timer); // Detiene simulacion y dibujo
+                return true; // Evento atendido
+        case ALLEGRO_EVENT_DISPLAY_SWITCH_IN: // La ventana recupera el foco
+                reanudarRender(p, timer); // Reanuda y fuerza un redibujado
+                return true; // Evento atendido
+        case ALLEGRO_EVENT_DISPLAY_HALT_DRAWING: // El sistema pide dejar de dibujar
+                suspenderRender(p, timer); // Detiene simulacion y dibujo
+                al_acknowledge_drawing_halt(ev.display.source); // Confirma antes de que el sistema continue
+                return true; // Evento atendido
+        case ALLEGRO_EVENT_DISPLAY_RESUME_DRAWING: // El sistema permite volver a dibujar
+                al_acknowledge_drawing_resume(ev.display.source); // Confirma la reanudacion
+                reanudarRender(p, timer); // Reanuda y fuerza un redibujado
+                return true; // Evento atendido
+        case ALLEGRO_EVENT_DISPLAY_EXPOSE: // Parte de la ventana quedo descubierta
+                marcarSucio(p); // Hay que volver a pintarla
+                return true; // Evento atendido
+        }
+        return false; // El evento no afecta al planificador
+}
@@ -0,0 +1,122 @@
+/*
+ * RESOLUCION.H
+ * ------------
+ * Escalado dinamico de resolucion: la escena se dibuja en un bitmap
+ * intermedio cuyo tamano efectivo se adapta al tiempo de frame medido
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cmath> // ceil para dimensionar el bitmap intermedio
+#include <allegro5/allegro.h> // Bitmaps, transformaciones y temporizacion
+
+// ========== CONSTANTES ==========
+
+const float PASO_ESCALA = 0.05f; // Cambio de escala aplicado en cada ajuste
+const float ESCALA_MINIMA = 0.25f; // Piso de la escala: evita bitmaps vacios o de tamano negativo con limites invalidos
+const float TOLERANCIA_FRAME = 1.05f; // Un frame por encima de presupuesto * tolerancia se considera lento
+const int FRAMES_PRUEBA_ESCALA = 120; // Frames holgados necesarios antes de probar una escala mayor
+const int MAX_ESPERA_ESCALA = 1920; // Espera maxima tras repetidos fallos al subir la escala
+
+// ========== ESTRUCTURAS ==========
+
+struct EscaladoDinamico {
+        ALLEGRO_BITMAP* escena; // Bitmap intermedio del tamano maximo permitido (NULL = dibujo directo)
+        int ancho, alto; // Dimensiones logicas del area de juego
+        float escala; // Escala actual de la escena respecto a la resolucion nativa
+        float escala_min, escala_max; // Limites configurables de la escala
+        double presupuesto_ms; // Duracion objetivo de cada frame
+        double frame_ms; // Duracion suavizada del frame (media movil exponencial)
+        double ultimo_flip; // Instante del ultimo frame presentado
+        int frames_holgados; // Frames consecutivos dentro del presupuesto
+        int espera_subida; // Frames holgados necesarios para volver a subir la escala
+        bool subida_reciente; // La ultima modificacion fue una subida de escala
+        int ajustes; // Cambios de escala realizados (diagnostico)
+};
+
+// ========== INICIALIZACION ==========
+
+void iniciarEscalado(EscaladoDinamico& esc, int ancho, int alto, float escala_min, float escala_max, double fps) {
+        if (escala_max > 1.0f) escala_max = 1.0f; // Nunca se renderiza por encima de la resolucion nativa
+        if (!(escala_max >= ESCALA_MINIMA)) escala_max = ESCALA_MINIMA; // Limite superior invalido (cero, negativo o NaN)
+        if (!(escala_min >= ESCALA_MINIMA)) escala_min = ESCALA_MINIMA; // --escala-min 0, negativo o no numerico
+        if (escala_min > escala_max) escala_min = escala_max; // Limites coherentes
+
+        esc.ancho = ancho; // Guarda las dimensiones logicas
+        esc.alto = alto; // Alto logico
+        esc.escala_min = escala_min; // Limite inferior
+        esc.escala_max = escala_max; // Limite superior
+        esc.escala = escala_max; // Comienza con la mejor calidad permitida
+        esc.presupuesto_ms = 1000.0 / fps; // Presupuesto por frame a la frecuencia objetivo
+        esc.frame_ms = esc.presupuesto_ms; // Supone inicialmente que se cumple el presupuesto
+        esc.ultimo_flip = 0.0; // Sin frames presentados todavia
+        esc.frames_holgados = 0; // Sin historial
+        esc.espera_subida = FRAMES_PRUEBA_ESCALA; // Espera inicial antes de subir
+        esc.subida_reciente = false; // Todavia no se ha probado ninguna subida
+        esc.ajustes = 0; // Sin ajustes
+
+        int flags = al_get_new_bitmap_flags(); // Conserva la configuracion previa de bitmaps
+        al_set_new_bitmap_flags(ALLEGRO_VIDEO_BITMAP | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR); // Textura con filtrado bilineal para el reescalado
+        esc.escena = al_create_bitmap((int)ceil(ancho * escala_max), (int)ceil(alto * escala_max)); // Se crea una sola vez al tamano maximo
+        al_set_new_bitmap_flags(flags); // Restaura la configuracion previa
+
+        if (!esc.escena) { // Sin bitmap intermedio se dibuja directamente a resolucion nativa
+                esc.escala = 1.0f; // La escala deja de ser ajustable
+                esc.escala_min = esc.escala_max = 1.0f; // Limites fijos en la resolucion nativa
+        }
+}
+
+void destruirEscalado(EscaladoDinamico& esc) {
+        if (esc.escena) al_destroy_bitmap(esc.escena); // Libera el bitmap intermedio
+        esc.escena = NULL; // Evita dobles liberaciones
+}
+
+// ========== DIBUJO ==========
+
+void comenzarEscena(EscaladoDinamico& esc) {
+        if (!esc.escena) return; // Dibujo directo sobre el backbuffer
+
+        al_set_target_bitmap(esc.escena); // Todo lo que sigue se dibuja en el bitmap intermedio
+        al_set_clipping_rectangle(0, 0, (int)ceil(esc.ancho * esc.escala), (int)ceil(esc.alto * esc.escala)); // Solo se rellena la region de la escala actual
+
+        ALLEGRO_TRANSFORM t; // Transformacion de coordenadas logicas a pixeles del bitmap intermedio
+        al_identity_transform(&t); // Parte de la identidad
+        al_scale_transform(&t, esc.escala, esc.escala); // Las coordenadas de juego no cambian, solo su proyeccion
+        al_use_transform(&t); // Se aplica a todo el dibujo de la escena
+}
+
+void terminarEscena(EscaladoDinamico& esc, ALLEGRO_DISPLAY* pantalla) {
+        if (!esc.escena) return; // Nada que componer en modo directo
+
+        al_set_target_backbuffer(pantalla); // Vuelve a dibujar en la pantalla
+        float w = esc.ancho * esc.escala, h = esc.alto * esc.escala; // Region realmente dibujada
+        al_draw_scaled_bitmap(esc.escena, 0, 0, w, h, 0, 0, esc.ancho, esc.alto, 0); // Reescala la escena a resolucion nativa
+}
+
+// ========== AJUSTE ==========
+
+void registrarFrameEscalado(EscaladoDinamico& esc, double instante) {
+        if (esc.ultimo_flip > 0.0) { // Se necesita un frame anterior para medir la duracion
+                double ms = (instante - esc.ultimo_flip) * 1000.0; // Duracion real del frame
+                esc.frame_ms = esc.frame_ms * 0.9 + ms * 0.1; // Suaviza el ruido de frame a frame
+        }
+        esc.ultimo_flip = instante; // Recuerda el instante para el siguiente frame
+
+        if (!esc.escena) return; // Sin bitmap intermedio no hay nada que ajustar
+
+        if (esc.frame_ms > esc.presupuesto_ms * TOLERANCIA_FRAME) { // Se esta excediendo el presupuesto
+                if (esc.escala > esc.escala_min) { // Todavia se puede bajar la resolucion
+                        esc.escala = fmaxf(esc.escala_min, esc.escala - PASO_ESCALA); // Reduce la escala un paso
+                        esc.frame_ms = esc.presupuesto_ms; // Da margen para observar el efecto del cambio
+                        esc.ajustes++; // Cuenta el ajuste
+                        if (esc.subida_reciente) esc.espera_subida = (esc.espera_subida * 2 < MAX_ESPERA_ESCALA) ? esc.espera_subida * 2 : MAX_ESPERA_ESCALA; // La subida anterior fallo: se espera mas antes de volver a probar
+                        esc.subida_reciente = false; // El descenso queda registrado
+                }
+                esc.frames_holgados = 0; // Reinicia la racha de frames holgados
+        } else if (++esc.frames_holgados >= esc.espera_subida && esc.escala < esc.escala_max) { // Racha suficiente para probar mas calidad
+                esc.escala = fminf(esc.escala_max, esc.escala + PASO_ESCALA); // Sube la escala un paso
+                esc.frames_holgados = 0; // La nueva escala necesita su propia racha
+                esc.subida_reciente = true; // Si provoca frames lentos, se alargara la espera
+                esc.ajustes++; // Cuenta el ajuste
+        }
+}
@@ -0,0 +1,509 @@
+/*
+ * SIMULACION.H
+ * ------------
+ * Estado completo de la partida en almacenamiento plano, tick de simulacion
+ * determinista y anillo de instantaneas para rollback. Las etapas del tick se
+ * miden compilando con MEDIR_ETAPAS (definido en las configuraciones Debug)
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cmath> // Seno, coseno y raiz cuadrada de la fisica de la nave
+#include <cstring> // memcpy para las instantaneas
+#include <vector> // Anillo de instantaneas preasignado
+#include <allegro5/allegro.h> // Temporizacion de alta resolucion
+#include "Funciones.h" // Naves, balas, pools, oleadas y colisiones
+#include "flujo.h" // Campo de flujo de los seekers
+#include "particulas.h" // Explosiones y estela (solo fuera de la re-simulacion)
+#include "temporizadores.h" // Vencimientos de balas, cadencia y temporizadores de partida
+#include "ia.h" // Reparto de las decisiones de los seekers entre ticks
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES DE FISICA ==========
+
+const float FPS = 60.0f; // Frecuencia objetivo en fotogramas por segundo
+const float ROTACION = 0.07f; // Variacion angular aplicada por frame al rotar la nave
+const float ACELERACION = 0.35f; // Magnitud de aceleracion aplicada al impulsar la nave
+const float ROZAMIENTO = 0.985f; // Factor de amortiguamiento aplicado cada frame para frenar
+const float VELOCIDAD_MAX = 9.0f; // Velocidad maxima permitida para el jugador
+
+// ========== CONSTANTES DE PARTIDA ==========
+
+const int MAX_JUGADORES = 2; // Jugadores simultaneos (cooperativo)
+const int MAX_INSTANTANEAS = 32; // Ticks anteriores que se conservan para poder volver atras
+const float SEPARACION_JUGADORES = 80.0f; // Distancia horizontal entre las naves al comenzar una ronda en cooperativo
+const int ANCHO_SIN_VENTANA = 1920; // Area de juego de las simulaciones sin pantalla
+const int ALTO_SIN_VENTANA = 1080; // Alto del area de juego sin pantalla
+
+// Bits de la entrada de un jugador en un tick
+const unsigned char ENTRADA_ACELERAR = 1; // W
+const unsigned char ENTRADA_IZQUIERDA = 2; // A
+const unsigned char ENTRADA_DERECHA = 4; // D
+const unsigned char ENTRADA_DISPARO = 8; // Espacio
+
+// ========== ESTRUCTURAS ==========
+
+// Todo lo que determina la partida. No contiene memoria dinamica: los enemigos y las
+// balas viven en pools internos y sus punteros apuntan dentro de la propia estructura,
+// por lo que una copia restaurada sobre la misma instancia sigue siendo valida
+struct EstadoPartida {
+        int tick; // Ticks simulados desde el inicio
+        unsigned int semilla; // Generador aleatorio de la partida
+        int ancho, alto; // Dimensiones del area de juego
+        EstadoJuego estado; // Fase actual de la partida
+
+        Nave jugadores[MAX_JUGADORES]; // Naves de los jugadores
+        int temporizador_disparo[MAX_JUGADORES]; // Cadencia pendiente de cada jugador (-1 = puede disparar)
+        int num_jugadores; // 1 en solitario, 2 en cooperativo
+        ParametrosBalance balance; // Equilibrio con el que se juega esta partida
+
+        PoolNaves pool_naves; // Almacenamiento de enemigos
+        PoolBalas pool_balas; // Almacenamiento de balas
+        PtrNave enemigos; // Lista de enemigos activos (dentro de pool_naves)
+        PtrBala balas; // Lista de balas (dentro de pool_balas)
+        RuedaTemporizadores temporizadores; // Vencimientos pendientes, enlazados por indices
+        OleadaPreparada siguiente_oleada; // Oleada que se genera por partes durante la transicion
+        PlanIA ia; // Cupo, turno y cercanos de las decisiones de los seekers
+
+        int ronda; // Numero de ronda actual
+        int puntos; // Puntuacion acumulada
+        int kills; // Enemigos eliminados
+        int proyectiles; // Proyectiles disparados
+        float tiempo; // Tiempo transcurrido mientras el estado es JUGANDO
+        float tiempo_total; // Tiempo total transcurrido incluyendo pantallas auxiliares
+        int temporizador_transicion; // Fin de la transicion entre rondas (-1 = ninguna)
+        int temporizador_game_over; // Fin de la espera entre la muerte y la pantalla de game over (-1 = ninguna)
+};
+
+// Balas del tick en arreglos contiguos: las pruebas de colision de cada enemigo las recorren sin seguir punteros
+struct BalasTick {
+        float x[MAX_BALAS_POOL], y[MAX_BALAS_POOL]; // Posiciones ya avanzadas
+        PtrBala nodo[MAX_BALAS_POOL]; // Bala de cada ranura
+        bool visible[MAX_BALAS_POOL]; // Sigue en la lista al cerrar el tick
+        int ranura[MAX_BALAS_POOL]; // Ranura de cada nodo del pool (solo valida para las balas de este tick)
+        int n; // Balas del tick
+};
+
+struct EnemigosTick {
+        float x[MAX_NAVES_POOL], y[MAX_NAVES_POOL]; // Posiciones de los supervivientes
+        int tipo[MAX_NAVES_POOL]; // 1 = drone, 2 = seeker
+        int n; // Supervivientes del tick
+};
+
+enum EtapaTick {
+        ETAPA_DISPARO, // Disparos y cadencia
+        ETAPA_BALAS, // Movimiento de las balas
+        ETAPA_IA, // Decisiones de los seekers a los que les toca
+        ETAPA_ENEMIGOS, // Movimiento, impactos, choques con jugadores, conteo y compactacion
+        ETAPA_JUGADORES, // Muertes, cambio de ronda y fisica de las naves
+        ETAPA_TEMPORIZADORES, // Vencimientos del tick
+        NUM_ETAPAS_TICK // Cantidad de etapas
+};
+
+const char* const NOMBRES_ETAPAS_TICK[NUM_ETAPAS_TICK] = {"disparo", "balas", "ia", "enemigos", "jugadores", "temporizadores"}; // Nombres para el panel
+
+// Resultado del ultimo tick listo para dibujarse en una sola pasada, sin volver a recorrer las listas.
+// Vive fuera del estado: no se copia en las instantaneas y la re-simulacion no la toca
+struct VistaTick {
+        int tick; // Tick que la produjo (-1 = ninguno)
+        BalasTick balas; // Balas del tick
+        EnemigosTick enemigos; // Enemigos del tick
+        double us_etapas[NUM_ETAPAS_TICK]; // Media movil de cada etapa en microsegundos (solo con MEDIR_ETAPAS)
+        double us_etapas_tick[NUM_ETAPAS_TICK]; // Cada etapa del ultimo tick, para la telemetria (0 si no se midio)
+        double us_ia; // Coste de las decisiones del ultimo tick en microsegundos (para el presupuesto de ia.h)
+};
+
+struct AnilloInstantaneas {
+        vector<EstadoPartida> estados; // Copias del estado al comienzo de cada tick
+        vector<int> ticks; // Tick guardado en cada ranura (-1 = vacia)
+        double us_guardado; // Coste de la ultima instantanea en microsegundos
+        double us_restauracion; // Coste de la ultima restauracion en microsegundos
+};
+
+// ========== INICIALIZACION ==========
+
+void colocarJugadores(EstadoPartida& e) {
+        for (int j = 0; j < e.num_jugadores; j++) { // Recoloca cada nave
+                float desplazamiento = (e.num_jugadores > 1) ? (j == 0 ? -SEPARACION_JUGADORES : SEPARACION_JUGADORES) : 0.0f; // En cooperativo las naves no se solapan
+                resetearJugador(e.jugadores[j], e.ancho, e.alto); // Centro de la pantalla y sin velocidad
+                e.jugadores[j].x += desplazamiento; // Separa a los jugadores
+                e.jugadores[j].activo = true; // Los jugadores caidos vuelven en la nueva ronda
+        }
+}
+
+void iniciarEstadoPartida(EstadoPartida& e, int ancho, int alto, int num_jugadores, unsigned int semilla, const ParametrosBalance& balance = BALANCE_POR_DEFECTO) {
+        e.tick = 0; // Ningun tick simulado
+        e.semilla = semilla; // Misma semilla = misma partida
+        e.ancho = ancho; // Area de juego
+        e.alto = alto; // Alto del area de juego
+        e.estado = JUGANDO; // Estado inicial de la partida
+        e.num_jugadores = num_jugadores; // Jugadores participantes
+        e.balance = balance; // Viaja con el estado, asi las instantaneas lo conservan
+
+        for (int j = 0; j < MAX_JUGADORES; j++) { // Inicializa todas las ranuras de jugador
+                iniciarPersonaje(e.jugadores[j], ancho, alto); // Atributos base de la nave
+                e.jugadores[j].activo = (j < num_jugadores); // Las ranuras sin jugador quedan inactivas
+                e.temporizador_disparo[j] = -1; // Puede disparar de inmediato
+        }
+        colocarJugadores(e); // Posiciones iniciales
+
+        iniciarPoolNaves(e.pool_naves); // Todos los nodos de enemigos libres
+        iniciarPoolBalas(e.pool_balas); // Todas las balas libres
+        e.enemigos = nullptr; // Sin enemigos
+        e.balas = nullptr; // Sin balas
+        iniciarRuedaTemporizadores(e.temporizadores, e.tick); // Sin vencimientos pendientes
+        e.siguiente_oleada.cabeza = nullptr; // Sin oleada en preparacion
+        e.siguiente_oleada.cola = nullptr; // Sin ultimo nodo
+        e.siguiente_oleada.drones_pendientes = 0; // Nada pendiente
+        e.siguiente_oleada.seekers_pendientes = 0; // Nada pendiente
+        e.siguiente_oleada.por_tick = 0; // Sin cuota
+        iniciarPlanIA(e.ia, balance.cupo_ia); // Sin turnos pendientes
+
+        e.ronda = 1; // Primera ronda
+        e.puntos = 0; // Sin puntos
+        e.kills = 0; // Sin bajas
+        e.proyectiles = 0; // Sin disparos
+        e.tiempo = 0.0f; // Cronometro de juego activo
+        e.tiempo_total = 0.0f; // Cronometro total
+        e.temporizador_transicion = -1; // Sin transicion
+        e.temporizador_game_over = -1; // Sin muerte pendiente
+
+        generarOleada(e.pool_naves, e.enemigos, e.ronda, ancho, alto, e.semilla, e.balance); // Primera oleada con el generador de la partida
+}
+
+// ========== CONSULTAS ==========
+
+int contarJugadoresActivos(const EstadoPartida& e) {
+        int n = 0; // Jugadores con vida
+        for (int j = 0; j < e.num_jugadores; j++) if (e.jugadores[j].activo) n++; // Cuenta cada nave activa
+        return n; // Total de jugadores vivos
+}
+
+Nave* jugadorObjetivo(EstadoPartida& e) {
+        for (int j = 0; j < e.num_jugadores; j++) if (e.jugadores[j].activo) return &e.jugadores[j]; // Los seekers persiguen al primer jugador vivo
+        return nullptr; // No queda nadie a quien perseguir
+}
+
+float tiempoTransicion(const EstadoPartida& e) {
+        return (float)restanteTemporizador(e.temporizadores, e.temporizador_transicion); // Frames que quedan de la pantalla entre rondas
+}
+
+// ========== ETAPAS ==========
+
+bool etapasInstrumentadas() {
+#ifdef MEDIR_ETAPAS
+        return true; // Cada etapa del tick se cronometra
+#else
+        return false; // Sin coste de medicion
+#endif
+}
+
+void iniciarVistaTick(VistaTick& vista) {
+        vista.tick = -1; // Todavia no hay nada que dibujar
+        vista.balas.n = 0; // Sin balas
+        vista.enemigos.n = 0; // Sin enemigos
+        for (int i = 0; i < NUM_ETAPAS_TICK; i++) vista.us_etapas[i] = 0.0; // Sin mediciones
+        for (int i = 0; i < NUM_ETAPAS_TICK; i++) vista.us_etapas_tick[i] = 0.0; // Sin mediciones
+        vista.us_ia = 0.0; // Sin decisiones medidas
+}
+
+// Cierra la etapa en curso y empieza la siguiente desde 'marca'
+void cerrarEtapa(VistaTick* vista, int etapa, double& marca) {
+#ifdef MEDIR_ETAPAS
+        if (!vista) return; // Solo se mide el tick del presente
+        double ahora = al_get_time(); // Fin de la etapa
+        vista->us_etapas_tick[etapa] = (ahora - marca) * 1000000.0; // Duracion en este tick
+        vista->us_etapas[etapa] = vista->us_etapas[etapa] * 0.95 + vista->us_etapas_tick[etapa] * 0.05; // Media movil
+        marca = ahora; // Comienzo de la siguiente
+#else
+        (void)vista; (void)etapa; (void)marca; // Sin medicion en Release
+#endif
+}
+
+double marcaEtapa(VistaTick* vista) {
+#ifdef MEDIR_ETAPAS
+        if (vista) { // Solo se mide el tick del presente
+                for (int i = 0; i < NUM_ETAPAS_TICK; i++) vista->us_etapas_tick[i] = 0.0; // Las etapas que no corran quedan a cero
+                return al_get_time(); // Comienzo de la primera etapa
+        }
+#else
+        (void)vista; // Sin medicion en Release
+#endif
+        return 0.0; // Sin medicion
+}
+
+// ========== TEMPORIZADORES ==========
+
+// Cancela el vencimiento de cada bala antes de devolverlas todas al pool
+void retirarTodasLasBalas(EstadoPartida& e) {
+        for (PtrBala b = e.balas; b != nullptr; b = b->siguiente) cancelarTemporizador(e.temporizadores, b->temporizador); // Sus indices se reutilizaran
+        liberarBalas(e.pool_balas, e.balas); // Vacia la lista
+}
+
+// El tick que confirma una oleada no pasa por las pasadas de juego: copia la oleada a la vista para
+// que el primer frame de la ronda tambien se dibuje sin recorrer la lista de enemigos
+void prepararVistaOleada(const EstadoPartida& e, VistaTick& vista) {
+        vista.enemigos.n = 0; // Vista vacia
+        for (PtrNave n = e.enemigos; n != nullptr; n = n->siguiente) { // Oleada recien confirmada
+                if (!n->activo) continue; // Solo los enemigos en juego
+                vista.enemigos.x[vista.enemigos.n] = n->x; // Posicion inicial
+                vista.enemigos.y[vista.enemigos.n] = n->y; // Posicion vertical
+                vista.enemigos.tipo[vista.enemigos.n] = n->tipo; // Drone o seeker
+                vista.enemigos.n++; // Siguiente ranura
+        }
+        vista.balas.n = 0; // Las balas se retiraron al empezar la transicion
+        vista.tick = e.tick; // La vista corresponde a este tick
+}
+
+// Avanza la rueda al tick actual y aplica lo que vence en el: solo se visita lo que vence.
+// Durante el tick la rueda sigue en el anterior, asi que programar 'n' ticks vence al final del tick actual + n - 1
+void procesarTemporizadores(EstadoPartida& e, VistaTick* vista = NULL) {
+        EventoTemporizador vencidos[MAX_TEMPORIZADORES]; // Eventos del tick (en la pila, sin memoria dinamica)
+        int n = avanzarRuedaTemporizadores(e.temporizadores, vencidos); // Dispara los vencimientos del tick
+        for (int i = 0; i < n; i++) { // Aplica cada evento en el orden de la rueda
+                switch (vencidos[i].tipo) {
+                case TEMP_BALA: // Fin de la vida de la bala, o impacto en este tick
+                        if (vista) vista->balas.visible[vista->balas.ranura[vencidos[i].dato]] = false; // Ya no se dibuja
+                        retirarBala(e.pool_balas, e.balas, &e.pool_balas.nodos[vencidos[i].dato]); // Retirada en O(1)
+                        break;
+                case TEMP_DISPARO: // Termino la cadencia
+                        e.temporizador_disparo[vencidos[i].dato] = -1; // El jugador puede volver a disparar
+                        break;
+                case TEMP_GAME_OVER: // Termino la espera tras caer el ultimo jugador
+                        e.temporizador_game_over = -1; // Sin espera pendiente
+                        e.estado = GAME_OVER; // Cambia al estado de game over
+                        break;
+                case TEMP_TRANSICION: // Termino la pantalla entre rondas
+                        e.temporizador_transicion = -1; // Sin transicion pendiente
+                        confirmarOleada(e.pool_naves, e.enemigos, e.siguiente_oleada, e.ancho, e.alto, e.semilla); // Activa la oleada ya preparada con un intercambio O(1)
+                        e.estado = JUGANDO; // Regresa al estado de juego activo
+                        if (vista) prepararVistaOleada(e, *vista); // Primer frame de la ronda listo para el dibujo
+                        break;
+                }
+        }
+}
+
+// ========== PASADAS ==========
+
+// Unica pasada por las balas: las avanza y las copia a arreglos contiguos para las colisiones y el dibujo
+void pasadaBalas(EstadoPartida& e, bool mover, BalasTick& t) {
+        t.n = 0; // Arreglos vacios
+        for (PtrBala b = e.balas; b != nullptr; b = b->siguiente) { // Cada bala de la lista
+                if (!b->activa) continue; // Las que ya impactaron se retiran al cerrar su tick
+                if (mover) { // Sin nadie a quien perseguir la escena queda congelada
+                        b->x += b->vx; // Avanza la bala horizontalmente segun su velocidad
+                        b->y += b->vy; // Avanza la bala verticalmente segun su velocidad
+                }
+                t.x[t.n] = b->x; // Posicion para las colisiones y el dibujo
+                t.y[t.n] = b->y; // Posicion vertical
+                t.nodo[t.n] = b; // Para desactivarla si impacta
+                t.visible[t.n] = true; // Se oculta cuando vence
+                t.ranura[b - e.pool_balas.nodos] = t.n; // El vencimiento la encuentra sin buscar
+                t.n++; // Siguiente ranura
+        }
+}
+
+// Unica pasada por los enemigos: movimiento, impactos de bala, choques con los jugadores, conteo y
+// compactacion de la lista. Cada enemigo cae ante la primera bala de la lista que lo toca y esa bala
+// se desactiva, igual que al recorrer balas por enemigos. Devuelve los enemigos vivos
+int pasadaEnemigos(EstadoPartida& e, Nave* objetivo, BalasTick& balas, bool* golpeados, int& muertos, SistemaParticulas* particulas, EnemigosTick* vista) {
+        int vivos = 0; // Enemigos que siguen en la lista
+        muertos = 0; // Bajas del tick
+        if (vista) vista->n = 0; // Sin supervivientes todavia
+        for (int j = 0; j < e.num_jugadores; j++) golpeados[j] = false; // Nadie choco todavia
+
+        PtrNave* enlace = &e.enemigos; // Enlace que apunta al enemigo actual, para desengancharlo sin recorrer de nuevo
+        while (*enlace != nullptr) { // Cada enemigo de la lista
+                PtrNave enemigo = *enlace; // Enemigo actual
+                if (enemigo->activo && objetivo) { // Sin objetivo los enemigos no se mueven
+                        if (enemigo->tipo == 1) movimientoWanderer(*enemigo, e.ancho, e.alto); // Los drones rebotan en los bordes
+                        else if (enemigo->tipo == 2) moverSeeker(*enemigo, e.ancho, e.alto, e.balance.velocidad_seeker); // Los seekers avanzan en la direccion de su ultima decision
+                }
+
+                if (enemigo->activo) { // Impactos contra las balas ya avanzadas
+                        for (int i = 0; i < balas.n; i++) { // Recorrido contiguo
+                                if (hayColision(balas.x[i], balas.y[i], RADIO_BALA, enemigo->x, enemigo->y, enemigo->radio)) { // Comprueba superposicion
+                                        balas.nodo[i]->activa = false; // Desactiva la bala al impactar
+                                        reprogramarTemporizador(e.temporizadores, balas.nodo[i]->temporizador, 1); // Se retira al cerrar este tick
+                                        enemigo->activo = false; // Marca al enemigo como destruido
+                                        muertos++; // Incrementa el numero de bajas registradas
+                                        if (particulas) { // Si hay sistema de particulas, emite la explosion del enemigo
+                                                if (enemigo->tipo == 1) emitirExplosion(*particulas, enemigo->x, enemigo->y, 60, 9.0f, 0.67f, 1.0f, 0.67f); // Fragmentos verdes del drone
+                                                else emitirExplosion(*particulas, enemigo->x, enemigo->y, 60, 9.0f, 1.0f, 0.4f, 0.86f); // Fragmentos rosas del seeker
+                                        }
+                                        break; // Un enemigo solo cae una vez
+                                }
+                        }
+                }
+
+                if (!enemigo->activo) { // Destruido en este tick o antes
+                        *enlace = enemigo->siguiente; // Lo desengancha sin perder la posicion
+                        devolverNave(e.pool_naves, enemigo); // Devuelve el nodo al pool
+                        continue; // El enlace ya apunta al siguiente
+                }
+
+                for (int j = 0; j < e.num_jugadores; j++) { // Choques con cada jugador vivo
+                        Nave& jugador = e.jugadores[j]; // Nave del jugador
+                        if (jugador.activo && !golpeados[j] && hayColision(jugador.x, jugador.y, jugador.radio, enemigo->x, enemigo->y, enemigo->radio)) golpeados[j] = true; // Se aplica tras la pasada
+                }
+                if (vista) { // Queda listo para el dibujo
+                        vista->x[vista->n] = enemigo->x; // Posicion final del tick
+                        vista->y[vista->n] = enemigo->y; // Posicion vertical
+                        vista->tipo[vista->n] = enemigo->tipo; // Drone o seeker
+                        vista->n++; // Siguiente ranura
+                }
+                vivos++; // Cuenta el superviviente
+                enlace = &enemigo->siguiente; // Avanza al siguiente enlace
+        }
+        return vivos; // Enemigos que siguen en juego
+}
+
+// ========== TICK ==========
+
+// Avanza la partida un tick con las entradas de cada jugador. Con particulas == NULL y
+// efectos == false no produce ningun efecto fuera del estado (re-simulacion de rollback).
+// Con una vista deja en ella lo necesario para dibujar el tick sin recorrer las listas
+void simularTick(EstadoPartida& e, CampoFlujo& campo, const unsigned char* entradas, SistemaParticulas* particulas, bool efectos, VistaTick* vista = NULL) {
+        double marca = marcaEtapa(vista); // Comienzo de la primera etapa
+        e.tick++; // Cuenta el tick
+        e.tiempo_total += 1.0f / FPS; // Incrementa el tiempo total cada frame
+
+        if (e.estado == JUGANDO) { // Solo actualiza la logica principal cuando se esta jugando
+                e.tiempo += 1.0f / FPS; // Incrementa el cronometro de juego activo
+
+                for (int j = 0; j < e.num_jugadores; j++) { // Disparo de cada jugador
+                        Nave& jugador = e.jugadores[j]; // Nave del jugador
+                        if ((entradas[j] & ENTRADA_DISPARO) && e.temporizador_disparo[j] < 0 && jugador.activo) { // Comprueba si se puede disparar
+                                PtrBala bala = dispararBala(e.pool_balas, e.balas, jugador); // Crea una nueva bala hacia la direccion actual
+                                if (bala == nullptr) continue; // Pool agotado: no hay disparo, no cuenta y se reintenta en el proximo tick
+                                bala->temporizador = programarTemporizador(e.temporizadores, VIDA_BALA - 1, TEMP_BALA, (int)(bala - e.pool_balas.nodos)); // Se retira al final de su ultimo frame de vida (el del disparo cuenta)
+                                e.temporizador_disparo[j] = programarTemporizador(e.temporizadores, (int)ceil(e.balance.cadencia_disparo), TEMP_DISPARO, j); // Reinicia la cadencia de disparo
+                                e.proyectiles++; // Incrementa el conteo de proyectiles lanzados
+                                if (efectos) tocarSonido(sfx_disparo, 0.3f); // Reproduce el efecto de disparo
+                        }
+                }
+                cerrarEtapa(vista, ETAPA_DISPARO, marca); // Fin de los disparos
+
+                Nave* objetivo = jugadorObjetivo(e); // Jugador al que persiguen los seekers
+                if (objetivo) actualizarCampoFlujo(campo, objetivo->x, objetivo->y); // Recalcula el campo solo si el objetivo cambio de celda
+
+                BalasTick balas_locales; // Sin vista las balas del tick viven en la pila
+                BalasTick& balas = vista ? vista->balas : balas_locales; // Con vista quedan listas para el dibujo
+                pasadaBalas(e, objetivo != nullptr, balas); // Avanza las balas y las deja contiguas
+                cerrarEtapa(vista, ETAPA_BALAS, marca); // Fin de las balas
+
+                if (objetivo) { // Sin objetivo nadie decide
+                        double inicio_ia = vista ? al_get_time() : 0.0; // Se mide para el presupuesto aunque no haya MEDIR_ETAPAS
+                        planificarDecisiones(e.ia, e.pool_naves, *objetivo, campo); // Cercanos y turno por el pool
+                        if (vista) vista->us_ia = (al_get_time() - inicio_ia) * 1000000.0; // Coste del tick
+                }
+                cerrarEtapa(vista, ETAPA_IA, marca); // Fin de las decisiones
+
+                bool golpeados[MAX_JUGADORES]; // Jugadores que chocaron con algun enemigo
+                int muertos = 0; // Enemigos destruidos en el tick
+                int vivos = pasadaEnemigos(e, objetivo, balas, golpeados, muertos, particulas, vista ? &vista->enemigos : NULL); // Todo lo que toca a los enemigos en un solo recorrido
+                cerrarEtapa(vista, ETAPA_ENEMIGOS, marca); // Fin de los enemigos
+
+                if (muertos > 0) { // Si algun enemigo fue destruido
+                        e.kills += muertos; // Incrementa el total de eliminaciones
+                        e.puntos += muertos * 100; // Suma puntos por cada enemigo destruido
+                        if (efectos) tocarSonido(sfx_explosion, 0.5f); // Reproduce el efecto de explosion
+                }
+
+                if (vivos == 0 && contarJugadoresActivos(e) > 0) { // Comprueba si la ronda fue completada
+                        e.estado = CAMBIO_RONDA; // Cambia al estado de transicion
+                        e.temporizador_transicion = programarTemporizador(e.temporizadores, (int)DURACION_TRANSICION, TEMP_TRANSICION, 0); // Establece la duracion de la pantalla intermedia
+                        e.ronda++; // Incrementa el numero de ronda alcanzado
+                        iniciarOleadaPreparada(e.siguiente_oleada, e.ronda, (int)(DURACION_TRANSICION / 2.0f), e.balance); // Reparte la generacion de la proxima oleada en la primera mitad de la transicion
+                        retirarTodasLasBalas(e); // Limpia cualquier bala restante
+                        colocarJugadores(e); // Regresa a los jugadores al centro y reinicia su movimiento
+                }
+
+                for (int j = 0; j < e.num_jugadores; j++) { // Colisiones de cada jugador
+                        Nave& jugador = e.jugadores[j]; // Nave del jugador
+                        if (golpeados[j]) { // El jugador colisiono con un enemigo durante la pasada
+                                jugador.activo = false; // Desactiva al jugador para detener la logica de movimiento
+                                if (contarJugadoresActivos(e) == 0) e.temporizador_game_over = programarTemporizador(e.temporizadores, 120, TEMP_GAME_OVER, 0); // Con el ultimo jugador caido comienza la cuenta hacia el game over
+                                if (particulas) emitirExplosion(*particulas, jugador.x, jugador.y, 200, 12.0f, j == 0 ? 0.24f : 1.0f, j == 0 ? 0.7f : 0.6f, j == 0 ? 1.0f : 0.2f); // Gran explosion del color de la nave
+                                if (efectos) tocarSonido(sfx_muerte, 0.7f); // Reproduce el efecto de muerte del jugador
+                        }
+                }
+
+                for (int j = 0; j < e.num_jugadores; j++) { // Fisica de cada nave
+                        Nave& jugador = e.jugadores[j]; // Nave del jugador
+                        if (!jugador.activo) continue; // Actualiza la fisica de la nave solo si sigue viva
+
+                        if (entradas[j] & ENTRADA_IZQUIERDA) jugador.ang -= ROTACION; // Gira hacia la izquierda cuando A esta activa
+                        if (entradas[j] & ENTRADA_DERECHA) jugador.ang += ROTACION; // Gira hacia la derecha cuando D esta activa
+
+                        if (entradas[j] & ENTRADA_ACELERAR) { // Aplica impulso hacia adelante cuando se presiona W
+                                float fx = sin(jugador.ang); // Componente horizontal del impulso segun el angulo actual
+                                float fy = -cos(jugador.ang); // Componente vertical del impulso
+                                jugador.vx += fx * ACELERACION; // Ajusta la velocidad horizontal del jugador
+                                jugador.vy += fy * ACELERACION; // Ajusta la velocidad vertical del jugador
+                                if (particulas) emitirEstela(*particulas, jugador.x, jugador.y, jugador.ang); // Chispas del propulsor mientras se acelera
+                        }
+
+                        jugador.vx *= ROZAMIENTO; // Aplica amortiguamiento a la velocidad horizontal
+                        jugador.vy *= ROZAMIENTO; // Aplica amortiguamiento a la velocidad vertical
+
+                        float vel = jugador.vx * jugador.vx + jugador.vy * jugador.vy; // Calcula la magnitud al cuadrado de la velocidad
+                        if (vel > VELOCIDAD_MAX * VELOCIDAD_MAX) { // Comprueba si supera el limite permitido
+                                float factor = VELOCIDAD_MAX / sqrt(vel); // Calcula el factor de reduccion necesario
+                                jugador.vx *= factor; // Escala la velocidad horizontal para respetar el limite
+                                jugador.vy *= factor; // Escala la velocidad vertical
+                        }
+
+                        jugador.x += jugador.vx; // Actualiza la posicion horizontal del jugador
+                        jugador.y += jugador.vy; // Actualiza la posicion vertical del jugador
+
+                        if (jugador.x < 25) jugador.x = 25; // Evita que la nave salga por el borde izquierdo
+                        if (jugador.x >= e.ancho - 25) jugador.x = e.ancho - 25; // Evita que la nave salga por el borde derecho
+                        if (jugador.y < 25) jugador.y = 25; // Evita que la nave salga por la parte superior
+                        if (jugador.y >= e.alto - 25) jugador.y = e.alto - 25; // Evita que la nave salga por la parte inferior
+                }
+                if (vista) vista->tick = e.tick; // La vista corresponde a este tick
+                cerrarEtapa(vista, ETAPA_JUGADORES, marca); // Fin de los jugadores
+        }
+
+        if (e.estado == CAMBIO_RONDA) { // Actualiza la transicion entre rondas; su fin lo dispara la rueda
+                if (!oleadaPreparadaCompleta(e.siguiente_oleada)) { // Mientras quede oleada por generar
+                        if (avanzarOleadaPreparada(e.pool_naves, e.siguiente_oleada, e.ancho, e.alto, e.semilla)) { // Genera la cuota de este tick
+                                Nave* objetivo = jugadorObjetivo(e); // Jugador ya recentrado
+                                if (objetivo) actualizarCampoFlujo(campo, objetivo->x, objetivo->y); // Al terminar, precalienta el campo de flujo
+                        }
+                }
+        }
+
+        bool tick_de_juego = vista && vista->tick == e.tick; // Antes de que la confirmacion de una oleada marque la vista
+        procesarTemporizadores(e, vista); // Los vencimientos cierran el tick: lo programado a 1 tick vence al final de este
+        if (tick_de_juego) cerrarEtapa(vista, ETAPA_TEMPORIZADORES, marca); // Solo se mide el tick de juego
+}
+
+// ========== INSTANTANEAS ==========
+
+void iniciarInstantaneas(AnilloInstantaneas& anillo) {
+        anillo.estados.resize(MAX_INSTANTANEAS); // Reserva todas las copias de una vez
+        anillo.ticks.assign(MAX_INSTANTANEAS, -1); // Todas las ranuras vacias
+        anillo.us_guardado = 0.0; // Sin mediciones
+        anillo.us_restauracion = 0.0; // Sin mediciones
+}
+
+void guardarInstantanea(AnilloInstantaneas& anillo, const EstadoPartida& e) {
+        double inicio = al_get_time(); // Mide el coste de la copia
+        int ranura = e.tick % MAX_INSTANTANEAS; // Ranura circular del tick
+        memcpy(&anillo.estados[ranura], &e, sizeof(EstadoPartida)); // Copia plana: el estado no tiene memoria dinamica
+        anillo.ticks[ranura] = e.tick; // Marca que tick contiene
+        anillo.us_guardado = (al_get_time() - inicio) * 1000000.0; // Coste en microsegundos
+}
+
+// Restaura el estado del comienzo del tick indicado sobre la misma instancia que se guardo
+bool restaurarInstantanea(AnilloInstantaneas& anillo, int tick, EstadoPartida& e) {
+        int ranura = tick % MAX_INSTANTANEAS; // Ranura circular del tick
+        if (tick < 0 || anillo.ticks[ranura] != tick) return false; // El tick ya no esta en el anillo
+        double inicio = al_get_time(); // Mide el coste de la restauracion
+        memcpy(&e, &anillo.estados[ranura], sizeof(EstadoPartida)); // Los punteros internos vuelven a ser validos en la misma instancia
+        anillo.us_restauracion = (al_get_time() - inicio) * 1000000.0; // Coste en microsegundos
+        return true; // Estado restaurado
+}
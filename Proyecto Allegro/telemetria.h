@@ -0,0 +1,224 @@
+/*
+ * TELEMETRIA.H
+ * ------------
+ * Registro permanente de telemetria por tick en un anillo columnar de tamano fijo,
+ * volcado comprimido (deltas + varint) al terminar la partida y conversion a CSV
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+#include <cstdio> // printf y snprintf
+#include <ctime> // Marca de tiempo en el nombre del volcado
+#include <fstream> // Lectura y escritura de los volcados
+#include <iterator> // istreambuf_iterator para leer el volcado entero
+#include <string> // Ruta del CSV por defecto
+#include <vector> // Buffers de codificacion (fuera del tick)
+#include <algorithm> // sort para los percentiles del resumen
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const int CAPACIDAD_TELEMETRIA = 16384; // Ticks que conserva el anillo (unos 4.5 minutos a 60 FPS, potencia de dos)
+const unsigned int MAGIA_TELEMETRIA = 0x4C544F56u; // Identificador del formato ("VOTL")
+const unsigned int VERSION_TELEMETRIA = 2; // Cambia si cambia el formato del volcado (2: etapas del tick)
+
+enum ColumnaTelemetria {
+        TEL_TICK, // Tick de la partida
+        TEL_ESTADO, // EstadoJuego al final del tick
+        TEL_RONDA, // Ronda actual
+        TEL_ENEMIGOS, // Nodos de enemigos en uso
+        TEL_BALAS, // Balas en uso
+        TEL_PARTICULAS, // Particulas vivas
+        TEL_X, // Posicion X del jugador local
+        TEL_Y, // Posicion Y del jugador local
+        TEL_US_SIMULACION, // Microsegundos de la simulacion del tick
+        TEL_US_RENDER, // Microsegundos del ultimo frame dibujado
+        TEL_NS_DISPARO, // Nanosegundos de cada etapa del tick, en el orden de EtapaTick (0 sin MEDIR_ETAPAS o fuera de JUGANDO)
+        TEL_NS_BALAS, // Movimiento de las balas
+        TEL_NS_IA, // Decisiones de los seekers
+        TEL_NS_ENEMIGOS, // Pasada de enemigos
+        TEL_NS_JUGADORES, // Fisica de las naves
+        TEL_NS_TEMPORIZADORES, // Vencimientos del tick
+        NUM_COLUMNAS_TELEMETRIA // Cantidad de columnas
+};
+
+const char* const NOMBRES_COLUMNAS_TELEMETRIA[NUM_COLUMNAS_TELEMETRIA] = {"tick", "estado", "ronda", "enemigos", "balas", "particulas", "x", "y", "us_simulacion", "us_render", "ns_disparo", "ns_balas", "ns_ia", "ns_enemigos", "ns_jugadores", "ns_temporizadores"}; // Cabecera del CSV
+
+// ========== ESTRUCTURAS ==========
+
+struct RegistroTelemetria {
+        int columnas[NUM_COLUMNAS_TELEMETRIA][CAPACIDAD_TELEMETRIA]; // Una columna contigua por dato: comprime mejor y se escribe con accesos independientes
+        long escritos; // Ticks registrados desde el ultimo reinicio
+        int volcados; // Archivos escritos
+        double us_registro; // Coste medio de registrar un tick (media movil)
+};
+
+RegistroTelemetria telemetria; // Almacenamiento estatico: el anillo nunca asigna memoria
+
+// ========== REGISTRO ==========
+
+void reiniciarTelemetria(RegistroTelemetria& t) {
+        t.escritos = 0; // El anillo vuelve a estar vacio
+        t.us_registro = 0.0; // Sin mediciones
+}
+
+// Camino caliente: una escritura por columna, sin asignaciones ni bloqueos (solo el hilo del juego registra)
+void registrarTelemetria(RegistroTelemetria& t, const int* fila) {
+        int i = (int)(t.escritos & (CAPACIDAD_TELEMETRIA - 1)); // Posicion circular
+        for (int c = 0; c < NUM_COLUMNAS_TELEMETRIA; c++) t.columnas[c][i] = fila[c]; // Copia cada dato a su columna
+        t.escritos++; // Avanza el anillo
+}
+
+int ticksTelemetria(const RegistroTelemetria& t) {
+        return t.escritos < CAPACIDAD_TELEMETRIA ? (int)t.escritos : CAPACIDAD_TELEMETRIA; // Ticks disponibles en el anillo
+}
+
+// ========== CODIFICACION ==========
+
+void escribirVarint(vector<unsigned char>& salida, unsigned int valor) {
+        while (valor >= 0x80) { // Siete bits por byte
+                salida.push_back((unsigned char)(valor | 0x80)); // Bit alto: continua
+                valor >>= 7; // Siguientes siete bits
+        }
+        salida.push_back((unsigned char)valor); // Ultimo byte
+}
+
+bool leerVarint(const vector<unsigned char>& entrada, size_t& pos, unsigned int& valor) {
+        valor = 0; // Acumulador
+        for (int desplazamiento = 0; desplazamiento < 35; desplazamiento += 7) { // Como mucho cinco bytes
+                if (pos >= entrada.size()) return false; // Archivo truncado
+                unsigned char b = entrada[pos++]; // Siguiente byte
+                valor |= (unsigned int)(b & 0x7F) << desplazamiento; // Incorpora sus siete bits
+                if (!(b & 0x80)) return true; // Fin del numero
+        }
+        return false; // Varint demasiado largo
+}
+
+unsigned int zigzag(int v) { return ((unsigned int)v << 1) ^ (unsigned int)(v >> 31); } // Pequenos negativos -> pequenos positivos
+int deszigzag(unsigned int v) { return (int)(v >> 1) ^ -(int)(v & 1); } // Inversa de zigzag
+
+// ========== VOLCADO ==========
+
+// Escribe el anillo (del tick mas antiguo al mas reciente) columna a columna: cada valor se guarda
+// como diferencia con el anterior de su columna en zigzag + varint, casi siempre un byte
+bool volcarTelemetria(RegistroTelemetria& t, const char* ruta) {
+        int n = ticksTelemetria(t); // Ticks a volcar
+        if (n == 0) return false; // Nada que guardar
+        long primero = t.escritos - n; // Indice absoluto del tick mas antiguo
+
+        vector<unsigned char> datos; // Flujo comprimido
+        datos.reserve((size_t)n * NUM_COLUMNAS_TELEMETRIA * 2); // Suele sobrar
+        escribirVarint(datos, MAGIA_TELEMETRIA); // Identificador del formato
+        escribirVarint(datos, VERSION_TELEMETRIA); // Version
+        escribirVarint(datos, NUM_COLUMNAS_TELEMETRIA); // Columnas
+        escribirVarint(datos, (unsigned int)n); // Filas
+        for (int c = 0; c < NUM_COLUMNAS_TELEMETRIA; c++) { // Columna a columna
+                int anterior = 0; // Cada columna empieza desde cero
+                for (long k = primero; k < t.escritos; k++) { // En orden cronologico
+                        int v = t.columnas[c][k & (CAPACIDAD_TELEMETRIA - 1)]; // Valor del tick
+                        escribirVarint(datos, zigzag(v - anterior)); // Diferencia con el anterior
+                        anterior = v; // Base del siguiente
+                }
+        }
+
+        ofstream archivo(ruta, ios::binary); // Sobrescribe si ya existe
+        if (!archivo.is_open()) return false; // Sin permisos de escritura
+        archivo.write((const char*)datos.data(), (streamsize)datos.size()); // Todo de una vez
+        t.volcados++; // Cuenta el volcado
+        printf("Telemetria: %d ticks -> %s (%u bytes, %.1f bytes/tick)\n", n, ruta, (unsigned int)datos.size(), (double)datos.size() / n); // Informe por consola
+        return true; // Volcado completo
+}
+
+// Vuelca con un nombre unico basado en la hora actual
+bool volcarTelemetriaFechada(RegistroTelemetria& t) {
+        char ruta[64]; // Nombre del archivo
+        snprintf(ruta, sizeof(ruta), "telemetria_%lld.tlm", (long long)time(NULL)); // Un archivo por volcado
+        return volcarTelemetria(t, ruta); // Escribe el anillo
+}
+
+// ========== CONVERSION ==========
+
+bool leerTelemetria(const char* ruta, vector<int>* columnas, int& filas) {
+        ifstream archivo(ruta, ios::binary); // Volcado a convertir
+        if (!archivo.is_open()) return false; // No existe
+        vector<unsigned char> datos((istreambuf_iterator<char>(archivo)), istreambuf_iterator<char>()); // Archivo completo en memoria
+
+        size_t pos = 0; // Posicion de lectura
+        unsigned int magia, version, num_columnas, num_filas; // Cabecera
+        if (!leerVarint(datos, pos, magia) || magia != MAGIA_TELEMETRIA) return false; // No es un volcado
+        if (!leerVarint(datos, pos, version) || version != VERSION_TELEMETRIA) return false; // Formato distinto
+        if (!leerVarint(datos, pos, num_columnas) || num_columnas != NUM_COLUMNAS_TELEMETRIA) return false; // Columnas distintas
+        if (!leerVarint(datos, pos, num_filas)) return false; // Truncado
+        if (num_filas > (unsigned int)CAPACIDAD_TELEMETRIA) return false; // El anillo nunca vuelca mas ticks: cabecera corrupta
+        if ((size_t)num_filas * NUM_COLUMNAS_TELEMETRIA > datos.size() - pos) return false; // Cada valor ocupa al menos un byte: truncado
+
+        filas = (int)num_filas; // Ticks del volcado
+        for (int c = 0; c < NUM_COLUMNAS_TELEMETRIA; c++) { // Columna a columna
+                columnas[c].resize(filas); // Una entrada por tick
+                int anterior = 0; // Mismo origen que al codificar
+                for (int k = 0; k < filas; k++) { // Deshace las diferencias
+                        unsigned int v; // Delta codificada
+                        if (!leerVarint(datos, pos, v)) return false; // Truncado
+                        anterior += deszigzag(v); // Valor absoluto
+                        columnas[c][k] = anterior; // Guarda el valor
+                }
+        }
+        return true; // Volcado completo
+}
+
+// Herramienta de linea de comandos: convierte un volcado a CSV y resume cada ronda.
+// Devuelve el codigo de salida del proceso
+int convertirTelemetria(const char* ruta, const char* ruta_csv) {
+        vector<int> columnas[NUM_COLUMNAS_TELEMETRIA]; // Datos decodificados
+        int filas = 0; // Ticks del volcado
+        if (!leerTelemetria(ruta, columnas, filas)) { // Archivo ausente o corrupto
+                printf("No se pudo leer el volcado de telemetria %s\n", ruta); // Informa del error
+                return 1; // Fallo
+        }
+
+        string salida = ruta_csv ? ruta_csv : string(ruta) + ".csv"; // Por defecto, junto al volcado
+        ofstream csv(salida.c_str()); // Una fila por tick
+        if (!csv.is_open()) { // Sin permisos de escritura
+                printf("No se pudo escribir %s\n", salida.c_str()); // Informa del error
+                return 1; // Fallo
+        }
+        for (int c = 0; c < NUM_COLUMNAS_TELEMETRIA; c++) csv << (c ? "," : "") << NOMBRES_COLUMNAS_TELEMETRIA[c]; // Cabecera
+        csv << "\n"; // Fin de la cabecera
+        for (int k = 0; k < filas; k++) { // Cada tick
+                for (int c = 0; c < NUM_COLUMNAS_TELEMETRIA; c++) csv << (c ? "," : "") << columnas[c][k]; // Cada columna
+                csv << "\n"; // Fin de la fila
+        }
+        printf("%d ticks (%d a %d) -> %s\n", filas, filas ? columnas[TEL_TICK][0] : 0, filas ? columnas[TEL_TICK][filas - 1] : 0, salida.c_str()); // Rango convertido
+
+        // Resumen por ronda: donde aparece el "lag en la ronda 7"
+        printf("ronda  ticks  enemigos_max  balas_max  sim_media_us  sim_p99_us  sim_max_us  render_max_us  max_en_tick  etapa_mas_lenta\n"); // Cabecera del resumen
+        int k = 0; // Inicio del tramo
+        while (k < filas) { // Un tramo por ronda consecutiva
+                int ronda = columnas[TEL_RONDA][k]; // Ronda del tramo
+                int fin = k; // Fin del tramo
+                while (fin < filas && columnas[TEL_RONDA][fin] == ronda) fin++; // Avanza mientras no cambie
+
+                vector<int> sim(columnas[TEL_US_SIMULACION].begin() + k, columnas[TEL_US_SIMULACION].begin() + fin); // Tiempos del tramo
+                double suma = 0.0; // Para la media
+                int enemigos = 0, balas = 0, render = 0, peor = k; // Maximos del tramo
+                for (int i = k; i < fin; i++) { // Recorre el tramo
+                        suma += columnas[TEL_US_SIMULACION][i]; // Acumula
+                        enemigos = max(enemigos, columnas[TEL_ENEMIGOS][i]); // Pico de enemigos
+                        balas = max(balas, columnas[TEL_BALAS][i]); // Pico de balas
+                        render = max(render, columnas[TEL_US_RENDER][i]); // Peor frame
+                        if (columnas[TEL_US_SIMULACION][i] > columnas[TEL_US_SIMULACION][peor]) peor = i; // Peor tick
+                }
+                int lenta = TEL_NS_DISPARO; // Etapa con mas tiempo acumulado en el tramo
+                double ns_lenta = 0.0; // Su total
+                for (int c = TEL_NS_DISPARO; c <= TEL_NS_TEMPORIZADORES; c++) { // Cada etapa
+                        double ns = 0.0; // Total de la etapa
+                        for (int i = k; i < fin; i++) ns += columnas[c][i]; // Acumula
+                        if (ns > ns_lenta) { ns_lenta = ns; lenta = c; } // Conserva la mas cara
+                }
+                sort(sim.begin(), sim.end()); // Para el percentil
+                printf("%5d  %5d  %12d  %9d  %12.1f  %10d  %10d  %13d  %11d  %s\n", ronda, fin - k, enemigos, balas, suma / (fin - k), sim[((fin - k) * 99) / 100], sim.back(), render, columnas[TEL_TICK][peor], ns_lenta > 0.0 ? NOMBRES_COLUMNAS_TELEMETRIA[lenta] + 3 : "-"); // Linea del tramo (sin el prefijo ns_)
+                k = fin; // Siguiente tramo
+        }
+        return 0; // Exito
+}
@@ -0,0 +1,189 @@
+/*
+ * TEMPORIZADORES.H
+ * ----------------
+ * Rueda jerarquica de temporizadores por tick: los vencimientos se programan una
+ * vez y se disparan en O(1) amortizado, sin recorrer cada tick todo lo pendiente
+ */
+
+#pragma once // Evita inclusiones multiples del archivo de cabecera
+
+using namespace std; // Facilita el acceso a tipos estandar sin prefijo std::
+
+// ========== CONSTANTES ==========
+
+const int BITS_RANURAS_RUEDA = 6; // 64 ranuras por nivel
+const int RANURAS_RUEDA = 1 << BITS_RANURAS_RUEDA; // Ranuras de cada nivel
+const int MASCARA_RUEDA = RANURAS_RUEDA - 1; // Indice de ranura dentro de un nivel
+const int NIVELES_RUEDA = 3; // 64, 4096 y 262144 ticks (mas de una hora a 60 FPS)
+const int MAX_TEMPORIZADORES = 320; // Una expiracion por bala del pool y margen para los de partida
+
+// ========== ESTRUCTURAS ==========
+
+// Que hacer cuando vence un temporizador; el significado de dato depende del tipo
+enum TipoTemporizador {
+        TEMP_LIBRE, // Nodo sin usar
+        TEMP_BALA, // Retira la bala (dato = indice en el pool de balas)
+        TEMP_DISPARO, // Fin de la cadencia de disparo (dato = jugador)
+        TEMP_GAME_OVER, // Fin de la espera tras caer el ultimo jugador
+        TEMP_TRANSICION // Fin de la pantalla entre rondas
+};
+
+// Los enlaces son indices y no punteros: la rueda vive dentro del estado de la partida
+// y sigue siendo valida tras copiarla con memcpy en una instantanea
+struct Temporizador {
+        int vence; // Tick absoluto en el que se dispara
+        int tipo; // TipoTemporizador
+        int dato; // Entidad o jugador afectado
+        int cubeta; // Ranura que lo contiene (nivel * RANURAS_RUEDA + ranura, -1 = libre)
+        int siguiente; // Siguiente nodo de la ranura o de la lista de libres (-1 = fin)
+        int anterior; // Nodo anterior de la ranura (-1 = primero)
+};
+
+struct EventoTemporizador {
+        int tipo; // TipoTemporizador vencido
+        int dato; // Dato con el que se programo
+};
+
+struct RuedaTemporizadores {
+        Temporizador nodos[MAX_TEMPORIZADORES]; // Almacenamiento plano de todos los temporizadores
+        int cubetas[NIVELES_RUEDA * RANURAS_RUEDA]; // Primer nodo de cada ranura (-1 = vacia)
+        int libres; // Primer nodo libre (-1 = rueda llena)
+        int en_uso; // Temporizadores pendientes
+        int tick; // Ultimo tick procesado
+        long vencidos; // Temporizadores disparados desde el inicio
+        long recolocados; // Traslados de un nivel superior a uno inferior
+};
+
+// ========== GESTION ==========
+
+void iniciarRuedaTemporizadores(RuedaTemporizadores& r, int tick) {
+        for (int i = 0; i < MAX_TEMPORIZADORES; i++) { // Encadena todos los nodos libres
+                r.nodos[i].tipo = TEMP_LIBRE; // Sin uso
+                r.nodos[i].cubeta = -1; // Fuera de la rueda
+                r.nodos[i].siguiente = (i + 1 < MAX_TEMPORIZADORES) ? i + 1 : -1; // Siguiente libre
+                r.nodos[i].anterior = -1; // Sin anterior
+        }
+        for (int c = 0; c < NIVELES_RUEDA * RANURAS_RUEDA; c++) r.cubetas[c] = -1; // Todas las ranuras vacias
+        r.libres = 0; // Todos los nodos disponibles
+        r.en_uso = 0; // Nada pendiente
+        r.tick = tick; // La rueda parte del tick actual de la partida
+        r.vencidos = 0; // Sin disparos
+        r.recolocados = 0; // Sin traslados
+}
+
+// Engancha el nodo en la ranura que le corresponde segun lo que falta para su vencimiento:
+// el nivel 0 distingue ticks, el 1 bloques de 64 y el 2 bloques de 4096
+void colocarTemporizador(RuedaTemporizadores& r, int id) {
+        Temporizador& t = r.nodos[id]; // Nodo a colocar
+        int falta = t.vence - r.tick; // Ticks hasta el vencimiento (0 durante una recolocacion)
+        int nivel; // Nivel de la rueda
+        int referencia = t.vence; // Tick que decide la ranura
+        if (falta < RANURAS_RUEDA) nivel = 0; // Menos de 64 ticks
+        else if (falta < RANURAS_RUEDA * RANURAS_RUEDA) nivel = 1; // Menos de 4096 ticks
+        else { // Todo lo demas en el ultimo nivel
+                nivel = 2; // Bloques de 4096 ticks
+                int limite = RANURAS_RUEDA * RANURAS_RUEDA * RANURAS_RUEDA - 1; // Alcance maximo de la rueda
+                if (falta > limite) referencia = r.tick + limite; // Demasiado lejos: se recolocara al llegar a la ranura
+        }
+        int cubeta = nivel * RANURAS_RUEDA + ((referencia >> (nivel * BITS_RANURAS_RUEDA)) & MASCARA_RUEDA); // Ranura del nivel
+
+        t.cubeta = cubeta; // Recuerda la ranura para poder cancelarlo
+        t.anterior = -1; // Se inserta al principio
+        t.siguiente = r.cubetas[cubeta]; // Delante del primero actual
+        if (t.siguiente >= 0) r.nodos[t.siguiente].anterior = id; // Enlace inverso
+        r.cubetas[cubeta] = id; // Nuevo primero de la ranura
+}
+
+void desengancharTemporizador(RuedaTemporizadores& r, int id) {
+        Temporizador& t = r.nodos[id]; // Nodo a retirar de su ranura
+        if (t.anterior >= 0) r.nodos[t.anterior].siguiente = t.siguiente; // Salta el nodo
+        else r.cubetas[t.cubeta] = t.siguiente; // Era el primero de la ranura
+        if (t.siguiente >= 0) r.nodos[t.siguiente].anterior = t.anterior; // Enlace inverso
+        t.cubeta = -1; // Fuera de la rueda
+}
+
+void liberarTemporizador(RuedaTemporizadores& r, int id) {
+        r.nodos[id].tipo = TEMP_LIBRE; // Sin uso
+        r.nodos[id].siguiente = r.libres; // Vuelve a la cabeza de la lista de libres
+        r.libres = id; // Disponible para el proximo
+        r.en_uso--; // Descuenta el nodo
+}
+
+// Programa un vencimiento dentro de 'ticks' ticks (minimo 1). Devuelve el identificador para
+// cancelarlo o reprogramarlo, o -1 si la rueda esta llena
+int programarTemporizador(RuedaTemporizadores& r, int ticks, int tipo, int dato) {
+        int id = r.libres; // Primer nodo libre
+        if (id < 0) return -1; // Sin nodos disponibles
+        r.libres = r.nodos[id].siguiente; // Lo retira de la lista de libres
+        r.en_uso++; // Cuenta el nodo
+
+        Temporizador& t = r.nodos[id]; // Nodo reservado
+        t.vence = r.tick + (ticks < 1 ? 1 : ticks); // Nunca en el tick ya procesado
+        t.tipo = tipo; // Accion al vencer
+        t.dato = dato; // Entidad afectada
+        colocarTemporizador(r, id); // Lo engancha en su ranura
+        return id; // Identificador del temporizador
+}
+
+void cancelarTemporizador(RuedaTemporizadores& r, int id) {
+        if (id < 0 || r.nodos[id].cubeta < 0) return; // Nada pendiente
+        desengancharTemporizador(r, id); // Lo saca de su ranura
+        liberarTemporizador(r, id); // Devuelve el nodo
+}
+
+// Cambia el vencimiento de un temporizador pendiente sin liberarlo
+void reprogramarTemporizador(RuedaTemporizadores& r, int id, int ticks) {
+        if (id < 0 || r.nodos[id].cubeta < 0) return; // Nada pendiente
+        desengancharTemporizador(r, id); // Lo saca de su ranura actual
+        r.nodos[id].vence = r.tick + (ticks < 1 ? 1 : ticks); // Nuevo vencimiento
+        colocarTemporizador(r, id); // Lo engancha en la ranura nueva
+}
+
+int restanteTemporizador(const RuedaTemporizadores& r, int id) {
+        if (id < 0 || r.nodos[id].cubeta < 0) return 0; // Ya vencio o no existe
+        return r.nodos[id].vence - r.tick; // Ticks que faltan
+}
+
+// ========== AVANCE ==========
+
+// Vacia una ranura de un nivel superior reenganchando cada nodo mas abajo
+void recolocarCubeta(RuedaTemporizadores& r, int cubeta) {
+        int id = r.cubetas[cubeta]; // Primer nodo de la ranura
+        r.cubetas[cubeta] = -1; // La ranura queda vacia
+        while (id >= 0) { // Cada nodo de la ranura
+                int siguiente = r.nodos[id].siguiente; // Se guarda antes de reenganchar
+                colocarTemporizador(r, id); // Baja al nivel que le corresponde ahora
+                r.recolocados++; // Cuenta el traslado
+                id = siguiente; // Siguiente nodo
+        }
+}
+
+// Avanza la rueda un tick y copia en 'vencidos' los temporizadores que se disparan, ya liberados.
+// Solo se toca la ranura del tick (y, una vez cada 64 ticks, una ranura superior). Devuelve la cantidad
+int avanzarRuedaTemporizadores(RuedaTemporizadores& r, EventoTemporizador* vencidos) {
+        int t = ++r.tick; // Tick que se procesa
+        if ((t & MASCARA_RUEDA) == 0) { // Comienza un bloque de 64 ticks
+                if (((t >> BITS_RANURAS_RUEDA) & MASCARA_RUEDA) == 0) recolocarCubeta(r, 2 * RANURAS_RUEDA + ((t >> (2 * BITS_RANURAS_RUEDA)) & MASCARA_RUEDA)); // Comienza un bloque de 4096: baja el nivel 2
+                recolocarCubeta(r, RANURAS_RUEDA + ((t >> BITS_RANURAS_RUEDA) & MASCARA_RUEDA)); // Baja el nivel 1 al nivel 0
+        }
+
+        int n = 0; // Temporizadores disparados
+        int cubeta = t & MASCARA_RUEDA; // Ranura del tick en el nivel 0
+        int id = r.cubetas[cubeta]; // Primer nodo de la ranura
+        r.cubetas[cubeta] = -1; // La ranura queda vacia
+        while (id >= 0) { // Cada nodo de la ranura
+                int siguiente = r.nodos[id].siguiente; // Se guarda antes de modificar el nodo
+                if (r.nodos[id].vence <= t) { // Vence en este tick
+                        vencidos[n].tipo = r.nodos[id].tipo; // Accion
+                        vencidos[n].dato = r.nodos[id].dato; // Entidad
+                        n++; // Cuenta el evento
+                        r.nodos[id].cubeta = -1; // Fuera de la rueda
+                        liberarTemporizador(r, id); // El nodo se puede reutilizar al tratar el evento
+                        r.vencidos++; // Estadistica
+                } else {
+                        colocarTemporizador(r, id); // Programado mas alla del alcance: sigue esperando
+                }
+                id = siguiente; // Siguiente nodo
+        }
+        return n; // Nunca mas de MAX_TEMPORIZADORES: cada nodo vence una sola vez
+}